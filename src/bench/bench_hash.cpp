@@ -0,0 +1,381 @@
+#define CX_RUNTIME
+
+#include <cx_blake2s.h>
+#include <cx_cpuid.h>
+#include <cx_crc32.h>
+#include <cx_fnv1.h>
+#include <cx_md5.h>
+#include <cx_murmur3.h>
+#include <cx_sha256.h>
+#include <cx_sha512.h>
+#include <cx_siphash.h>
+#include <cx_xxhash.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#if CX_X86_SIMD
+#include <x86intrin.h>
+#endif
+
+//----------------------------------------------------------------------------
+// hash throughput benchmark
+//
+// Measures the runtime implementations of the cx hashes over messages from
+// 4 bytes to 64 MiB (by powers of 4), in two modes:
+//
+//   warm: the same message is hashed repeatedly, so it stays in cache (if it
+//         fits); the best of several timed batches is reported
+//   cold: the message is flushed from every cache level before each call,
+//         which is timed alone; the median call is reported (the hash's own
+//         code and tables stay warm)
+//
+// Each result gives the time per call, GB/s and, on x86, cycles per byte
+// (in TSC cycles, i.e. at the TSC's constant rate, whatever the core clock).
+// Results are written as JSON to stdout (or to --out), and as a table to
+// stderr:
+//
+//   bench_hash [--out file] [--mode warm|cold|both] [--only name,...]
+//              [--min-size n] [--max-size n]
+//
+// Sizes may have a k or m suffix (KiB, MiB).
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // clocks: steady_clock for time, the TSC (where there is one) for cycles
+
+  struct stamp
+  {
+    uint64_t ns;
+    uint64_t ticks;
+  };
+
+  inline stamp now()
+  {
+#if CX_X86_SIMD
+    unsigned int aux;
+    const uint64_t ticks = __rdtscp(&aux);
+#else
+    const uint64_t ticks = 0;
+#endif
+    const auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return { static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t).count()), ticks };
+  }
+
+  constexpr bool have_ticks = CX_X86_SIMD != 0;
+
+  //----------------------------------------------------------------------------
+  // results are folded into a volatile sink, so no call can be optimized away
+
+  volatile uint64_t sink;
+
+  inline uint64_t fold(uint32_t h) { return h; }
+  inline uint64_t fold(uint64_t h) { return h; }
+  template <typename S>
+  inline uint64_t fold(const S& s) { return s.h[0]; }
+
+  // flush n bytes at p from every cache level
+#if CX_X86_SIMD
+  __attribute__((target("sse2")))
+  void evict(const char* p, size_t n)
+  {
+    const uintptr_t end = reinterpret_cast<uintptr_t>(p) + n;
+    for (uintptr_t a = reinterpret_cast<uintptr_t>(p) & ~uintptr_t{63}; a < end; a += 64)
+    {
+      _mm_clflush(reinterpret_cast<const void*>(a));
+    }
+    _mm_mfence();
+  }
+#else
+  // (without clflush, by writing a buffer larger than any last-level cache)
+  void evict(const char*, size_t)
+  {
+    static std::vector<char> scratch(256 << 20);
+    for (size_t i = 0; i < scratch.size(); i += 64)
+    {
+      scratch[i] = static_cast<char>(scratch[i] + 1);
+    }
+  }
+#endif
+
+  //----------------------------------------------------------------------------
+  // measurement
+
+  struct result
+  {
+    uint64_t calls;
+    double ns;      // per call
+    double ticks;   // per call
+  };
+
+  // the shortest timer interval, subtracted from each single call
+  stamp overhead()
+  {
+    stamp best = { UINT64_MAX, UINT64_MAX };
+    for (int i = 0; i < 1000; ++i)
+    {
+      const stamp s = now();
+      const stamp e = now();
+      best.ns = std::min(best.ns, e.ns - s.ns);
+      best.ticks = std::min(best.ticks, e.ticks - s.ticks);
+    }
+    return best;
+  }
+
+  // hide a value from the optimizer, so that a call on it can't be hoisted
+  // out of a loop that repeats it
+  template <typename T>
+  inline void opaque(T& x)
+  {
+    __asm__ volatile("" : "+r"(x));
+  }
+
+  template <typename F>
+  stamp batch(F f, const char* p, size_t n, uint64_t reps)
+  {
+    uint64_t acc = 0;
+    const stamp s = now();
+    for (uint64_t r = 0; r < reps; ++r)
+    {
+      opaque(p);
+      opaque(n);
+      acc += fold(f(p, n));
+    }
+    const stamp e = now();
+    sink = sink + acc;
+    return { e.ns - s.ns, e.ticks - s.ticks };
+  }
+
+  // batches of at least 2ms; the best of 7
+  template <typename F>
+  result warm(F f, const char* p, size_t n)
+  {
+    sink = sink + fold(f(p, n));
+    uint64_t reps = 1;
+    for (stamp t = batch(f, p, n, reps); t.ns < 2000000 && reps < (uint64_t{1} << 32);
+         t = batch(f, p, n, reps))
+    {
+      reps *= 2;
+    }
+    result r = { 0, 1e300, 1e300 };
+    for (int i = 0; i < 7; ++i)
+    {
+      const stamp t = batch(f, p, n, reps);
+      r.calls += reps;
+      r.ns = std::min(r.ns, static_cast<double>(t.ns) / static_cast<double>(reps));
+      r.ticks = std::min(r.ticks, static_cast<double>(t.ticks) / static_cast<double>(reps));
+    }
+    return r;
+  }
+
+  template <typename F>
+  result cold(F f, const char* p, size_t n, const stamp& timer)
+  {
+    sink = sink + fold(f(p, n));
+    const size_t calls = n <= (size_t{1} << 20) ? 101 : n <= (size_t{16} << 20) ? 11 : 5;
+    std::vector<uint64_t> ns(calls);
+    std::vector<uint64_t> ticks(calls);
+    for (size_t i = 0; i < calls; ++i)
+    {
+      evict(p, n);
+      const stamp s = now();
+      sink = sink + fold(f(p, n));
+      const stamp e = now();
+      ns[i] = e.ns - s.ns - std::min(e.ns - s.ns, timer.ns);
+      ticks[i] = e.ticks - s.ticks - std::min(e.ticks - s.ticks, timer.ticks);
+    }
+    const auto mid = static_cast<std::ptrdiff_t>(calls / 2);
+    std::nth_element(ns.begin(), ns.begin() + mid, ns.end());
+    std::nth_element(ticks.begin(), ticks.begin() + mid, ticks.end());
+    return { calls, static_cast<double>(ns[calls / 2]), static_cast<double>(ticks[calls / 2]) };
+  }
+
+  //----------------------------------------------------------------------------
+  // options and output
+
+  struct options
+  {
+    const char* out = nullptr;
+    bool warm = true;
+    bool cold = true;
+    std::string only;
+    size_t min_size = 4;
+    size_t max_size = size_t{64} << 20;
+  };
+
+  struct bench
+  {
+    const options& opts;
+    const char* data;
+    stamp timer;
+    std::FILE* json;
+    bool first;
+
+    bool selected(const char* name) const
+    {
+      if (opts.only.empty()) return true;
+      const std::string list = "," + opts.only + ",";
+      return list.find("," + std::string(name) + ",") != std::string::npos;
+    }
+
+    void report(const char* name, const char* mode, size_t n, const result& r)
+    {
+      const double gbps = r.ns > 0 ? static_cast<double>(n) / r.ns : 0;
+      const double cpb = r.ticks / static_cast<double>(n);
+      std::fprintf(json, "%s\n    { \"hash\": \"%s\", \"mode\": \"%s\", \"size\": %zu, "
+                   "\"calls\": %llu, \"ns_per_call\": %.3f, \"gb_per_s\": %.4f, "
+                   "\"cycles_per_byte\": ",
+                   first ? "" : ",", name, mode, n,
+                   static_cast<unsigned long long>(r.calls), r.ns, gbps);
+      if (have_ticks)
+      {
+        std::fprintf(json, "%.4f }", cpb);
+      }
+      else
+      {
+        std::fprintf(json, "null }");
+      }
+      first = false;
+      std::fprintf(stderr, "%-16s %-4s %10zu B %12.1f ns %9.3f GB/s", name, mode, n, r.ns, gbps);
+      if (have_ticks)
+      {
+        std::fprintf(stderr, " %9.3f c/B", cpb);
+      }
+      std::fprintf(stderr, "\n");
+    }
+
+    template <typename F>
+    void run(const char* name, F f)
+    {
+      if (!selected(name)) return;
+      for (size_t n = opts.min_size; n <= opts.max_size; n *= 4)
+      {
+        if (opts.warm) report(name, "warm", n, warm(f, data, n));
+        if (opts.cold) report(name, "cold", n, cold(f, data, n, timer));
+      }
+    }
+  };
+
+  bool parse_size(const char* s, size_t& n)
+  {
+    char* end;
+    const unsigned long long v = std::strtoull(s, &end, 10);
+    const size_t scale = *end == 'k' || *end == 'K' ? size_t{1} << 10
+      : *end == 'm' || *end == 'M' ? size_t{1} << 20 : 1;
+    if (end == s || (scale != 1 && end[1] != 0) || (scale == 1 && *end != 0)) return false;
+    n = static_cast<size_t>(v) * scale;
+    return n > 0;
+  }
+
+  bool parse(int argc, char* argv[], options& opts)
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      const std::string arg = argv[i];
+      const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+      if (value == nullptr) return false;
+      ++i;
+      if (arg == "--out") opts.out = value;
+      else if (arg == "--only") opts.only = value;
+      else if (arg == "--mode")
+      {
+        const std::string m = value;
+        if (m != "warm" && m != "cold" && m != "both") return false;
+        opts.warm = m != "cold";
+        opts.cold = m != "warm";
+      }
+      else if (arg == "--min-size")
+      {
+        if (!parse_size(value, opts.min_size)) return false;
+      }
+      else if (arg == "--max-size")
+      {
+        if (!parse_size(value, opts.max_size)) return false;
+      }
+      else return false;
+    }
+    return opts.min_size <= opts.max_size;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  options opts;
+  if (!parse(argc, argv, opts))
+  {
+    std::fprintf(stderr, "usage: %s [--out file] [--mode warm|cold|both] [--only name,...]"
+                 " [--min-size n] [--max-size n]\n", argv[0]);
+    return 2;
+  }
+  std::FILE* json = opts.out ? std::fopen(opts.out, "w") : stdout;
+  if (json == nullptr)
+  {
+    std::perror(opts.out);
+    return 1;
+  }
+
+  // a message of pseudo-random bytes, for every size
+  std::vector<char> data(opts.max_size);
+  uint64_t x = 0x9e3779b97f4a7c15ull;
+  for (char& c : data)
+  {
+    x = x * 6364136223846793005ull + 1442695040888963407ull;
+    c = static_cast<char>(x >> 56);
+  }
+
+  const cx::runtime::cpu_features& cpu = cx::runtime::cpu();
+  std::fprintf(json, "{\n  \"benchmark\": \"bench_hash\",\n"
+               "  \"cpu\": { \"sse2\": %s, \"ssse3\": %s, \"sse41\": %s, \"sse42\": %s, "
+               "\"avx2\": %s, \"avx512f\": %s, \"avx512bw\": %s, \"sha\": %s },\n"
+               "  \"cycles\": \"%s\",\n  \"results\": [",
+               cpu.sse2 ? "true" : "false", cpu.ssse3 ? "true" : "false",
+               cpu.sse41 ? "true" : "false", cpu.sse42 ? "true" : "false",
+               cpu.avx2 ? "true" : "false", cpu.avx512f ? "true" : "false",
+               cpu.avx512bw ? "true" : "false", cpu.sha ? "true" : "false",
+               have_ticks ? "tsc" : "none");
+
+  const stamp start = now();
+  bench b = { opts, data.data(), overhead(), json, true };
+
+  static constexpr cx::siphash_key sipkey = cx::make_siphash_key("0123456789abcdef");
+
+  b.run("fnv1", [] (const char* s, size_t n) { return cx::fnv1(s, n); });
+  b.run("fnv1a", [] (const char* s, size_t n) { return cx::fnv1a(s, n); });
+  b.run("fnv1a_32", [] (const char* s, size_t n) { return cx::fnv1a_32(s, n); });
+  b.run("murmur3_32", [] (const char* s, size_t n) { return cx::murmur3_32(s, n, 0); });
+  b.run("murmur3_x64_128", [] (const char* s, size_t n) { return cx::murmur3_x64_128(s, n, 0); });
+  b.run("xxh32", [] (const char* s, size_t n) { return cx::xxh32(s, n, 0); });
+  b.run("xxh64", [] (const char* s, size_t n) { return cx::xxh64(s, n, 0); });
+  b.run("xxh3_64", [] (const char* s, size_t n) { return cx::xxh3_64(s, n, 0); });
+  b.run("crc32", [] (const char* s, size_t n) { return cx::crc32(s, n); });
+  b.run("crc32c", [] (const char* s, size_t n) { return cx::crc32c(s, n); });
+  b.run("siphash13", [] (const char* s, size_t n) { return cx::siphash13(sipkey, s, n); });
+  b.run("siphash24", [] (const char* s, size_t n) { return cx::siphash24(sipkey, s, n); });
+  b.run("md5", [] (const char* s, size_t n) { return cx::md5(s, n); });
+  b.run("sha256", [] (const char* s, size_t n) { return cx::sha256(s, n); });
+  b.run("sha512", [] (const char* s, size_t n) { return cx::sha512(s, n); });
+  b.run("blake2s", [] (const char* s, size_t n) { return cx::blake2s(s, n); });
+
+  // the TSC rate, to convert cycles per byte back to time
+  const stamp end = now();
+  std::fprintf(json, "\n  ],\n  \"tsc_ghz\": ");
+  if (have_ticks && end.ns > start.ns)
+  {
+    std::fprintf(json, "%.4f\n}\n", static_cast<double>(end.ticks - start.ticks)
+                 / static_cast<double>(end.ns - start.ns));
+  }
+  else
+  {
+    std::fprintf(json, "null\n}\n");
+  }
+  if (json != stdout) std::fclose(json);
+  return 0;
+}
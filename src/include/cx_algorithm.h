@@ -1,5 +1,7 @@
 #pragma once
 
+#include "cx_runtime.h"
+
 #include <cstddef>
 #include <utility>
 
@@ -12,20 +14,239 @@ namespace cx
   {
     namespace
     {
-      extern const char* all_of_runtime_error;
-      extern const char* any_of_runtime_error;
-      extern const char* none_of_runtime_error;
-      extern const char* count_runtime_error;
-      extern const char* count_if_runtime_error;
-      extern const char* find_runtime_error;
-      extern const char* find_if_runtime_error;
-      extern const char* find_if_not_runtime_error;
-      extern const char* equal_runtime_error;
-      extern const char* mismatch_runtime_error;
-      extern const char* find_first_of_runtime_error;
-      extern const char* adjacent_find_runtime_error;
-      extern const char* search_runtime_error;
-      extern const char* search_n_runtime_error;
+      CX_ERROR_SYMBOL(all_of_runtime_error);
+      CX_ERROR_SYMBOL(any_of_runtime_error);
+      CX_ERROR_SYMBOL(none_of_runtime_error);
+      CX_ERROR_SYMBOL(count_runtime_error);
+      CX_ERROR_SYMBOL(count_if_runtime_error);
+      CX_ERROR_SYMBOL(find_runtime_error);
+      CX_ERROR_SYMBOL(find_if_runtime_error);
+      CX_ERROR_SYMBOL(find_if_not_runtime_error);
+      CX_ERROR_SYMBOL(equal_runtime_error);
+      CX_ERROR_SYMBOL(mismatch_runtime_error);
+      CX_ERROR_SYMBOL(find_first_of_runtime_error);
+      CX_ERROR_SYMBOL(adjacent_find_runtime_error);
+      CX_ERROR_SYMBOL(search_runtime_error);
+      CX_ERROR_SYMBOL(search_n_runtime_error);
+    }
+  }
+
+  template <typename T1, typename T2>
+  struct pair
+  {
+    T1 first;
+    T2 second;
+  };
+
+  // runtime versions (see cx_runtime.h): loops with the same semantics as the
+  // recursive constexpr versions
+  namespace runtime
+  {
+    template <typename It, typename T>
+    inline size_t count(It first, It last, const T& value)
+    {
+      size_t n = 0;
+      for (; first != last; ++first)
+      {
+        n += (*first == value);
+      }
+      return n;
+    }
+
+    template <typename It, typename Pred>
+    inline size_t count_if(It first, It last, Pred p)
+    {
+      size_t n = 0;
+      for (; first != last; ++first)
+      {
+        n += p(*first);
+      }
+      return n;
+    }
+
+    template <typename It, typename T>
+    inline It find(It first, It last, const T& value)
+    {
+      while (first != last && !(*first == value))
+      {
+        ++first;
+      }
+      return first;
+    }
+
+    template <typename It, typename Pred>
+    inline It find_if(It first, It last, Pred p)
+    {
+      while (first != last && !p(*first))
+      {
+        ++first;
+      }
+      return first;
+    }
+
+    template <typename It, typename Pred>
+    inline It find_if_not(It first, It last, Pred p)
+    {
+      while (first != last && p(*first))
+      {
+        ++first;
+      }
+      return first;
+    }
+
+    template <typename It1, typename It2>
+    inline bool equal(It1 first1, It1 last1, It2 first2)
+    {
+      for (; first1 != last1; ++first1, ++first2)
+      {
+        if (*first1 != *first2) return false;
+      }
+      return true;
+    }
+
+    template <typename It1, typename It2, typename Pred>
+    inline bool equal(It1 first1, It1 last1, It2 first2, Pred p)
+    {
+      for (; first1 != last1; ++first1, ++first2)
+      {
+        if (!p(*first1, *first2)) return false;
+      }
+      return true;
+    }
+
+    template <typename It1, typename It2>
+    inline pair<It1, It2> mismatch(It1 first1, It1 last1, It2 first2)
+    {
+      while (first1 != last1 && !(*first1 != *first2))
+      {
+        ++first1;
+        ++first2;
+      }
+      return { first1, first2 };
+    }
+
+    template <typename It1, typename It2, typename Pred>
+    inline pair<It1, It2> mismatch(It1 first1, It1 last1, It2 first2, Pred p)
+    {
+      while (first1 != last1 && p(*first1, *first2))
+      {
+        ++first1;
+        ++first2;
+      }
+      return { first1, first2 };
+    }
+
+    template <typename It1, typename It2>
+    inline pair<It1, It2> mismatch(It1 first1, It1 last1, It2 first2, It2 last2)
+    {
+      while (first1 != last1 && first2 != last2 && !(*first1 != *first2))
+      {
+        ++first1;
+        ++first2;
+      }
+      return { first1, first2 };
+    }
+
+    template <typename It1, typename It2, typename Pred>
+    inline pair<It1, It2> mismatch(It1 first1, It1 last1, It2 first2, It2 last2, Pred p)
+    {
+      while (first1 != last1 && first2 != last2 && p(*first1, *first2))
+      {
+        ++first1;
+        ++first2;
+      }
+      return { first1, first2 };
+    }
+
+    template <typename It1, typename It2>
+    inline It1 find_first_of(It1 first1, It1 last1,
+                             It2 first2, It2 last2)
+    {
+      while (first1 != last1 && find(first2, last2, *first1) == last2)
+      {
+        ++first1;
+      }
+      return first1;
+    }
+
+    template <typename It1, typename It2, typename Pred>
+    inline It1 find_first_of(It1 first1, It1 last1,
+                             It2 first2, It2 last2, Pred p)
+    {
+      for (; first1 != last1; ++first1)
+      {
+        for (It2 it = first2; it != last2; ++it)
+        {
+          if (p(*it, *first1)) return first1;
+        }
+      }
+      return first1;
+    }
+
+    template <typename It>
+    inline It adjacent_find(It first, It last)
+    {
+      for (; last - first > 1; ++first)
+      {
+        if (*first == *(first + 1)) return first;
+      }
+      return last;
+    }
+
+    template <typename It, typename Pred>
+    inline It adjacent_find(It first, It last, Pred p)
+    {
+      for (; last - first > 1; ++first)
+      {
+        if (p(*first, *(first + 1))) return first;
+      }
+      return last;
+    }
+
+    template <typename It1, typename It2>
+    inline It1 search(It1 first1, It2 last1,
+                      It2 first2, It2 last2)
+    {
+      for (; !(last2 - first2 > last1 - first1); ++first1)
+      {
+        if (equal(first2, last2, first1)) return first1;
+      }
+      return last1;
+    }
+
+    template <typename It1, typename It2, typename Pred>
+    inline It1 search(It1 first1, It2 last1,
+                      It2 first2, It2 last2, Pred p)
+    {
+      for (; !(last2 - first2 > last1 - first1); ++first1)
+      {
+        if (equal(first2, last2, first1, p)) return first1;
+      }
+      return last1;
+    }
+
+    template <typename It, typename T>
+    inline It search_n(It first, It last, size_t count, const T& value)
+    {
+      size_t sofar = 0;
+      for (; !(static_cast<decltype(last-first)>(count - sofar) > last - first); ++first)
+      {
+        if (sofar == count) return first - sofar;
+        sofar = *first != value ? 0 : sofar+1;
+      }
+      return last;
+    }
+
+    template <typename It, typename T, typename Pred>
+    inline It search_n(It first, It last, size_t count, const T& value, Pred p)
+    {
+      size_t sofar = 0;
+      for (; !(static_cast<decltype(last-first)>(count - sofar) > last - first); ++first)
+      {
+        if (sofar == count) return first - sofar;
+        sofar = !p(*first, value) ? 0 : sofar+1;
+      }
+      return last;
     }
   }
 
@@ -33,40 +254,45 @@ namespace cx
   constexpr size_t count(It first, It last, const T& value)
   {
     return first == last ? 0 :
-      true ? (*first == value) + count(first+1, last, value) :
-      throw err::count_runtime_error;
+      CX_CONSTANT_EVALUATED() ? (*first == value) + count(first+1, last, value) :
+      CX_RUNTIME_DISPATCH(runtime::count(first, last, value),
+                          err::count_runtime_error);
   }
 
   template <typename It, typename Pred>
   constexpr size_t count_if(It first, It last, Pred p)
   {
     return first == last ? 0 :
-      true ? p(*first) + count_if(first+1, last, p) :
-      throw err::count_if_runtime_error;
+      CX_CONSTANT_EVALUATED() ? p(*first) + count_if(first+1, last, p) :
+      CX_RUNTIME_DISPATCH(runtime::count_if(first, last, p),
+                          err::count_if_runtime_error);
   }
 
   template <typename It, typename T>
   constexpr It find(It first, It last, const T& value)
   {
     return first == last || *first == value ? first :
-      true ? find(first+1, last, value) :
-      throw err::find_runtime_error;
+      CX_CONSTANT_EVALUATED() ? find(first+1, last, value) :
+      CX_RUNTIME_DISPATCH(runtime::find(first, last, value),
+                          err::find_runtime_error);
   }
 
   template <typename It, typename Pred>
   constexpr It find_if(It first, It last, Pred p)
   {
     return first == last || p(*first) ? first :
-      true ? find_if(first+1, last, p) :
-      throw err::find_if_runtime_error;
+      CX_CONSTANT_EVALUATED() ? find_if(first+1, last, p) :
+      CX_RUNTIME_DISPATCH(runtime::find_if(first, last, p),
+                          err::find_if_runtime_error);
   }
 
   template <typename It, typename Pred>
   constexpr It find_if_not(It first, It last, Pred p)
   {
     return first == last || !p(*first) ? first :
-      true ? find_if_not(first+1, last, p) :
-      throw err::find_if_not_runtime_error;
+      CX_CONSTANT_EVALUATED() ? find_if_not(first+1, last, p) :
+      CX_RUNTIME_DISPATCH(runtime::find_if_not(first, last, p),
+                          err::find_if_not_runtime_error);
   }
 
   template< class It, class Pred>
@@ -97,8 +323,9 @@ namespace cx
     {
       return first1 == last1 ? true :
         *first1 != *first2 ? false :
-        true ? equal(first1+1, last1, first2+1) :
-        throw err::equal_runtime_error;
+        CX_CONSTANT_EVALUATED() ? equal(first1+1, last1, first2+1) :
+        CX_RUNTIME_DISPATCH(runtime::equal(first1, last1, first2),
+                            err::equal_runtime_error);
     }
 
     template <typename It1, typename It2, typename Pred>
@@ -106,8 +333,9 @@ namespace cx
     {
       return first1 == last1 ? true :
         !p(*first1, *first2) ? false :
-        true ? equal(first1+1, last1, first2+1, p) :
-        throw err::equal_runtime_error;
+        CX_CONSTANT_EVALUATED() ? equal(first1+1, last1, first2+1, p) :
+        CX_RUNTIME_DISPATCH(runtime::equal(first1, last1, first2, p),
+                            err::equal_runtime_error);
     }
   }
 
@@ -137,27 +365,22 @@ namespace cx
       detail::equal(first1, last1, first2, p);
   }
 
-  template <typename T1, typename T2>
-  struct pair
-  {
-    T1 first;
-    T2 second;
-  };
-
   template <typename It1, typename It2>
   constexpr pair<It1, It2> mismatch(It1 first1, It1 last1, It2 first2)
   {
     return (first1 == last1 || *first1 != *first2) ? pair<It1, It2>{ first1, first2 } :
-    true ? mismatch(first1+1, last1, first2+1) :
-      throw err::mismatch_runtime_error;
+    CX_CONSTANT_EVALUATED() ? mismatch(first1+1, last1, first2+1) :
+      CX_RUNTIME_DISPATCH(runtime::mismatch(first1, last1, first2),
+                          err::mismatch_runtime_error);
   }
 
   template <typename It1, typename It2, typename Pred>
   constexpr pair<It1, It2> mismatch(It1 first1, It1 last1, It2 first2, Pred p)
   {
     return (first1 == last1 || !p(*first1, *first2)) ? pair<It1, It2>{ first1, first2 } :
-    true ? mismatch(first1+1, last1, first2+1) :
-      throw err::mismatch_runtime_error;
+    CX_CONSTANT_EVALUATED() ? mismatch(first1+1, last1, first2+1, p) :
+      CX_RUNTIME_DISPATCH(runtime::mismatch(first1, last1, first2, p),
+                          err::mismatch_runtime_error);
   }
 
   template <typename It1, typename It2>
@@ -165,8 +388,9 @@ namespace cx
   {
     return (first1 == last1 || first2 == last2 || *first1 != *first2) ?
       pair<It1, It2>{ first1, first2 } :
-    true ? mismatch(first1+1, last1, first2+1, last2) :
-      throw err::mismatch_runtime_error;
+    CX_CONSTANT_EVALUATED() ? mismatch(first1+1, last1, first2+1, last2) :
+      CX_RUNTIME_DISPATCH(runtime::mismatch(first1, last1, first2, last2),
+                          err::mismatch_runtime_error);
   }
 
   template <typename It1, typename It2, typename Pred>
@@ -174,8 +398,9 @@ namespace cx
   {
     return (first1 == last1 || first2 == last2 || !p(*first1, *first2)) ?
       pair<It1, It2>{ first1, first2 } :
-    true ? mismatch(first1+1, last1, first2+1, last2, p) :
-      throw err::mismatch_runtime_error;
+    CX_CONSTANT_EVALUATED() ? mismatch(first1+1, last1, first2+1, last2, p) :
+      CX_RUNTIME_DISPATCH(runtime::mismatch(first1, last1, first2, last2, p),
+                          err::mismatch_runtime_error);
   }
 
   namespace detail
@@ -193,8 +418,9 @@ namespace cx
                               It2 first2, It2 last2)
   {
     return first1 == last1 || find(first2, last2, *first1) != last2 ? first1 :
-      true ? find_first_of(first1+1, last1, first2, last2) :
-      throw err::find_first_of_runtime_error;
+      CX_CONSTANT_EVALUATED() ? find_first_of(first1+1, last1, first2, last2) :
+      CX_RUNTIME_DISPATCH(runtime::find_first_of(first1, last1, first2, last2),
+                          err::find_first_of_runtime_error);
   }
 
   template <typename It1, typename It2, typename Pred>
@@ -202,8 +428,9 @@ namespace cx
                               It2 first2, It2 last2, Pred p)
   {
     return first1 == last1 || detail::contains_match(first2, last2, *first1, p) ? first1 :
-      true ? find_first_of(first1+1, last1, first2, last2, p) :
-      throw err::find_first_of_runtime_error;
+      CX_CONSTANT_EVALUATED() ? find_first_of(first1+1, last1, first2, last2, p) :
+      CX_RUNTIME_DISPATCH(runtime::find_first_of(first1, last1, first2, last2, p),
+                          err::find_first_of_runtime_error);
   }
 
   template <typename It>
@@ -211,8 +438,9 @@ namespace cx
   {
     return last - first <= 1 ? last :
       *first == *(first + 1) ? first :
-      true ? adjacent_find(first+1, last) :
-      throw err::adjacent_find_runtime_error;
+      CX_CONSTANT_EVALUATED() ? adjacent_find(first+1, last) :
+      CX_RUNTIME_DISPATCH(runtime::adjacent_find(first, last),
+                          err::adjacent_find_runtime_error);
   }
 
   template <typename It, typename Pred>
@@ -220,8 +448,9 @@ namespace cx
   {
     return last - first <= 1 ? last :
       p(*first, *(first + 1)) ? first :
-      true ? adjacent_find(first+1, last, p) :
-      throw err::adjacent_find_runtime_error;
+      CX_CONSTANT_EVALUATED() ? adjacent_find(first+1, last, p) :
+      CX_RUNTIME_DISPATCH(runtime::adjacent_find(first, last, p),
+                          err::adjacent_find_runtime_error);
   }
 
   template <typename It1, typename It2>
@@ -230,8 +459,9 @@ namespace cx
   {
     return (last2 - first2 > last1 - first1) ? last1 :
       equal(first2, last2, first1) ? first1 :
-      true ? search(first1+1, last1, first2, last2) :
-      throw err::search_runtime_error;
+      CX_CONSTANT_EVALUATED() ? search(first1+1, last1, first2, last2) :
+      CX_RUNTIME_DISPATCH(runtime::search(first1, last1, first2, last2),
+                          err::search_runtime_error);
   }
 
   template <typename It1, typename It2, typename Pred>
@@ -240,8 +470,9 @@ namespace cx
   {
     return (last2 - first2 > last1 - first1) ? last1 :
       equal(first2, last2, first1, p) ? first1 :
-      true ? search(first1+1, last1, first2, last2) :
-      throw err::search_runtime_error;
+      CX_CONSTANT_EVALUATED() ? search(first1+1, last1, first2, last2, p) :
+      CX_RUNTIME_DISPATCH(runtime::search(first1, last1, first2, last2, p),
+                          err::search_runtime_error);
   }
 
   namespace detail
@@ -270,14 +501,16 @@ namespace cx
   template <typename It, typename T>
   constexpr It search_n(It first, It last, size_t count, const T& value)
   {
-    return true ? detail::search_n(first, last, count, value) :
-      throw err::search_n_runtime_error;
+    return CX_CONSTANT_EVALUATED() ? detail::search_n(first, last, count, value) :
+      CX_RUNTIME_DISPATCH(runtime::search_n(first, last, count, value),
+                          err::search_n_runtime_error);
   }
 
   template <typename It, typename T, typename Pred>
   constexpr It search_n(It first, It last, size_t count, const T& value, Pred p)
   {
-    return true ? detail::search_np(first, last, count, value, p) :
-      throw err::search_n_runtime_error;
+    return CX_CONSTANT_EVALUATED() ? detail::search_np(first, last, count, value, p) :
+      CX_RUNTIME_DISPATCH(runtime::search_n(first, last, count, value, p),
+                          err::search_n_runtime_error);
   }
 }
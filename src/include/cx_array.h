@@ -16,11 +16,11 @@ namespace cx
   {
     namespace
     {
-      extern const char* array_runtime_error;
-      extern const char* transform_runtime_error;
-      extern const char* sort_runtime_error;
-      extern const char* partition_runtime_error;
-      extern const char* reverse_runtime_error;
+      CX_ERROR_SYMBOL(array_runtime_error);
+      CX_ERROR_SYMBOL(transform_runtime_error);
+      CX_ERROR_SYMBOL(sort_runtime_error);
+      CX_ERROR_SYMBOL(partition_runtime_error);
+      CX_ERROR_SYMBOL(reverse_runtime_error);
     }
   }
 
@@ -209,6 +209,10 @@ namespace cx
       return { m_data[Is]... };
     }
 
+  public:
+    // (partial specializations must have the same access as their primary
+    // templates, which gcc enforces)
+
     // inserter for at front, in the middle somewhere, at end
     template <size_t I>
     struct inserter<I, typename std::enable_if<(I == 0)>::type>
@@ -320,6 +324,7 @@ namespace cx
       }
     };
 
+  private:
     // make a predicate into a comparison function suitable for sort
     template <typename P>
     struct pred_to_less_t
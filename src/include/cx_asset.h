@@ -0,0 +1,191 @@
+#pragma once
+
+#include "cx_md5.h"
+#include "cx_sha256.h"
+
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+//----------------------------------------------------------------------------
+// embedded assets with compile-time digests
+//
+// An embedded_asset is a blob compiled into the program (a default config, a
+// shader, a certificate) together with its sha256 (or md5) digest, computed
+// at compile time from the same bytes:
+//
+//   constexpr char cert_bytes[] = { 0x30, -126, 0x03, ... };   // generated
+//   constexpr auto cert = cx::make_asset("ca.der", cert_bytes);
+//
+// The digest is then stored in the binary next to the bytes, so checking that
+// they are intact (against corruption of the file or of memory) is one
+// runtime hash and a comparison.
+// A lazy_asset makes that check when the bytes are first used, or on a
+// background thread, so that startup doesn't pay for hashing every asset:
+//
+//   static cx::lazy_asset<> ca(cert);
+//   ca.verify_in_background();        // optional: at startup
+//   use(ca.data(), ca.size());        // verified (or waits); throws if corrupt
+//
+// The blob is a char array (a string literal includes its terminating NUL:
+// pass sizeof(s) - 1 as the size to leave it out). Computing the digest
+// requires the asset to be constexpr; verifying it is runtime only, and
+// doesn't need CX_RUNTIME.
+//
+// Hashing at compile time is slow: a 16KB asset takes a few seconds with gcc,
+// and around 64KB the default constexpr limits are reached. For larger
+// assets, have the tool that generates the bytes also write out the digest,
+// and pass it to the constructor.
+
+namespace cx
+{
+  // digest policies
+  struct asset_sha256
+  {
+    using digest_type = sha256sum;
+    static constexpr digest_type digest(const char* s, size_t len)
+    {
+      return sha256(s, len);
+    }
+    static digest_type runtime_digest(const char* s, size_t len)
+    {
+      return runtime::sha256(s, len);
+    }
+  };
+
+  struct asset_md5
+  {
+    using digest_type = md5sum;
+    static constexpr digest_type digest(const char* s, size_t len)
+    {
+      return md5(s, len);
+    }
+    static digest_type runtime_digest(const char* s, size_t len)
+    {
+      return runtime::md5(s, len);
+    }
+  };
+
+  namespace detail
+  {
+    namespace asset
+    {
+      template <typename D>
+      constexpr bool same(const D& a, const D& b, size_t i = 0)
+      {
+        return i == sizeof(a.h) / sizeof(a.h[0]) ||
+          (a.h[i] == b.h[i] && same(a, b, i + 1));
+      }
+    }
+  }
+
+  template <typename Hash = asset_sha256>
+  class embedded_asset
+  {
+  public:
+    using digest_type = typename Hash::digest_type;
+
+    // the digest is computed from the bytes (at compile time, for a constexpr
+    // asset)...
+    constexpr embedded_asset(const char* name, const char* data, size_t size)
+      : m_name(name), m_data(data), m_size(size), m_digest(Hash::digest(data, size))
+    {}
+    // ...or given, e.g. by the tool that generated the bytes
+    constexpr embedded_asset(const char* name, const char* data, size_t size,
+                             const digest_type& digest)
+      : m_name(name), m_data(data), m_size(size), m_digest(digest)
+    {}
+
+    constexpr const char* name() const { return m_name; }
+    constexpr const char* data() const { return m_data; }
+    constexpr size_t size() const { return m_size; }
+    constexpr digest_type digest() const { return m_digest; }
+
+    // hash the bytes now and compare with the stored digest (runtime only)
+    bool verify() const
+    {
+      return detail::asset::same(Hash::runtime_digest(m_data, m_size), m_digest);
+    }
+
+  private:
+    const char* m_name;
+    const char* m_data;
+    size_t m_size;
+    digest_type m_digest;
+  };
+
+  template <typename Hash = asset_sha256, size_t N>
+  constexpr embedded_asset<Hash> make_asset(const char* name, const char (&data)[N])
+  {
+    return embedded_asset<Hash>(name, data, N);
+  }
+  template <typename Hash = asset_sha256>
+  constexpr embedded_asset<Hash> make_asset(const char* name, const char* data, size_t size)
+  {
+    return embedded_asset<Hash>(name, data, size);
+  }
+
+  //----------------------------------------------------------------------------
+  // lazy verification (runtime only)
+
+  class asset_error : public std::runtime_error
+  {
+  public:
+    using std::runtime_error::runtime_error;
+  };
+
+  template <typename Hash = asset_sha256>
+  class lazy_asset
+  {
+  public:
+    explicit lazy_asset(const embedded_asset<Hash>& a)
+      : m_asset(a), m_ok(false)
+    {}
+
+    lazy_asset(const lazy_asset&) = delete;
+    lazy_asset& operator=(const lazy_asset&) = delete;
+
+    ~lazy_asset()
+    {
+      if (m_thread.joinable()) m_thread.join();
+    }
+
+    // Start verifying on a background thread (only the first call does
+    // anything). Accessing the bytes meanwhile waits for it to finish.
+    void verify_in_background()
+    {
+      std::call_once(m_started, [this] {
+          m_thread = std::thread([this] { verify_once(); });
+        });
+    }
+
+    // The bytes, verified on first access; throws asset_error if they don't
+    // match the digest. Later accesses only check that verification is done.
+    const char* data() const
+    {
+      verify_once();
+      if (!m_ok)
+      {
+        throw asset_error(std::string("cx: embedded asset fails verification: ")
+                          + m_asset.name());
+      }
+      return m_asset.data();
+    }
+    size_t size() const { return m_asset.size(); }
+    const embedded_asset<Hash>& asset() const { return m_asset; }
+
+  private:
+    void verify_once() const
+    {
+      std::call_once(m_verified, [this] { m_ok = m_asset.verify(); });
+    }
+
+    embedded_asset<Hash> m_asset;
+    mutable std::once_flag m_verified;
+    mutable bool m_ok;
+    std::once_flag m_started;
+    std::thread m_thread;
+  };
+}
@@ -0,0 +1,435 @@
+#pragma once
+
+#include "cx_cpuid.h"
+#include "cx_utils.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+//----------------------------------------------------------------------------
+// constexpr string hashing: BLAKE2s-256 (RFC 7693), plain and keyed
+//
+// BLAKE2s works on 32-bit words only (additions, xors and rotations), and on
+// a CPU without the sha extensions it hashes faster than sha256. It also
+// takes a key of up to 32 bytes directly, so it needs no HMAC
+// construction to authenticate a message:
+//
+//   constexpr auto expected = cx::blake2s(asset, sizeof(asset));
+//   auto mac = cx::blake2s_keyed(key, keylen, msg, len);
+//
+// As with sha256sum, the words of a blake2ssum are little-endian, so on a
+// little-endian machine its bytes are in the conventional order.
+
+namespace cx
+{
+  namespace err
+  {
+    namespace
+    {
+      CX_ERROR_SYMBOL(blake2s_runtime_error);
+      CX_ERROR_SYMBOL(blake2s_key_length_error);
+    }
+  }
+
+  struct blake2ssum
+  {
+    uint32_t h[8];
+  };
+
+  namespace detail
+  {
+    namespace blake2s
+    {
+      // the initialization vector is sha256's
+      constexpr uint32_t iv[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+      };
+
+      // the message word permutation for each of the ten rounds
+      constexpr uint8_t sigma[10][16] = {
+        { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+        { 14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3 },
+        { 11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4 },
+        { 7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8 },
+        { 9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13 },
+        { 2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9 },
+        { 12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11 },
+        { 13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10 },
+        { 6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5 },
+        { 10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0 }
+      };
+
+      constexpr uint32_t rotr(uint32_t x, int n)
+      {
+        return (x >> n) | (x << (32 - n));
+      }
+
+      // the parameter block (a 32-byte digest, with a key of keylen bytes)
+      // folded into the initial state
+      constexpr blake2ssum init(size_t keylen)
+      {
+        return { { iv[0] ^ 0x01010020u ^ static_cast<uint32_t>(keylen << 8),
+              iv[1], iv[2], iv[3], iv[4], iv[5], iv[6], iv[7] } };
+      }
+
+      // a message block, zero-padded from len bytes
+      struct block
+      {
+        uint32_t m[16];
+      };
+      constexpr uint32_t blockword(const char* s, int len, int i)
+      {
+        return word32le(len > 4*i ? s + 4*i : s, len - 4*i);
+      }
+      constexpr block load(const char* s, int len)
+      {
+        return { { blockword(s, len, 0), blockword(s, len, 1),
+              blockword(s, len, 2), blockword(s, len, 3),
+              blockword(s, len, 4), blockword(s, len, 5),
+              blockword(s, len, 6), blockword(s, len, 7),
+              blockword(s, len, 8), blockword(s, len, 9),
+              blockword(s, len, 10), blockword(s, len, 11),
+              blockword(s, len, 12), blockword(s, len, 13),
+              blockword(s, len, 14), blockword(s, len, 15) } };
+      }
+
+      //------------------------------------------------------------------------
+      // The working vector v[0..15] is a 4x4 matrix, kept here as its
+      // columns. Each round mixes the four columns, then the four diagonals,
+      // with G.
+      struct quad
+      {
+        uint32_t a, b, c, d;
+      };
+      struct state
+      {
+        quad q[4];
+      };
+
+      // half of G: a += b + x; d = (d ^ a) >>> r1; c += d; b = (b ^ c) >>> r2
+      constexpr quad half3(uint32_t a, uint32_t b, uint32_t c, uint32_t d, int r2)
+      {
+        return { a, rotr(b ^ c, r2), c, d };
+      }
+      constexpr quad half2(uint32_t a, uint32_t b, uint32_t c, uint32_t d, int r1, int r2)
+      {
+        return half3(a, b, c + rotr(d ^ a, r1), rotr(d ^ a, r1), r2);
+      }
+      constexpr quad half(const quad& q, uint32_t x, int r1, int r2)
+      {
+        return half2(q.a + q.b + x, q.b, q.c, q.d, r1, r2);
+      }
+      constexpr quad g(const quad& q, uint32_t x, uint32_t y)
+      {
+        return half(half(q, x, 16, 12), y, 8, 7);
+      }
+
+      // diagonal j takes a, b, c, d from columns j, j+1, j+2, j+3 (mod 4)
+      constexpr quad diagonal(const state& v, int j)
+      {
+        return { v.q[j].a, v.q[(j+1) & 3].b, v.q[(j+2) & 3].c, v.q[(j+3) & 3].d };
+      }
+      constexpr quad column(const state& d, int i)
+      {
+        return { d.q[i].a, d.q[(i+3) & 3].b, d.q[(i+2) & 3].c, d.q[(i+1) & 3].d };
+      }
+      constexpr state columns(const state& d)
+      {
+        return { { column(d, 0), column(d, 1), column(d, 2), column(d, 3) } };
+      }
+
+      constexpr state mixcolumns(const state& v, const block& b, const uint8_t* s)
+      {
+        return { { g(v.q[0], b.m[s[0]], b.m[s[1]]), g(v.q[1], b.m[s[2]], b.m[s[3]]),
+              g(v.q[2], b.m[s[4]], b.m[s[5]]), g(v.q[3], b.m[s[6]], b.m[s[7]]) } };
+      }
+      constexpr state mixdiagonals(const state& v, const block& b, const uint8_t* s)
+      {
+        return columns({ { g(diagonal(v, 0), b.m[s[8]], b.m[s[9]]),
+                g(diagonal(v, 1), b.m[s[10]], b.m[s[11]]),
+                g(diagonal(v, 2), b.m[s[12]], b.m[s[13]]),
+                g(diagonal(v, 3), b.m[s[14]], b.m[s[15]]) } });
+      }
+      constexpr state rounds(const state& v, const block& b, int r = 0)
+      {
+        return r == 10 ? v :
+          rounds(mixdiagonals(mixcolumns(v, b, sigma[r]), b, sigma[r]), b, r + 1);
+      }
+
+      // compress a block, with t bytes hashed so far (including this block);
+      // f is all ones for the last block
+      constexpr state start(const blake2ssum& h, uint64_t t, uint32_t f)
+      {
+        return { { { h.h[0], h.h[4], iv[0], iv[4] ^ static_cast<uint32_t>(t) },
+              { h.h[1], h.h[5], iv[1], iv[5] ^ static_cast<uint32_t>(t >> 32) },
+              { h.h[2], h.h[6], iv[2], iv[6] ^ f },
+              { h.h[3], h.h[7], iv[3], iv[7] } } };
+      }
+      constexpr blake2ssum finish(const blake2ssum& h, const state& v)
+      {
+        return { { h.h[0] ^ v.q[0].a ^ v.q[0].c, h.h[1] ^ v.q[1].a ^ v.q[1].c,
+              h.h[2] ^ v.q[2].a ^ v.q[2].c, h.h[3] ^ v.q[3].a ^ v.q[3].c,
+              h.h[4] ^ v.q[0].b ^ v.q[0].d, h.h[5] ^ v.q[1].b ^ v.q[1].d,
+              h.h[6] ^ v.q[2].b ^ v.q[2].d, h.h[7] ^ v.q[3].b ^ v.q[3].d } };
+      }
+      constexpr blake2ssum compress(const blake2ssum& h, const block& b,
+                                    uint64_t t, uint32_t f)
+      {
+        return finish(h, rounds(start(h, t, f), b));
+      }
+
+      //------------------------------------------------------------------------
+      // every block but the last is compressed as it comes; the last (which
+      // may be partial, or empty) is padded and flagged
+
+      // as with fnv, recurse in chunks to bound the recursion depth
+      struct stream
+      {
+        blake2ssum h;
+        const char* s;
+        size_t len;
+        uint64_t t;
+      };
+      constexpr stream blocks(const stream& p, int maxdepth)
+      {
+        return p.len <= 64 || maxdepth == 0 ? p :
+          blocks({ compress(p.h, load(p.s, 64), p.t + 64, 0), p.s + 64, p.len - 64, p.t + 64 },
+                 maxdepth - 1);
+      }
+      constexpr stream blocks_bychunk(const stream& p)
+      {
+        return p.len <= 64 ? p : blocks_bychunk(blocks(p, 256));
+      }
+      constexpr blake2ssum last(const stream& p)
+      {
+        return compress(p.h, load(p.s, static_cast<int>(p.len)), p.t + p.len, ~0u);
+      }
+
+      constexpr blake2ssum blake2s(const char* s, size_t len)
+      {
+        return last(blocks_bychunk({ init(0), s, len, 0 }));
+      }
+      // the key, zero-padded, is the first block
+      constexpr blake2ssum keyed(const char* key, size_t keylen, const char* s, size_t len)
+      {
+        return len == 0 ?
+          compress(init(keylen), load(key, static_cast<int>(keylen)), 64, ~0u) :
+          last(blocks_bychunk(
+                   { compress(init(keylen), load(key, static_cast<int>(keylen)), 64, 0),
+                     s, len, 64 }));
+      }
+      constexpr blake2ssum blake2s(const char* key, size_t keylen, const char* s, size_t len)
+      {
+        return keylen == 0 ? blake2s(s, len) :
+          keylen <= 32 ? keyed(key, keylen, s, len) :
+          throw err::blake2s_key_length_error;
+      }
+    }
+  }
+
+  // runtime versions (see cx_runtime.h)
+  namespace runtime
+  {
+    // compress one 64-byte block, with t bytes hashed so far (including this
+    // block); f is all ones for the last block
+    inline void blake2s_compress(blake2ssum& h, const char* data, uint64_t t, uint32_t f)
+    {
+      using detail::blake2s::rotr;
+      uint32_t m[16];
+      for (int i = 0; i < 16; ++i)
+      {
+        m[i] = load32le(data + 4*i);
+      }
+      uint32_t v[16] = {
+        h.h[0], h.h[1], h.h[2], h.h[3], h.h[4], h.h[5], h.h[6], h.h[7],
+        detail::blake2s::iv[0], detail::blake2s::iv[1],
+        detail::blake2s::iv[2], detail::blake2s::iv[3],
+        detail::blake2s::iv[4] ^ static_cast<uint32_t>(t),
+        detail::blake2s::iv[5] ^ static_cast<uint32_t>(t >> 32),
+        detail::blake2s::iv[6] ^ f, detail::blake2s::iv[7]
+      };
+      auto g = [&] (int a, int b, int c, int d, uint32_t x, uint32_t y) {
+        v[a] += v[b] + x; v[d] = rotr(v[d] ^ v[a], 16);
+        v[c] += v[d]; v[b] = rotr(v[b] ^ v[c], 12);
+        v[a] += v[b] + y; v[d] = rotr(v[d] ^ v[a], 8);
+        v[c] += v[d]; v[b] = rotr(v[b] ^ v[c], 7);
+      };
+      for (int r = 0; r < 10; ++r)
+      {
+        const uint8_t* s = detail::blake2s::sigma[r];
+        g(0, 4, 8, 12, m[s[0]], m[s[1]]);
+        g(1, 5, 9, 13, m[s[2]], m[s[3]]);
+        g(2, 6, 10, 14, m[s[4]], m[s[5]]);
+        g(3, 7, 11, 15, m[s[6]], m[s[7]]);
+        g(0, 5, 10, 15, m[s[8]], m[s[9]]);
+        g(1, 6, 11, 12, m[s[10]], m[s[11]]);
+        g(2, 7, 8, 13, m[s[12]], m[s[13]]);
+        g(3, 4, 9, 14, m[s[14]], m[s[15]]);
+      }
+      for (int i = 0; i < 8; ++i)
+      {
+        h.h[i] ^= v[i] ^ v[i + 8];
+      }
+    }
+
+#if CX_X86_SIMD
+    namespace detail_blake2s
+    {
+      // rotations by 16 and 8 are byte shuffles
+      __attribute__((target("ssse3")))
+      inline __m128i rotr16(__m128i x)
+      {
+        return _mm_shuffle_epi8(x, _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5,
+                                                 10, 11, 8, 9, 14, 15, 12, 13));
+      }
+      __attribute__((target("ssse3")))
+      inline __m128i rotr8(__m128i x)
+      {
+        return _mm_shuffle_epi8(x, _mm_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4,
+                                                 9, 10, 11, 8, 13, 14, 15, 12));
+      }
+      template <int n>
+      __attribute__((target("sse2")))
+      inline __m128i rotr(__m128i x)
+      {
+        return _mm_or_si128(_mm_srli_epi32(x, n), _mm_slli_epi32(x, 32 - n));
+      }
+
+      // message words s[0], s[2], s[4] and s[6]
+      __attribute__((target("sse4.1")))
+      inline __m128i gather(const uint32_t* m, const uint8_t* s)
+      {
+        return _mm_setr_epi32(static_cast<int>(m[s[0]]), static_cast<int>(m[s[2]]),
+                              static_cast<int>(m[s[4]]), static_cast<int>(m[s[6]]));
+      }
+
+      // G on all four columns (or diagonals) at once
+      __attribute__((target("sse4.1")))
+      inline void g(__m128i& a, __m128i& b, __m128i& c, __m128i& d, __m128i x, __m128i y)
+      {
+        a = _mm_add_epi32(_mm_add_epi32(a, b), x);
+        d = rotr16(_mm_xor_si128(d, a));
+        c = _mm_add_epi32(c, d);
+        b = rotr<12>(_mm_xor_si128(b, c));
+        a = _mm_add_epi32(_mm_add_epi32(a, b), y);
+        d = rotr8(_mm_xor_si128(d, a));
+        c = _mm_add_epi32(c, d);
+        b = rotr<7>(_mm_xor_si128(b, c));
+      }
+    }
+
+    // The rows of the working vector are vectors, so each G step is done
+    // for four columns at once; rotating rows 2-4 turns diagonals into
+    // columns and back. The message words for each round are gathered with
+    // pinsrd.
+    __attribute__((target("sse4.1")))
+    inline void blake2s_compress_sse41(blake2ssum& h, const char* data, uint64_t t, uint32_t f)
+    {
+      using detail_blake2s::g;
+      using detail_blake2s::gather;
+      uint32_t m[16];
+      std::memcpy(m, data, sizeof(m));
+      __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&h.h[0]));
+      __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&h.h[4]));
+      __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&detail::blake2s::iv[0]));
+      __m128i d = _mm_xor_si128(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(&detail::blake2s::iv[4])),
+          _mm_setr_epi32(static_cast<int>(static_cast<uint32_t>(t)),
+                         static_cast<int>(static_cast<uint32_t>(t >> 32)),
+                         static_cast<int>(f), 0));
+      const __m128i a0 = a;
+      const __m128i b0 = b;
+      for (int r = 0; r < 10; ++r)
+      {
+        const uint8_t* s = detail::blake2s::sigma[r];
+        g(a, b, c, d, gather(m, s), gather(m, s + 1));
+        b = _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1));
+        c = _mm_shuffle_epi32(c, _MM_SHUFFLE(1, 0, 3, 2));
+        d = _mm_shuffle_epi32(d, _MM_SHUFFLE(2, 1, 0, 3));
+        g(a, b, c, d, gather(m, s + 8), gather(m, s + 9));
+        b = _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 1, 0, 3));
+        c = _mm_shuffle_epi32(c, _MM_SHUFFLE(1, 0, 3, 2));
+        d = _mm_shuffle_epi32(d, _MM_SHUFFLE(0, 3, 2, 1));
+      }
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&h.h[0]),
+                       _mm_xor_si128(a0, _mm_xor_si128(a, c)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&h.h[4]),
+                       _mm_xor_si128(b0, _mm_xor_si128(b, d)));
+    }
+#endif
+
+    using blake2s_compress_fn = void (*)(blake2ssum&, const char*, uint64_t, uint32_t);
+
+    inline blake2s_compress_fn blake2s_compress_select()
+    {
+#if CX_X86_SIMD
+      if (cpu().sse41) return blake2s_compress_sse41;
+#endif
+      return blake2s_compress;
+    }
+
+    inline blake2ssum blake2s(const char* key, size_t keylen, const char* s, size_t len)
+    {
+      static const blake2s_compress_fn compress = blake2s_compress_select();
+      if (keylen > 32) throw err::blake2s_key_length_error;
+      blake2ssum h = detail::blake2s::init(keylen);
+      uint64_t t = 0;
+      char block[64] = {};
+      if (keylen > 0)
+      {
+        std::memcpy(block, key, keylen);
+        t = 64;
+        compress(h, block, t, len == 0 ? ~0u : 0);
+        if (len == 0) return h;
+      }
+      for (; len > 64; len -= 64, s += 64)
+      {
+        t += 64;
+        compress(h, s, t, 0);
+      }
+      std::memset(block, 0, sizeof(block));
+      if (len > 0) std::memcpy(block, s, len);
+      t += len;
+      compress(h, block, t, ~0u);
+      return h;
+    }
+    inline blake2ssum blake2s(const char* s, size_t len)
+    {
+      return blake2s(nullptr, 0, s, len);
+    }
+    inline blake2ssum blake2s(const char* s)
+    {
+      return blake2s(s, static_cast<size_t>(strlen(s)));
+    }
+  }
+
+  // (the overloads with a length take buffers that may contain NUL bytes)
+  constexpr blake2ssum blake2s(const char* s)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::blake2s::blake2s(s, static_cast<size_t>(strlen(s))) :
+      CX_RUNTIME_DISPATCH(runtime::blake2s(s), err::blake2s_runtime_error);
+  }
+  constexpr blake2ssum blake2s(const char* s, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::blake2s::blake2s(s, len) :
+      CX_RUNTIME_DISPATCH(runtime::blake2s(s, len), err::blake2s_runtime_error);
+  }
+
+  // keyed BLAKE2s (a MAC), with a key of at most 32 bytes
+  constexpr blake2ssum blake2s_keyed(const char* key, size_t keylen,
+                                     const char* s, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::blake2s::blake2s(key, keylen, s, len) :
+      CX_RUNTIME_DISPATCH(runtime::blake2s(key, keylen, s, len), err::blake2s_runtime_error);
+  }
+  constexpr blake2ssum blake2s_keyed(const char* key, const char* s)
+  {
+    return blake2s_keyed(key, static_cast<size_t>(strlen(key)),
+                         s, static_cast<size_t>(strlen(s)));
+  }
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "cx_runtime.h"
+
 // -----------------------------------------------------------------------------
 // A constexpr counter
 // see http://b.atch.se/posts/constexpr-counter/
@@ -14,7 +16,7 @@ namespace cx
   {
     namespace
     {
-      extern const char* counter_runtime_error;
+      CX_ERROR_SYMBOL(counter_runtime_error);
     }
   }
   namespace
@@ -0,0 +1,86 @@
+#pragma once
+
+#if (defined(__GNUC__) || defined(__clang__)) \
+  && (defined(__x86_64__) || defined(__i386__))
+#define CX_X86_SIMD 1
+#include <cpuid.h>
+#include <immintrin.h>
+#else
+#define CX_X86_SIMD 0
+#endif
+
+#include <cstdint>
+
+//----------------------------------------------------------------------------
+// runtime cpu feature detection (x86)
+//
+// Accelerated runtime paths are compiled with per-function target attributes
+// (so no global -m flags are needed) and selected once, on first use, from
+// these flags. On other platforms all flags are false and the portable
+// implementations are used.
+
+namespace cx
+{
+  namespace runtime
+  {
+    struct cpu_features
+    {
+      bool sse2;
+      bool ssse3;
+      bool sse41;
+      bool sse42;
+      bool avx2;
+      bool avx512f;
+      bool avx512bw;
+      bool sha;
+    };
+
+    namespace detail_cpu
+    {
+#if CX_X86_SIMD
+      // which register state the OS saves (and therefore allows us to use)
+      inline uint64_t xgetbv0()
+      {
+        uint32_t eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<uint64_t>(edx) << 32) | eax;
+      }
+
+      inline cpu_features detect()
+      {
+        cpu_features f = {};
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return f;
+        f.sse2 = (edx & bit_SSE2) != 0;
+        f.ssse3 = (ecx & bit_SSSE3) != 0;
+        f.sse41 = (ecx & bit_SSE4_1) != 0;
+        f.sse42 = (ecx & bit_SSE4_2) != 0;
+
+        const bool osxsave = (ecx & bit_OSXSAVE) != 0;
+        const uint64_t xcr0 = osxsave ? xgetbv0() : 0;
+        const bool ymm = (xcr0 & 0x06) == 0x06;
+        const bool zmm = (xcr0 & 0xe6) == 0xe6;
+
+        if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return f;
+        f.avx2 = ymm && (ebx & bit_AVX2) != 0;
+        f.avx512f = zmm && (ebx & bit_AVX512F) != 0;
+        f.avx512bw = f.avx512f && (ebx & bit_AVX512BW) != 0;
+        f.sha = (ebx & bit_SHA) != 0;
+        return f;
+      }
+#else
+      inline cpu_features detect()
+      {
+        return cpu_features{};
+      }
+#endif
+    }
+
+    // the features of the cpu we are running on (detected once)
+    inline const cpu_features& cpu()
+    {
+      static const cpu_features f = detail_cpu::detect();
+      return f;
+    }
+  }
+}
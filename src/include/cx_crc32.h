@@ -0,0 +1,314 @@
+#pragma once
+
+#include "cx_array.h"
+#include "cx_cpuid.h"
+#include "cx_utils.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+//----------------------------------------------------------------------------
+// constexpr checksums: crc32 (IEEE 802.3, as zlib) and crc32c (Castagnoli, as
+// iSCSI, ext4 and the SSE4.2 crc32 instruction)
+//
+// Both are reflected CRCs, computed slicing-by-8: eight bytes per step, with
+// eight 256-entry tables generated at compile time (crc32_tables below). At
+// runtime, crc32c uses the crc32 instruction where the CPU has it.
+
+namespace cx
+{
+  namespace err
+  {
+    namespace
+    {
+      CX_ERROR_SYMBOL(crc32_runtime_error);
+      CX_ERROR_SYMBOL(crc32c_runtime_error);
+    }
+  }
+
+  // the (reflected) polynomials
+  constexpr uint32_t crc32_poly = 0xedb88320u;
+  constexpr uint32_t crc32c_poly = 0x82f63b78u;
+
+  namespace detail
+  {
+    namespace crc
+    {
+      // the CRC of one byte, a bit at a time
+      constexpr uint32_t byte(uint32_t poly, uint32_t c, int bits = 8)
+      {
+        return bits == 0 ? c :
+          byte(poly, (c & 1) ? (c >> 1) ^ poly : c >> 1, bits - 1);
+      }
+
+      // entry i of slice k: the CRC of byte i followed by k zero bytes
+      constexpr uint32_t slice(uint32_t poly, size_t k, uint32_t i)
+      {
+        return k == 0 ? byte(poly, i) :
+          (slice(poly, k - 1, i) >> 8) ^ byte(poly, slice(poly, k - 1, i) & 0xff);
+      }
+
+      template <uint32_t Poly, size_t ...Is>
+      constexpr array<uint32_t, sizeof...(Is)> slices(std::index_sequence<Is...>)
+      {
+        return { slice(Poly, Is / 256, Is % 256)... };
+      }
+    }
+  }
+
+  // Slice k (entries 256k to 256k+255) maps a byte to the CRC of that byte
+  // followed by k zero bytes; slice 0 is the usual byte-at-a-time table.
+  template <uint32_t Poly>
+  struct crc32_tables
+  {
+    static constexpr array<uint32_t, 8 * 256> slices =
+      detail::crc::slices<Poly>(std::make_index_sequence<8 * 256>());
+  };
+
+  template <uint32_t Poly>
+  constexpr array<uint32_t, 8 * 256> crc32_tables<Poly>::slices;
+
+  namespace detail
+  {
+    namespace crc
+    {
+      // The CRC state is not inverted here (the public functions invert it
+      // before and after), so each step is linear.
+      template <uint32_t Poly>
+      constexpr uint32_t step1(uint32_t c, const char* s)
+      {
+        return (c >> 8) ^ crc32_tables<Poly>::slices[(c ^ byte32(*s)) & 0xff];
+      }
+      template <uint32_t Poly>
+      constexpr uint32_t step8_words(uint32_t lo, uint32_t hi)
+      {
+        return crc32_tables<Poly>::slices[7*256 + (lo & 0xff)]
+          ^ crc32_tables<Poly>::slices[6*256 + ((lo >> 8) & 0xff)]
+          ^ crc32_tables<Poly>::slices[5*256 + ((lo >> 16) & 0xff)]
+          ^ crc32_tables<Poly>::slices[4*256 + (lo >> 24)]
+          ^ crc32_tables<Poly>::slices[3*256 + (hi & 0xff)]
+          ^ crc32_tables<Poly>::slices[2*256 + ((hi >> 8) & 0xff)]
+          ^ crc32_tables<Poly>::slices[1*256 + ((hi >> 16) & 0xff)]
+          ^ crc32_tables<Poly>::slices[hi >> 24];
+      }
+      template <uint32_t Poly>
+      constexpr uint32_t step8(uint32_t c, const char* s)
+      {
+        return step8_words<Poly>(c ^ word32le(s), word32le(s+4));
+      }
+
+      // as with fnv, recurse in chunks to bound the recursion depth
+      template <uint32_t Poly>
+      struct state
+      {
+        uint32_t c;
+        const char* s;
+        size_t len;
+      };
+      template <uint32_t Poly>
+      constexpr state<Poly> steps(const state<Poly>& p, int maxdepth)
+      {
+        return p.len < 8 || maxdepth == 0 ? p :
+          steps<Poly>({ step8<Poly>(p.c, p.s), p.s + 8, p.len - 8 }, maxdepth - 1);
+      }
+      template <uint32_t Poly>
+      constexpr state<Poly> steps_bychunk(const state<Poly>& p)
+      {
+        return p.len < 8 ? p : steps_bychunk<Poly>(steps<Poly>(p, 256));
+      }
+      template <uint32_t Poly>
+      constexpr uint32_t tail(uint32_t c, const char* s, size_t len)
+      {
+        return len == 0 ? c : tail<Poly>(step1<Poly>(c, s), s + 1, len - 1);
+      }
+      template <uint32_t Poly>
+      constexpr uint32_t tail(const state<Poly>& p)
+      {
+        return tail<Poly>(p.c, p.s, p.len);
+      }
+
+      template <uint32_t Poly>
+      constexpr uint32_t value(const char* s, size_t len)
+      {
+        return ~tail<Poly>(steps_bychunk<Poly>({ ~0u, s, len }));
+      }
+
+      //------------------------------------------------------------------------
+      // Appending n zero bytes to a message multiplies its (uninverted) CRC by
+      // x^8n mod P. The runtime crc32c hashes three streams at once and joins
+      // them with that, as four table lookups (one per byte of the CRC).
+
+      // a * b mod P, with polynomials reflected (bit 31 is x^0)
+      constexpr uint32_t multmodp(uint32_t poly, uint32_t a, uint32_t b, uint32_t p = 0)
+      {
+        return a == 0 ? p :
+          multmodp(poly, a << 1, (b & 1) ? (b >> 1) ^ poly : b >> 1,
+                   (a & 0x80000000u) ? p ^ b : p);
+      }
+      // x^8n mod P
+      constexpr uint32_t x8nmodp(uint32_t poly, size_t n)
+      {
+        return n == 0 ? 0x80000000u :
+          (n & 1) ? multmodp(poly, x8nmodp(poly, n - 1), 0x00800000u) :
+          multmodp(poly, x8nmodp(poly, n / 2), x8nmodp(poly, n / 2));
+      }
+
+      template <uint32_t Poly, size_t N, size_t ...Is>
+      constexpr array<uint32_t, sizeof...(Is)> zeros(std::index_sequence<Is...>)
+      {
+        return { multmodp(Poly, x8nmodp(Poly, N),
+                          static_cast<uint32_t>(Is % 256) << (8 * (Is / 256)))... };
+      }
+
+      template <uint32_t Poly, size_t N>
+      struct zeros_tables
+      {
+        static constexpr array<uint32_t, 4 * 256> value =
+          zeros<Poly, N>(std::make_index_sequence<4 * 256>());
+      };
+
+      template <uint32_t Poly, size_t N>
+      constexpr array<uint32_t, 4 * 256> zeros_tables<Poly, N>::value;
+    }
+  }
+
+  // runtime versions (see cx_runtime.h)
+  namespace runtime
+  {
+    // the uninverted CRC state c, updated with len bytes, slicing-by-8
+    template <uint32_t Poly>
+    inline uint32_t crc32_slice8(uint32_t c, const char* s, size_t len)
+    {
+      const uint32_t* const t = crc32_tables<Poly>::slices.begin();
+      for (; len >= 8; len -= 8, s += 8)
+      {
+        const uint32_t lo = c ^ load32le(s);
+        const uint32_t hi = load32le(s+4);
+        c = t[7*256 + (lo & 0xff)] ^ t[6*256 + ((lo >> 8) & 0xff)]
+          ^ t[5*256 + ((lo >> 16) & 0xff)] ^ t[4*256 + (lo >> 24)]
+          ^ t[3*256 + (hi & 0xff)] ^ t[2*256 + ((hi >> 8) & 0xff)]
+          ^ t[1*256 + ((hi >> 16) & 0xff)] ^ t[hi >> 24];
+      }
+      for (; len > 0; --len, ++s)
+      {
+        c = (c >> 8) ^ t[(c ^ byte32(*s)) & 0xff];
+      }
+      return c;
+    }
+
+    // appends n zero bytes to the state c (see detail::crc::zeros_tables)
+    template <size_t N>
+    inline uint32_t crc32c_zeros(uint32_t c)
+    {
+      const uint32_t* const t = detail::crc::zeros_tables<crc32c_poly, N>::value.begin();
+      return t[c & 0xff] ^ t[256 + ((c >> 8) & 0xff)]
+        ^ t[512 + ((c >> 16) & 0xff)] ^ t[768 + (c >> 24)];
+    }
+
+#if CX_X86_SIMD
+    __attribute__((target("sse4.2")))
+    inline uint32_t crc32c_u64(uint32_t c, const char* s)
+    {
+#ifdef __x86_64__
+      return static_cast<uint32_t>(_mm_crc32_u64(c, load64le(s)));
+#else
+      return _mm_crc32_u32(_mm_crc32_u32(c, load32le(s)), load32le(s+4));
+#endif
+    }
+
+    // The crc32 instruction has a latency of 3 cycles but a throughput of
+    // one per cycle, so long inputs are hashed as three interleaved streams
+    // of N bytes (which must be a multiple of 8), joined afterwards.
+    template <size_t N>
+    __attribute__((target("sse4.2")))
+    inline void crc32c_3way(uint32_t& c, const char*& s, size_t& len)
+    {
+      for (; len >= 3 * N; len -= 3 * N, s += 3 * N)
+      {
+        uint32_t c1 = 0;
+        uint32_t c2 = 0;
+        for (size_t i = 0; i < N; i += 8)
+        {
+          c = crc32c_u64(c, s + i);
+          c1 = crc32c_u64(c1, s + N + i);
+          c2 = crc32c_u64(c2, s + 2 * N + i);
+        }
+        c = crc32c_zeros<N>(crc32c_zeros<N>(c) ^ c1) ^ c2;
+      }
+    }
+
+    __attribute__((target("sse4.2")))
+    inline uint32_t crc32c_sse42(uint32_t c, const char* s, size_t len)
+    {
+      crc32c_3way<8192>(c, s, len);
+      crc32c_3way<256>(c, s, len);
+      for (; len >= 8; len -= 8, s += 8)
+      {
+        c = crc32c_u64(c, s);
+      }
+      for (; len > 0; --len, ++s)
+      {
+        c = _mm_crc32_u8(c, static_cast<uint8_t>(*s));
+      }
+      return c;
+    }
+#endif
+
+    using crc32c_fn = uint32_t (*)(uint32_t, const char*, size_t);
+
+    inline crc32c_fn crc32c_select()
+    {
+#if CX_X86_SIMD
+      if (cpu().sse42) return crc32c_sse42;
+#endif
+      return crc32_slice8<crc32c_poly>;
+    }
+
+    inline uint32_t crc32(const char* s, size_t len)
+    {
+      return ~crc32_slice8<crc32_poly>(~0u, s, len);
+    }
+    inline uint32_t crc32(const char* s)
+    {
+      return crc32(s, static_cast<size_t>(strlen(s)));
+    }
+
+    inline uint32_t crc32c(const char* s, size_t len)
+    {
+      static const crc32c_fn f = crc32c_select();
+      return ~f(~0u, s, len);
+    }
+    inline uint32_t crc32c(const char* s)
+    {
+      return crc32c(s, static_cast<size_t>(strlen(s)));
+    }
+  }
+
+  // (the overloads with a length take buffers that may contain NUL bytes)
+  constexpr uint32_t crc32(const char* s)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::crc::value<crc32_poly>(s, static_cast<size_t>(strlen(s))) :
+      CX_RUNTIME_DISPATCH(runtime::crc32(s), err::crc32_runtime_error);
+  }
+  constexpr uint32_t crc32(const char* s, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::crc::value<crc32_poly>(s, len) :
+      CX_RUNTIME_DISPATCH(runtime::crc32(s, len), err::crc32_runtime_error);
+  }
+
+  constexpr uint32_t crc32c(const char* s)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::crc::value<crc32c_poly>(s, static_cast<size_t>(strlen(s))) :
+      CX_RUNTIME_DISPATCH(runtime::crc32c(s), err::crc32c_runtime_error);
+  }
+  constexpr uint32_t crc32c(const char* s, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::crc::value<crc32c_poly>(s, len) :
+      CX_RUNTIME_DISPATCH(runtime::crc32c(s, len), err::crc32c_runtime_error);
+  }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CX_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define CX_HAVE_MMAP 0
+#include <cstdio>
+#include <vector>
+#endif
+
+//----------------------------------------------------------------------------
+// read-only access to a whole file (runtime only)
+//
+// Where mmap is available the file is mapped, so that hashing reads straight
+// from the page cache without copying; otherwise it is read into memory.
+// Failures throw std::system_error.
+
+namespace cx
+{
+  namespace runtime
+  {
+    class mapped_file
+    {
+    public:
+      explicit mapped_file(const char* path)
+        : m_data(nullptr), m_size(0)
+      {
+#if CX_HAVE_MMAP
+        const int fd = ::open(path, O_RDONLY);
+        if (fd < 0) fail(path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+          const int e = errno;
+          ::close(fd);
+          fail(path, e);
+        }
+        m_size = static_cast<size_t>(st.st_size);
+        // mmap can't map an empty file
+        if (m_size > 0)
+        {
+          void* p = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+          if (p == MAP_FAILED)
+          {
+            const int e = errno;
+            ::close(fd);
+            fail(path, e);
+          }
+          ::madvise(p, m_size, MADV_SEQUENTIAL);
+          m_data = static_cast<const char*>(p);
+        }
+        ::close(fd);
+#else
+        std::FILE* f = std::fopen(path, "rb");
+        if (!f) fail(path);
+        char buf[65536];
+        while (size_t n = std::fread(buf, 1, sizeof(buf), f))
+        {
+          m_buf.insert(m_buf.end(), buf, buf + n);
+        }
+        const bool ok = !std::ferror(f);
+        std::fclose(f);
+        if (!ok) fail(path, EIO);
+        m_data = m_buf.data();
+        m_size = m_buf.size();
+#endif
+      }
+
+      ~mapped_file()
+      {
+#if CX_HAVE_MMAP
+        if (m_data) ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+      }
+
+      mapped_file(const mapped_file&) = delete;
+      mapped_file& operator=(const mapped_file&) = delete;
+
+      const char* data() const { return m_data; }
+      size_t size() const { return m_size; }
+
+    private:
+      [[noreturn]] static void fail(const char* path, int e = errno)
+      {
+        throw std::system_error(e, std::generic_category(), path);
+      }
+
+      const char* m_data;
+      size_t m_size;
+#if !CX_HAVE_MMAP
+      std::vector<char> m_buf;
+#endif
+    };
+  }
+}
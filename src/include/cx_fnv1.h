@@ -1,9 +1,13 @@
 #pragma once
 
+#include "cx_runtime.h"
+#include "cx_utils.h"
+
+#include <cstddef>
 #include <cstdint>
 
 //----------------------------------------------------------------------------
-// constexpr string hashing: fnv1 & fnv1a
+// constexpr string hashing: fnv1 & fnv1a (64-bit), fnv1a_32, fnv1a_128
 
 namespace cx
 {
@@ -11,36 +15,212 @@ namespace cx
   {
     namespace
     {
-      extern const char* fnv1_runtime_error;
-      extern const char* fnv1a_runtime_error;
+      CX_ERROR_SYMBOL(fnv1_runtime_error);
+      CX_ERROR_SYMBOL(fnv1a_runtime_error);
+      CX_ERROR_SYMBOL(fnv1a_32_runtime_error);
+      CX_ERROR_SYMBOL(fnv1a_128_runtime_error);
     }
   }
+
+  // Result of a 128-bit fnv1a calculation: h[0] is the high 64 bits, h[1] the
+  // low 64 bits (so printing them in order gives the conventional hex value)
+  struct fnv128sum
+  {
+    uint64_t h[2];
+  };
+
   namespace detail
   {
     namespace fnv
     {
-      constexpr uint64_t fnv1(uint64_t h, const char* s)
+      // the variants, each a hash type, offset basis and per-byte step
+      struct fnv1_64
+      {
+        using type = uint64_t;
+        static constexpr type basis() { return 14695981039346656037ull; }
+        static constexpr type step(type h, uint32_t c)
+        {
+          return (h * 1099511628211ull) ^ c;
+        }
+      };
+      struct fnv1a_64
+      {
+        using type = uint64_t;
+        static constexpr type basis() { return 14695981039346656037ull; }
+        static constexpr type step(type h, uint32_t c)
+        {
+          return (h ^ c) * 1099511628211ull;
+        }
+      };
+      struct fnv1a_32
+      {
+        using type = uint32_t;
+        static constexpr type basis() { return 2166136261u; }
+        static constexpr type step(type h, uint32_t c)
+        {
+          return (h ^ c) * 16777619u;
+        }
+      };
+
+      // the 128-bit prime is 2^88 + 0x13b, so multiplying by it is a shift
+      // and a small multiply (whose carry out of the low word we need)
+      constexpr uint64_t mul13b_carry(uint64_t lo)
+      {
+        return ((lo >> 32) * 0x13b + (((lo & 0xffffffff) * 0x13b) >> 32)) >> 32;
+      }
+      constexpr fnv128sum mul128prime(const fnv128sum& x)
       {
-        return (*s == 0) ? h :
-          fnv1((h * 1099511628211ull) ^ static_cast<uint64_t>(*s), s+1);
+        return { { x.h[0] * 0x13b + mul13b_carry(x.h[1]) + (x.h[1] << 24),
+              x.h[1] * 0x13b } };
       }
-      constexpr uint64_t fnv1a(uint64_t h, const char* s)
+      struct fnv1a_128
+      {
+        using type = fnv128sum;
+        static constexpr type basis()
+        {
+          return { { 0x6c62272e07bb0142ull, 0x62b821756295c58dull } };
+        }
+        static constexpr type step(const type& h, uint32_t c)
+        {
+          return mul128prime({ { h.h[0], h.h[1] ^ c } });
+        }
+      };
+
+      // Hashing with naive recursion would exceed the max recursion depth on
+      // long strings, so (as with strlen) hash in chunks of at most maxdepth
+      // characters: the depth is then about maxdepth + length/maxdepth.
+      template <typename A>
+      struct state
+      {
+        typename A::type h;
+        const char* s;
+        size_t len;
+      };
+
+      // NUL-terminated
+      template <typename A>
+      constexpr state<A> hash(const state<A>& p, int maxdepth)
       {
-        return (*s == 0) ? h :
-          fnv1a((h ^ static_cast<uint64_t>(*s)) * 1099511628211ull, s+1);
+        return *p.s == 0 || maxdepth == 0 ? p :
+          hash<A>({ A::step(p.h, byte32(*p.s)), p.s+1, 0 }, maxdepth-1);
+      }
+      template <typename A>
+      constexpr state<A> hash_bychunk(const state<A>& p, int maxdepth)
+      {
+        return *p.s == 0 ? p :
+          hash_bychunk<A>(hash<A>(p, maxdepth), maxdepth);
+      }
+
+      // explicit length (len is the number of bytes remaining)
+      template <typename A>
+      constexpr state<A> hashlen(const state<A>& p, int maxdepth)
+      {
+        return p.len == 0 || maxdepth == 0 ? p :
+          hashlen<A>({ A::step(p.h, byte32(*p.s)), p.s+1, p.len-1 }, maxdepth-1);
+      }
+      template <typename A>
+      constexpr state<A> hashlen_bychunk(const state<A>& p, int maxdepth)
+      {
+        return p.len == 0 ? p :
+          hashlen_bychunk<A>(hashlen<A>(p, maxdepth), maxdepth);
+      }
+
+      // max recursion = 256, as for strlen
+      template <typename A>
+      constexpr typename A::type value(const char* s)
+      {
+        return hash_bychunk<A>({ A::basis(), s, 0 }, 256).h;
+      }
+      template <typename A>
+      constexpr typename A::type value(const char* s, size_t len)
+      {
+        return hashlen_bychunk<A>({ A::basis(), s, len }, 256).h;
       }
     }
   }
+
+  // runtime versions (see cx_runtime.h)
+  namespace runtime
+  {
+    template <typename A>
+    inline typename A::type fnv(const char* s)
+    {
+      typename A::type h = A::basis();
+      for (; *s != 0; ++s)
+      {
+        h = A::step(h, byte32(*s));
+      }
+      return h;
+    }
+    template <typename A>
+    inline typename A::type fnv(const char* s, size_t len)
+    {
+      typename A::type h = A::basis();
+      for (const char* const end = s + len; s != end; ++s)
+      {
+        h = A::step(h, byte32(*s));
+      }
+      return h;
+    }
+  }
+
   constexpr uint64_t fnv1(const char* s)
   {
-    return true ?
-      detail::fnv::fnv1(14695981039346656037ull, s) :
-      throw err::fnv1_runtime_error;
+    return CX_CONSTANT_EVALUATED() ?
+      detail::fnv::value<detail::fnv::fnv1_64>(s) :
+      CX_RUNTIME_DISPATCH(runtime::fnv<detail::fnv::fnv1_64>(s),
+                          err::fnv1_runtime_error);
+  }
+  constexpr uint64_t fnv1(const char* s, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::fnv::value<detail::fnv::fnv1_64>(s, len) :
+      CX_RUNTIME_DISPATCH(runtime::fnv<detail::fnv::fnv1_64>(s, len),
+                          err::fnv1_runtime_error);
   }
+
   constexpr uint64_t fnv1a(const char* s)
   {
-    return true ?
-      detail::fnv::fnv1a(14695981039346656037ull, s) :
-      throw err::fnv1a_runtime_error;
+    return CX_CONSTANT_EVALUATED() ?
+      detail::fnv::value<detail::fnv::fnv1a_64>(s) :
+      CX_RUNTIME_DISPATCH(runtime::fnv<detail::fnv::fnv1a_64>(s),
+                          err::fnv1a_runtime_error);
+  }
+  constexpr uint64_t fnv1a(const char* s, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::fnv::value<detail::fnv::fnv1a_64>(s, len) :
+      CX_RUNTIME_DISPATCH(runtime::fnv<detail::fnv::fnv1a_64>(s, len),
+                          err::fnv1a_runtime_error);
+  }
+
+  constexpr uint32_t fnv1a_32(const char* s)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::fnv::value<detail::fnv::fnv1a_32>(s) :
+      CX_RUNTIME_DISPATCH(runtime::fnv<detail::fnv::fnv1a_32>(s),
+                          err::fnv1a_32_runtime_error);
+  }
+  constexpr uint32_t fnv1a_32(const char* s, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::fnv::value<detail::fnv::fnv1a_32>(s, len) :
+      CX_RUNTIME_DISPATCH(runtime::fnv<detail::fnv::fnv1a_32>(s, len),
+                          err::fnv1a_32_runtime_error);
+  }
+
+  constexpr fnv128sum fnv1a_128(const char* s)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::fnv::value<detail::fnv::fnv1a_128>(s) :
+      CX_RUNTIME_DISPATCH(runtime::fnv<detail::fnv::fnv1a_128>(s),
+                          err::fnv1a_128_runtime_error);
+  }
+  constexpr fnv128sum fnv1a_128(const char* s, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::fnv::value<detail::fnv::fnv1a_128>(s, len) :
+      CX_RUNTIME_DISPATCH(runtime::fnv<detail::fnv::fnv1a_128>(s, len),
+                          err::fnv1a_128_runtime_error);
   }
 }
@@ -18,7 +18,7 @@ namespace cx
   {
     namespace
     {
-      extern const char* guidgen_runtime_error;
+      CX_ERROR_SYMBOL(guidgen_runtime_error);
     }
   }
 
@@ -0,0 +1,367 @@
+#pragma once
+
+#include "cx_algorithm.h"
+#include "cx_array.h"
+#include "cx_cpuid.h"
+#include "cx_murmur3.h"
+#include "cx_utils.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+//----------------------------------------------------------------------------
+// constexpr hashing of values: hash_value and hash_combine
+//
+// hash_value gives a 32-bit hash of an integer, a string, an array or a pair;
+// hash_combine hashes a sequence of values. Both are built from murmur3_32's
+// block round and finalizer, so composite keys spread as well as murmur3_32
+// strings do (unlike xor-combining, which cancels equal fields and clusters
+// keys that differ only in order):
+//
+//   constexpr auto h = cx::hash_combine(42, "GET", cx::pair<int, int>{ 1, 2 });
+//
+// An integer hashes as murmur3_32 (seed 0) of its value as 4 (or, for 64-bit
+// types, 8) little-endian bytes. hash_combine(x0, ..., xn-1) is murmur3_32
+// over the words hash_value(x0), ..., hash_value(xn-1), and an array or a pair
+// hashes as hash_combine of its elements.
+//
+// For a struct, provide a hash_value overload in its namespace in terms of
+// hash_combine; it is then found (by argument-dependent lookup) for arrays and
+// pairs of the struct, and for hash_combine of it:
+//
+//   constexpr uint32_t hash_value(const point& p) { return cx::hash_combine(p.x, p.y); }
+//
+// Integers, pairs and hash_combine are cheap and non-recursive (or recursive
+// to the number of arguments), so they run as is at runtime. Strings and
+// arrays dispatch at runtime (see cx_runtime.h); there, arrays of 32-bit and
+// 64-bit integers hash their elements in 8-lane vectors with AVX2 where
+// available, leaving only the rounds that combine them serial.
+
+namespace cx
+{
+  namespace err
+  {
+    namespace
+    {
+      CX_ERROR_SYMBOL(hash_value_runtime_error);
+    }
+  }
+
+  namespace detail
+  {
+    namespace hashv
+    {
+      // the integers hash as murmur3_32 of their bytes: one or two block
+      // rounds from seed 0, then the finalizer
+      constexpr uint32_t hash32(uint32_t x)
+      {
+        return murmur::murmur3_32_final(
+            murmur::murmur3_32_hashround(murmur::murmur3_32_k(x), 0), 4);
+      }
+      constexpr uint32_t hash64(uint64_t x)
+      {
+        return murmur::murmur3_32_final(
+            murmur::murmur3_32_hashround(
+                murmur::murmur3_32_k(static_cast<uint32_t>(x >> 32)),
+                murmur::murmur3_32_hashround(
+                    murmur::murmur3_32_k(static_cast<uint32_t>(x)), 0)),
+            8);
+      }
+
+      // combining: each value's hash is a murmur3_32 block
+      constexpr uint32_t mix(uint32_t h, uint32_t v)
+      {
+        return murmur::murmur3_32_hashround(murmur::murmur3_32_k(v), h);
+      }
+      constexpr uint32_t finish(uint32_t h, size_t n)
+      {
+        return murmur::murmur3_32_final(h, n * 4);
+      }
+    }
+  }
+
+  template <typename T>
+  constexpr auto hash_value(T x)
+    -> typename std::enable_if<std::is_integral<T>::value && sizeof(T) <= 4, uint32_t>::type
+  {
+    return detail::hashv::hash32(static_cast<uint32_t>(x));
+  }
+  template <typename T>
+  constexpr auto hash_value(T x)
+    -> typename std::enable_if<std::is_integral<T>::value && sizeof(T) == 8, uint32_t>::type
+  {
+    return detail::hashv::hash64(static_cast<uint64_t>(x));
+  }
+
+  // a string hashes as murmur3_32 (seed 0) of its bytes
+  constexpr uint32_t hash_value(const char* s)
+  {
+    return murmur3_32(s, 0);
+  }
+
+  namespace detail
+  {
+    namespace hashv
+    {
+      constexpr uint32_t combine(uint32_t h, size_t n)
+      {
+        return finish(h, n);
+      }
+      template <typename T, typename ...Ts>
+      constexpr uint32_t combine(uint32_t h, size_t n, const T& x, const Ts&... xs)
+      {
+        return combine(mix(h, hash_value(x)), n, xs...);
+      }
+    }
+  }
+
+  template <typename ...Ts>
+  constexpr uint32_t hash_combine(const Ts&... xs)
+  {
+    return detail::hashv::combine(0, sizeof...(Ts), xs...);
+  }
+
+  template <typename T1, typename T2>
+  constexpr uint32_t hash_value(const pair<T1, T2>& p)
+  {
+    return hash_combine(p.first, p.second);
+  }
+
+  namespace detail
+  {
+    namespace hashv
+    {
+      // as with fnv, recurse in chunks to bound the recursion depth
+      struct state
+      {
+        uint32_t h;
+        size_t i;
+      };
+      template <typename T, size_t N>
+      constexpr state elements(const array<T, N>& a, const state& s, int maxdepth)
+      {
+        return s.i == N || maxdepth == 0 ? s :
+          elements(a, { mix(s.h, hash_value(a[s.i])), s.i + 1 }, maxdepth - 1);
+      }
+      template <typename T, size_t N>
+      constexpr state elements_bychunk(const array<T, N>& a, const state& s)
+      {
+        return s.i == N ? s : elements_bychunk(a, elements(a, s, 256));
+      }
+      template <typename T, size_t N>
+      constexpr uint32_t array_hash(const array<T, N>& a)
+      {
+        return finish(elements_bychunk(a, { 0, 0 }).h, N);
+      }
+    }
+  }
+
+  // runtime versions (see cx_runtime.h)
+  namespace runtime
+  {
+    namespace detail_hash_value
+    {
+      // A kernel mixes the hashes of n integers into h, in order; the block
+      // word of each hash, murmur3_32_k(hash_value(x)), is independent of h,
+      // so only the rounds that mix them in are serial.
+      using mix_fn = uint32_t (*)(uint32_t, const char*, size_t);
+
+      // (the integers are read in native byte order: they are values, not
+      // bytes)
+      struct scalar
+      {
+        static uint32_t mix32(uint32_t h, const char* p, size_t n)
+        {
+          for (size_t i = 0; i < n; ++i)
+          {
+            uint32_t x;
+            std::memcpy(&x, p + 4*i, 4);
+            h = detail::hashv::mix(h, detail::hashv::hash32(x));
+          }
+          return h;
+        }
+        static uint32_t mix64(uint32_t h, const char* p, size_t n)
+        {
+          for (size_t i = 0; i < n; ++i)
+          {
+            uint64_t x;
+            std::memcpy(&x, p + 8*i, 8);
+            h = detail::hashv::mix(h, detail::hashv::hash64(x));
+          }
+          return h;
+        }
+      };
+
+#if CX_X86_SIMD
+      template <int R>
+      __attribute__((target("avx2")))
+      inline __m256i rotl(__m256i x)
+      {
+        return _mm256_or_si256(_mm256_slli_epi32(x, R), _mm256_srli_epi32(x, 32 - R));
+      }
+      __attribute__((target("avx2")))
+      inline __m256i mul(__m256i x, uint32_t c)
+      {
+        return _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(c)));
+      }
+      __attribute__((target("avx2")))
+      inline __m256i xorshift(__m256i x, int r)
+      {
+        return _mm256_xor_si256(x, _mm256_srli_epi32(x, r));
+      }
+
+      // murmur3_32_k, murmur3_32_hashround and murmur3_32_final on 8 lanes
+      __attribute__((target("avx2")))
+      inline __m256i k8(__m256i k)
+      {
+        return mul(rotl<15>(mul(k, 0xcc9e2d51)), 0x1b873593);
+      }
+      __attribute__((target("avx2")))
+      inline __m256i round8(__m256i k, __m256i h)
+      {
+        return _mm256_add_epi32(mul(rotl<13>(_mm256_xor_si256(h, k)), 5),
+                                _mm256_set1_epi32(static_cast<int>(0xe6546b64)));
+      }
+      __attribute__((target("avx2")))
+      inline __m256i final8(__m256i h, uint32_t len)
+      {
+        h = _mm256_xor_si256(h, _mm256_set1_epi32(static_cast<int>(len)));
+        return xorshift(mul(xorshift(mul(xorshift(h, 16), 0x85ebca6b), 13), 0xc2b2ae35), 16);
+      }
+
+      __attribute__((target("avx2")))
+      inline __m256i load256(const char* p)
+      {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+      }
+
+      // the block words of eight 32-bit integers' hashes
+      __attribute__((target("avx2")))
+      inline __m256i keys8(__m256i x)
+      {
+        return k8(final8(round8(k8(x), _mm256_setzero_si256()), 4));
+      }
+      // and of eight 64-bit integers': their low and high words are gathered
+      // into a vector each (shuffle_ps interleaves 128-bit lanes; the permute
+      // restores element order)
+      __attribute__((target("avx2")))
+      inline __m256i keys8(__m256i x, __m256i y)
+      {
+        const __m256 a = _mm256_castsi256_ps(x);
+        const __m256 b = _mm256_castsi256_ps(y);
+        const __m256i lo = _mm256_permute4x64_epi64(
+            _mm256_castps_si256(_mm256_shuffle_ps(a, b, 0x88)), 0xd8);
+        const __m256i hi = _mm256_permute4x64_epi64(
+            _mm256_castps_si256(_mm256_shuffle_ps(a, b, 0xdd)), 0xd8);
+        return k8(final8(round8(k8(hi), round8(k8(lo), _mm256_setzero_si256())), 8));
+      }
+
+      // the rounds that mix in eight block words, in order
+      __attribute__((target("avx2")))
+      inline uint32_t mix8(uint32_t h, __m256i k)
+      {
+        alignas(32) uint32_t w[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(w), k);
+        for (int j = 0; j < 8; ++j)
+        {
+          h = detail::murmur::murmur3_32_hashround(w[j], h);
+        }
+        return h;
+      }
+
+      // two vectors of block words at a time, so that computing them overlaps
+      // the serial rounds
+      struct avx2
+      {
+        __attribute__((target("avx2")))
+        static uint32_t mix32(uint32_t h, const char* p, size_t n)
+        {
+          size_t i = 0;
+          for (; i + 16 <= n; i += 16)
+          {
+            const __m256i k0 = keys8(load256(p + 4*i));
+            const __m256i k1 = keys8(load256(p + 4*i + 32));
+            h = mix8(mix8(h, k0), k1);
+          }
+          return scalar::mix32(h, p + 4*i, n - i);
+        }
+
+        __attribute__((target("avx2")))
+        static uint32_t mix64(uint32_t h, const char* p, size_t n)
+        {
+          size_t i = 0;
+          for (; i + 16 <= n; i += 16)
+          {
+            const __m256i k0 = keys8(load256(p + 8*i), load256(p + 8*i + 32));
+            const __m256i k1 = keys8(load256(p + 8*i + 64), load256(p + 8*i + 96));
+            h = mix8(mix8(h, k0), k1);
+          }
+          return scalar::mix64(h, p + 8*i, n - i);
+        }
+      };
+#endif
+
+      inline mix_fn mix32_select()
+      {
+#if CX_X86_SIMD
+        return cpu().avx2 ? avx2::mix32 : scalar::mix32;
+#else
+        return scalar::mix32;
+#endif
+      }
+      inline mix_fn mix64_select()
+      {
+#if CX_X86_SIMD
+        return cpu().avx2 ? avx2::mix64 : scalar::mix64;
+#else
+        return scalar::mix64;
+#endif
+      }
+
+      // the element width for the vector kernels, or 0
+      template <typename T>
+      using width = std::integral_constant<size_t,
+        std::is_integral<T>::value && !std::is_same<T, bool>::value
+        && (sizeof(T) == 4 || sizeof(T) == 8) ? sizeof(T) : 0>;
+
+      template <typename T, size_t N>
+      inline uint32_t array_hash(const array<T, N>& a, std::integral_constant<size_t, 0>)
+      {
+        uint32_t h = 0;
+        for (const T* p = a.begin(); p != a.end(); ++p)
+        {
+          h = detail::hashv::mix(h, hash_value(*p));
+        }
+        return detail::hashv::finish(h, N);
+      }
+      template <typename T, size_t N>
+      inline uint32_t array_hash(const array<T, N>& a, std::integral_constant<size_t, 4>)
+      {
+        static const mix_fn f = mix32_select();
+        return detail::hashv::finish(f(0, reinterpret_cast<const char*>(a.begin()), N), N);
+      }
+      template <typename T, size_t N>
+      inline uint32_t array_hash(const array<T, N>& a, std::integral_constant<size_t, 8>)
+      {
+        static const mix_fn f = mix64_select();
+        return detail::hashv::finish(f(0, reinterpret_cast<const char*>(a.begin()), N), N);
+      }
+    }
+
+    template <typename T, size_t N>
+    inline uint32_t array_hash(const array<T, N>& a)
+    {
+      return detail_hash_value::array_hash(a, detail_hash_value::width<T>());
+    }
+  }
+
+  template <typename T, size_t N>
+  constexpr uint32_t hash_value(const array<T, N>& a)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::hashv::array_hash(a) :
+      CX_RUNTIME_DISPATCH(runtime::array_hash(a), err::hash_value_runtime_error);
+  }
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "cx_fnv1.h"
+#include "cx_utils.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <type_traits>
+
+//----------------------------------------------------------------------------
+// a string view that carries its fnv1a hash
+//
+// For a literal the hash is computed at compile time; for a runtime string,
+// once, when the hashed_string is made. With the transparent hasher and
+// equality below, an unordered container never rehashes the key, and key
+// comparison stops at a hash mismatch before comparing any bytes:
+//
+//   using table = std::unordered_map<cx::hashed_string, int,
+//                                    cx::hashed_string_hash,
+//                                    cx::hashed_string_equal>;
+//   auto i = t.find(cx_hashed_string("GET"));   // no hashing at runtime
+//
+// A hashed_string doesn't own its bytes, so keys stored in a container must
+// outlive it (literals always do). Under C++20, whose unordered containers
+// support heterogeneous lookup, the same hasher and equality also let a
+// container keyed by std::string be searched with hashed_strings.
+
+namespace cx
+{
+  namespace detail
+  {
+    namespace hstr
+    {
+      constexpr bool equal_bytes(const char* a, const char* b, size_t len)
+      {
+        for (size_t i = 0; i < len; ++i)
+        {
+          if (a[i] != b[i]) return false;
+        }
+        return true;
+      }
+    }
+  }
+
+  class hashed_string
+  {
+  public:
+    using hash_type = uint64_t;
+
+    // a string whose hash is already known (see cx_hashed_string below)
+    constexpr hashed_string(const char* s, size_t len, hash_type h)
+      : m_data(s), m_size(len), m_hash(h)
+    {}
+
+    // Hashed at compile time when constant-evaluated, e.g. for a constexpr
+    // hashed_string; at runtime this requires CX_RUNTIME (see cx_runtime.h)
+    explicit constexpr hashed_string(const char* s)
+      : hashed_string(s, static_cast<size_t>(strlen(s)))
+    {}
+    constexpr hashed_string(const char* s, size_t len)
+      : m_data(s), m_size(len), m_hash(fnv1a(s, len))
+    {}
+
+    // a runtime string, hashed here; explicit, and not from a temporary,
+    // since the hashed_string only points at the string's bytes
+    explicit hashed_string(const std::string& s)
+      : m_data(s.data()), m_size(s.size()),
+        m_hash(runtime::fnv<detail::fnv::fnv1a_64>(s.data(), s.size()))
+    {}
+    hashed_string(std::string&&) = delete;
+
+    constexpr const char* data() const { return m_data; }
+    constexpr size_t size() const { return m_size; }
+    constexpr hash_type hash() const { return m_hash; }
+
+    std::string str() const { return std::string(m_data, m_size); }
+
+    // different hashes mean different strings, so the bytes are compared
+    // only when the hashes match
+    friend constexpr bool operator==(const hashed_string& a, const hashed_string& b)
+    {
+      return a.m_hash == b.m_hash && a.m_size == b.m_size
+        && detail::hstr::equal_bytes(a.m_data, b.m_data, a.m_size);
+    }
+    friend constexpr bool operator!=(const hashed_string& a, const hashed_string& b)
+    {
+      return !(a == b);
+    }
+
+  private:
+    const char* m_data;
+    size_t m_size;
+    hash_type m_hash;
+  };
+
+  // transparent hasher: a hashed_string's hash is used as it is, while
+  // anything else is hashed the same way
+  struct hashed_string_hash
+  {
+    using is_transparent = void;
+
+    size_t operator()(const hashed_string& s) const
+    {
+      return static_cast<size_t>(s.hash());
+    }
+    size_t operator()(const std::string& s) const
+    {
+      return static_cast<size_t>(runtime::fnv<detail::fnv::fnv1a_64>(s.data(), s.size()));
+    }
+  };
+
+  // transparent equality: two hashed_strings compare hashes first; a plain
+  // string has no stored hash, so comparing with one checks the size first
+  struct hashed_string_equal
+  {
+    using is_transparent = void;
+
+    bool operator()(const hashed_string& a, const hashed_string& b) const
+    {
+      return a == b;
+    }
+    bool operator()(const hashed_string& a, const std::string& b) const
+    {
+      return a.size() == b.size() && detail::hstr::equal_bytes(a.data(), b.data(), a.size());
+    }
+    bool operator()(const std::string& a, const hashed_string& b) const
+    {
+      return (*this)(b, a);
+    }
+    bool operator()(const std::string& a, const std::string& b) const
+    {
+      return a == b;
+    }
+  };
+}
+
+// so that std containers of hashed_strings work with their default hasher
+namespace std
+{
+  template <>
+  struct hash<cx::hashed_string> : cx::hashed_string_hash
+  {};
+}
+
+// a hashed_string for a literal, hashed at compile time even where the
+// hashed_string itself isn't constexpr
+#define cx_hashed_string(s)                                             \
+  cx::hashed_string(s, sizeof(s) - 1,                                   \
+                    std::integral_constant<uint64_t, cx::fnv1a(s, sizeof(s) - 1)>::value)
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "cx_sha256.h"
+#include "cx_utils.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+//----------------------------------------------------------------------------
+// constexpr message authentication: hmac-sha256 (RFC 2104)
+//
+// HMAC(K, m) = H((K ^ opad) || H((K ^ ipad) || m)), where the padded key is
+// exactly one sha-256 block. The state after that block depends only on the
+// key, so a key known at compile time can be absorbed at compile time:
+//
+//   constexpr auto key = cx::make_hmac_sha256_key("secret");
+//   auto mac = cx::hmac_sha256(key, msg, len);
+//
+// Each signature then costs only the message blocks and one outer block
+// (a message under 56 bytes takes two sha-256 compressions rather than four).
+
+namespace cx
+{
+  namespace err
+  {
+    namespace
+    {
+      CX_ERROR_SYMBOL(hmac_sha256_key_runtime_error);
+      CX_ERROR_SYMBOL(hmac_sha256_runtime_error);
+    }
+  }
+
+  // the sha-256 states after the inner (ipad) and outer (opad) key blocks
+  struct hmac_sha256_key
+  {
+    sha256sum inner;
+    sha256sum outer;
+  };
+
+  namespace detail
+  {
+    namespace hmac
+    {
+      // Keys longer than a block are hashed first; either way the key is
+      // zero-padded to 16 words. (k is the big-endian hash of a long key.)
+      constexpr uint32_t keyword(const char* key, int len, int i)
+      {
+        return word32be(len > 4*i ? key + 4*i : key, len - 4*i);
+      }
+      constexpr uint32_t keyword(const sha256sum& k, int i)
+      {
+        return i < 8 ? k.h[i] : 0;
+      }
+
+      template <typename K>
+      constexpr sha256::schedule keyblock(const K& k, uint32_t pad)
+      {
+        return { { k(0) ^ pad, k(1) ^ pad, k(2) ^ pad, k(3) ^ pad,
+              k(4) ^ pad, k(5) ^ pad, k(6) ^ pad, k(7) ^ pad,
+              k(8) ^ pad, k(9) ^ pad, k(10) ^ pad, k(11) ^ pad,
+              k(12) ^ pad, k(13) ^ pad, k(14) ^ pad, k(15) ^ pad } };
+      }
+
+      struct shortkey
+      {
+        const char* key;
+        int len;
+        constexpr uint32_t operator()(int i) const { return keyword(key, len, i); }
+      };
+      struct longkey
+      {
+        sha256sum k;
+        constexpr uint32_t operator()(int i) const { return keyword(k, i); }
+      };
+
+      constexpr uint32_t ipad = 0x36363636;
+      constexpr uint32_t opad = 0x5c5c5c5c;
+
+      template <typename K>
+      constexpr hmac_sha256_key states(const K& k)
+      {
+        return { sha256::sha256transform(sha256::init(), keyblock(k, ipad)),
+            sha256::sha256transform(sha256::init(), keyblock(k, opad)) };
+      }
+      constexpr hmac_sha256_key key(const char* key, int len)
+      {
+        return len > 64 ?
+          states(longkey{ sha256::sha256withlen(key, len) }) :
+          states(shortkey{ key, len });
+      }
+
+      // the outer hash's only block: the 32-byte inner digest, padded, with
+      // the total length (the key block and the digest) in bits
+      constexpr sha256::schedule outerblock(const sha256sum& d)
+      {
+        return { { d.h[0], d.h[1], d.h[2], d.h[3], d.h[4], d.h[5], d.h[6], d.h[7],
+              0x80000000, 0, 0, 0, 0, 0, 0, (64 + 32) * 8 } };
+      }
+
+      // the inner hash continues from the key block, so the message length
+      // in the padding includes it
+      constexpr sha256sum hmac(const hmac_sha256_key& k, const char* msg, int len)
+      {
+        return sha256::sha256tole(sha256::sha256transform(
+                                      k.outer, outerblock(sha256::sha256update(
+                                                              k.inner, msg, len,
+                                                              64 + static_cast<uint64_t>(len)))));
+      }
+    }
+  }
+
+  // runtime versions (see cx_runtime.h)
+  namespace runtime
+  {
+    inline hmac_sha256_key make_hmac_sha256_key(const char* key, size_t len)
+    {
+      char block[64] = {};
+      if (len > 64)
+      {
+        const sha256sum k = sha256(key, len);
+        std::memcpy(block, k.h, sizeof(k.h));
+      }
+      else if (len > 0)
+      {
+        std::memcpy(block, key, len);
+      }
+      detail::sha256::schedule inner = detail::sha256::init(block);
+      detail::sha256::schedule outer = inner;
+      for (int i = 0; i < 16; ++i)
+      {
+        inner.w[i] ^= detail::hmac::ipad;
+        outer.w[i] ^= detail::hmac::opad;
+      }
+      hmac_sha256_key h = { detail::sha256::init(), detail::sha256::init() };
+      sha256transform(h.inner, inner);
+      sha256transform(h.outer, outer);
+      return h;
+    }
+    inline hmac_sha256_key make_hmac_sha256_key(const char* key)
+    {
+      return make_hmac_sha256_key(key, static_cast<size_t>(strlen(key)));
+    }
+
+    inline sha256sum hmac_sha256(const hmac_sha256_key& k, const char* msg, size_t len)
+    {
+      sha256sum inner = k.inner;
+      sha256blocks(inner, msg, len / 64);
+      // sha256final gives the digest in byte order, as sha256 does, which is
+      // the message for the outer hash: one padded block, after the key's
+      const sha256sum d = sha256final(
+          inner, msg + (len & ~size_t{63}), static_cast<int>(len & 63), 64 + len);
+      return sha256final(k.outer, reinterpret_cast<const char*>(d.h), sizeof(d.h),
+                         64 + sizeof(d.h));
+    }
+    inline sha256sum hmac_sha256(const hmac_sha256_key& k, const char* msg)
+    {
+      return hmac_sha256(k, msg, static_cast<size_t>(strlen(msg)));
+    }
+  }
+
+  // the key states for a key (of any length)
+  constexpr hmac_sha256_key make_hmac_sha256_key(const char* key)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::hmac::key(key, strlen(key)) :
+      CX_RUNTIME_DISPATCH(runtime::make_hmac_sha256_key(key),
+                          err::hmac_sha256_key_runtime_error);
+  }
+  constexpr hmac_sha256_key make_hmac_sha256_key(const char* key, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::hmac::key(key, static_cast<int>(len)) :
+      CX_RUNTIME_DISPATCH(runtime::make_hmac_sha256_key(key, len),
+                          err::hmac_sha256_key_runtime_error);
+  }
+
+  // hmac-sha256 of a message, with a prepared key; the result is in the same
+  // byte order as sha256
+  constexpr sha256sum hmac_sha256(const hmac_sha256_key& k, const char* msg)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::hmac::hmac(k, msg, strlen(msg)) :
+      CX_RUNTIME_DISPATCH(runtime::hmac_sha256(k, msg), err::hmac_sha256_runtime_error);
+  }
+  constexpr sha256sum hmac_sha256(const hmac_sha256_key& k, const char* msg, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::hmac::hmac(k, msg, static_cast<int>(len)) :
+      CX_RUNTIME_DISPATCH(runtime::hmac_sha256(k, msg, len),
+                          err::hmac_sha256_runtime_error);
+  }
+
+  // with the key given directly (prepared on each call)
+  constexpr sha256sum hmac_sha256(const char* key, const char* msg)
+  {
+    return hmac_sha256(make_hmac_sha256_key(key), msg);
+  }
+  constexpr sha256sum hmac_sha256(const char* key, size_t keylen,
+                                  const char* msg, size_t len)
+  {
+    return hmac_sha256(make_hmac_sha256_key(key, keylen), msg, len);
+  }
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "cx_runtime.h"
+
+#include <cmath>
 #include <limits>
 #include <type_traits>
 
@@ -227,31 +230,33 @@ namespace cx
   {
     namespace
     {
-      extern const char* abs_runtime_error;
-      extern const char* fabs_runtime_error;
-      extern const char* sqrt_domain_error;
-      extern const char* cbrt_runtime_error;
-      extern const char* exp_runtime_error;
-      extern const char* sin_runtime_error;
-      extern const char* cos_runtime_error;
-      extern const char* tan_domain_error;
-      extern const char* atan_runtime_error;
-      extern const char* atan2_domain_error;
-      extern const char* asin_domain_error;
-      extern const char* acos_domain_error;
-      extern const char* floor_runtime_error;
-      extern const char* ceil_runtime_error;
-      extern const char* fmod_domain_error;
-      extern const char* remainder_domain_error;
-      extern const char* fmax_runtime_error;
-      extern const char* fmin_runtime_error;
-      extern const char* fdim_runtime_error;
-      extern const char* log_domain_error;
-      extern const char* tanh_domain_error;
-      extern const char* acosh_domain_error;
-      extern const char* atanh_domain_error;
-      extern const char* pow_runtime_error;
-      extern const char* erf_runtime_error;
+      CX_ERROR_SYMBOL(abs_runtime_error);
+      CX_ERROR_SYMBOL(fabs_runtime_error);
+      CX_ERROR_SYMBOL(sqrt_domain_error);
+      CX_ERROR_SYMBOL(cbrt_runtime_error);
+      CX_ERROR_SYMBOL(exp_runtime_error);
+      CX_ERROR_SYMBOL(sin_runtime_error);
+      CX_ERROR_SYMBOL(sin_domain_error);
+      CX_ERROR_SYMBOL(cos_runtime_error);
+      CX_ERROR_SYMBOL(cos_domain_error);
+      CX_ERROR_SYMBOL(tan_domain_error);
+      CX_ERROR_SYMBOL(atan_runtime_error);
+      CX_ERROR_SYMBOL(atan2_domain_error);
+      CX_ERROR_SYMBOL(asin_domain_error);
+      CX_ERROR_SYMBOL(acos_domain_error);
+      CX_ERROR_SYMBOL(floor_runtime_error);
+      CX_ERROR_SYMBOL(ceil_runtime_error);
+      CX_ERROR_SYMBOL(fmod_domain_error);
+      CX_ERROR_SYMBOL(remainder_domain_error);
+      CX_ERROR_SYMBOL(fmax_runtime_error);
+      CX_ERROR_SYMBOL(fmin_runtime_error);
+      CX_ERROR_SYMBOL(fdim_runtime_error);
+      CX_ERROR_SYMBOL(log_domain_error);
+      CX_ERROR_SYMBOL(tanh_domain_error);
+      CX_ERROR_SYMBOL(acosh_domain_error);
+      CX_ERROR_SYMBOL(atanh_domain_error);
+      CX_ERROR_SYMBOL(pow_runtime_error);
+      CX_ERROR_SYMBOL(erf_runtime_error);
     }
   }
 
@@ -275,6 +280,17 @@ namespace cx
     {
       return abs(x - y) <= std::numeric_limits<T>::epsilon();
     }
+    // the same, relative to y, for iterations whose result may be of any
+    // magnitude
+    template <typename T>
+    constexpr bool rel_feq(T x, T y)
+    {
+      return abs(x - y) <= std::numeric_limits<T>::epsilon() * abs(y);
+    }
+
+    // Iterations converge in a handful of steps from where they start; this
+    // cap only guarantees termination.
+    constexpr int max_iterations = 64;
   }
 
   //----------------------------------------------------------------------------
@@ -312,16 +328,127 @@ namespace cx
         FloatingPoint{1} / ipow(x, -n);
     }
   }
+  // runtime versions (see cx_runtime.h) iterate or recurse (less deeply) in a
+  // way that performs exactly the same floating-point operations as the
+  // constexpr versions, so results are bit-identical
+  namespace runtime
+  {
+    // the same multiplication tree, but computing each half only once
+    template <typename FloatingPoint>
+    inline FloatingPoint ipow(FloatingPoint x, int n)
+    {
+      if (n == 0) return FloatingPoint{1};
+      if (n == 1) return x;
+      if (n < 0) return FloatingPoint{1} / ipow(x, -n);
+      if (n & 1) return x * ipow(x, n-1);
+      const FloatingPoint h = ipow(x, n/2);
+      return h * h;
+    }
+  }
 
   //----------------------------------------------------------------------------
-  // square root by Newton-Raphson method
+  // square root and cube root by Newton-Raphson method
+  //
+  // The argument is first scaled by an even (or, for cbrt, a multiple of
+  // three) power of two into [1/4, 4) (or [1/8, 8)), where Newton's method
+  // from 1 converges in a few steps; the root is then scaled back. Scaling
+  // goes down through 2^(N k) for k = 2^i, ..., 2, 1, so it takes a bounded
+  // number of steps for any exponent.
   namespace detail
   {
     template <typename T>
-    constexpr T sqrt(T x, T guess)
+    constexpr T sqrt_step(T x, T guess)
+    {
+      return (guess + x/guess)/T{2};
+    }
+    template <typename T>
+    constexpr T cbrt_step(T x, T guess)
+    {
+      return (T{2}*guess + x/(guess*guess))/T{3};
+    }
+    template <typename T, int N>
+    constexpr T root_step(T x, T guess)
     {
-      return feq(guess, (guess + x/guess)/T{2}) ? guess :
-        sqrt(x, (guess + x/guess)/T{2});
+      return N == 2 ? sqrt_step(x, guess) : cbrt_step(x, guess);
+    }
+    template <typename T, int N>
+    constexpr T root_newton(T x, T guess, int n = max_iterations)
+    {
+      return n == 0 || rel_feq(root_step<T, N>(x, guess), guess) ? guess :
+        root_newton<T, N>(x, root_step<T, N>(x, guess), n - 1);
+    }
+    // the largest power of two k for which 2^(N k) and 2^-(N k) are
+    // representable
+    template <typename T, int N>
+    constexpr int root_scale(int k = 1)
+    {
+      return N * k * 2 < std::numeric_limits<T>::max_exponent - 1 ?
+        root_scale<T, N>(k * 2) : k;
+    }
+    // the Nth root of a positive finite x
+    template <typename T, int N>
+    constexpr T root(T x, int k = root_scale<T, N>())
+    {
+      return k == 0 ? root_newton<T, N>(x, T{1}) :
+        x >= ipow(T{2}, N*k) ?
+          ipow(T{2}, k) * root<T, N>(x / ipow(T{2}, N*k), k) :
+        x < ipow(T{2}, -N*k) ?
+          root<T, N>(x * ipow(T{2}, N*k), k) / ipow(T{2}, k) :
+        root<T, N>(x, k/2);
+    }
+  }
+  namespace runtime
+  {
+    // the same scaling and iteration, as loops
+    template <typename T, int N>
+    inline T root(T x)
+    {
+      T scale{1};
+      for (int k = detail::root_scale<T, N>(); k > 0; k /= 2)
+      {
+        const T big = ipow(T{2}, N*k);
+        const T small = ipow(T{2}, -N*k);
+        for (;;)
+        {
+          if (x >= big)
+          {
+            x = x / big;
+            scale = scale * ipow(T{2}, k);
+          }
+          else if (x < small)
+          {
+            x = x * big;
+            scale = scale / ipow(T{2}, k);
+          }
+          else break;
+        }
+      }
+      T guess{1};
+      for (int n = detail::max_iterations; n > 0; --n)
+      {
+        const T next = detail::root_step<T, N>(x, guess);
+        if (detail::rel_feq(next, guess)) break;
+        guess = next;
+      }
+      return guess * scale;
+    }
+
+    template <typename FloatingPoint>
+    inline FloatingPoint sqrt(FloatingPoint x)
+    {
+      if (x == 0 || x == std::numeric_limits<FloatingPoint>::infinity()) return x;
+      if (!(x > 0)) throw err::sqrt_domain_error;
+      return root<FloatingPoint, 2>(x);
+    }
+    template <typename FloatingPoint>
+    inline FloatingPoint cbrt(FloatingPoint x)
+    {
+      if (x == 0 || x != x || x == std::numeric_limits<FloatingPoint>::infinity()
+          || x == -std::numeric_limits<FloatingPoint>::infinity())
+      {
+        return x;
+      }
+      return x < 0 ? -root<FloatingPoint, 3>(-x) : root<FloatingPoint, 3>(x);
     }
   }
   template <typename FloatingPoint>
@@ -329,8 +456,10 @@ namespace cx
       FloatingPoint x,
       typename std::enable_if<std::is_floating_point<FloatingPoint>::value>::type* = nullptr)
   {
-    return x == 0 ? 0 :
-      x > 0 ? detail::sqrt(x, x) :
+    return !CX_CONSTANT_EVALUATED() ?
+      CX_RUNTIME_DISPATCH(runtime::sqrt(x), err::sqrt_domain_error) :
+      x == 0 || x == std::numeric_limits<FloatingPoint>::infinity() ? x :
+      x > 0 ? detail::root<FloatingPoint, 2>(x) :
       throw err::sqrt_domain_error;
   }
   template <typename Integral>
@@ -341,31 +470,24 @@ namespace cx
     return sqrt<double>(x);
   }
 
-  //----------------------------------------------------------------------------
-  // cube root by Newton-Raphson method
-  namespace detail
-  {
-    template <typename T>
-    constexpr T cbrt(T x, T guess)
-    {
-      return feq(guess, (T{2}*guess + x/(guess*guess))/T{3}) ? guess :
-        cbrt(x, (T{2}*guess + x/(guess*guess))/T{3});
-    }
-  }
   template <typename FloatingPoint>
   constexpr FloatingPoint cbrt(
       FloatingPoint x,
       typename std::enable_if<std::is_floating_point<FloatingPoint>::value>::type* = nullptr)
   {
-    return true ? detail::cbrt(x, FloatingPoint{1}) :
-      throw err::cbrt_runtime_error;
+    return !CX_CONSTANT_EVALUATED() ?
+      CX_RUNTIME_DISPATCH(runtime::cbrt(x), err::cbrt_runtime_error) :
+      x == 0 || x != x || x == std::numeric_limits<FloatingPoint>::infinity()
+        || x == -std::numeric_limits<FloatingPoint>::infinity() ? x :
+      x < 0 ? -detail::root<FloatingPoint, 3>(-x) :
+      detail::root<FloatingPoint, 3>(x);
   }
   template <typename Integral>
   constexpr double cbrt(
       Integral x,
       typename std::enable_if<std::is_integral<Integral>::value>::type* = nullptr)
   {
-    return detail::cbrt<double>(x, 1.0);
+    return cbrt<double>(x);
   }
 
   //----------------------------------------------------------------------------
@@ -416,54 +538,399 @@ namespace cx
   }
 
   //----------------------------------------------------------------------------
-  // exp by Taylor series expansion
+  // exp, sin and cos: range reduction, then a fixed-degree polynomial
+  //
+  // The argument is first reduced by Cody and Waite's method: subtract the
+  // nearest multiple k of ln2 (for exp) or pi/2 (for sin and cos), with the
+  // constant split into parts short enough that their products with k are
+  // exact. The reduced argument r is small (|r| <= ln2/2, or pi/4), and there a
+  // Taylor polynomial of fixed degree (chosen for the precision of the type) is
+  // accurate to about an ulp. So each evaluation is a bounded number of
+  // operations, and constexpr evaluation steps, whatever the argument. float
+  // is computed in double.
+  //
+  // sin and cos reduce exactly only while |k| <= 2^26, i.e. for |x| below
+  // 2^26 pi/2 (about 1e8): past that, k pi/2 is no longer computed exactly,
+  // and the result soon has no correct digits. So larger arguments (and
+  // infinities and NaN) are domain errors.
   namespace detail
   {
-    template <typename T>
-    constexpr T exp(T x, T sum, T n, int i, T t)
+    namespace poly
     {
-      return feq(sum, sum + t/n) ?
-        sum :
-        exp(x, sum + t/n, n * i, i+1, t * x);
+      // 1/n!, and (-1)^(n/2)/n! for the alternating series of sin and cos
+      constexpr long double inv_fact[] = {
+        1.0000000000000000000000000000000000000000e+0l,
+        1.0000000000000000000000000000000000000000e+0l,
+        5.0000000000000000000000000000000000000000e-1l,
+        1.6666666666666666666666666666666666666667e-1l,
+        4.1666666666666666666666666666666666666667e-2l,
+        8.3333333333333333333333333333333333333333e-3l,
+        1.3888888888888888888888888888888888888889e-3l,
+        1.9841269841269841269841269841269841269841e-4l,
+        2.4801587301587301587301587301587301587302e-5l,
+        2.7557319223985890652557319223985890652557e-6l,
+        2.7557319223985890652557319223985890652557e-7l,
+        2.5052108385441718775052108385441718775052e-8l,
+        2.0876756987868098979210090321201432312543e-9l,
+        1.6059043836821614599392377170154947932726e-10l,
+        1.1470745597729724713851697978682105666233e-11l,
+        7.6471637318198164759011319857880704441551e-13l,
+        4.7794773323873852974382074911175440275969e-14l,
+        2.8114572543455207631989455830103200162335e-15l,
+        1.5619206968586226462216364350057333423519e-16l,
+        8.2206352466243297169559812368722807492207e-18l,
+        4.1103176233121648584779906184361403746104e-19l,
+        1.9572941063391261230847574373505430355287e-20l,
+        8.8967913924505732867488974425024683433125e-22l,
+        3.8681701706306840377169119315228123231793e-23l,
+        1.6117375710961183490487133048011718013247e-24l,
+        6.4469502843844733961948532192046872052989e-26l,
+        2.4795962632247974600749435458479566174227e-27l,
+        9.1836898637955461484257168364739133978617e-29l,
+        3.2798892370698379101520417273121119278077e-30l,
+        1.1309962886447716931558764576938316992441e-31l,
+      };
+      constexpr long double alt_inv_fact[] = {
+        1.0000000000000000000000000000000000000000e+0l,
+        1.0000000000000000000000000000000000000000e+0l,
+        -5.0000000000000000000000000000000000000000e-1l,
+        -1.6666666666666666666666666666666666666667e-1l,
+        4.1666666666666666666666666666666666666667e-2l,
+        8.3333333333333333333333333333333333333333e-3l,
+        -1.3888888888888888888888888888888888888889e-3l,
+        -1.9841269841269841269841269841269841269841e-4l,
+        2.4801587301587301587301587301587301587302e-5l,
+        2.7557319223985890652557319223985890652557e-6l,
+        -2.7557319223985890652557319223985890652557e-7l,
+        -2.5052108385441718775052108385441718775052e-8l,
+        2.0876756987868098979210090321201432312543e-9l,
+        1.6059043836821614599392377170154947932726e-10l,
+        -1.1470745597729724713851697978682105666233e-11l,
+        -7.6471637318198164759011319857880704441551e-13l,
+        4.7794773323873852974382074911175440275969e-14l,
+        2.8114572543455207631989455830103200162335e-15l,
+        -1.5619206968586226462216364350057333423519e-16l,
+        -8.2206352466243297169559812368722807492207e-18l,
+        4.1103176233121648584779906184361403746104e-19l,
+        1.9572941063391261230847574373505430355287e-20l,
+        -8.8967913924505732867488974425024683433125e-22l,
+        -3.8681701706306840377169119315228123231793e-23l,
+        1.6117375710961183490487133048011718013247e-24l,
+        6.4469502843844733961948532192046872052989e-26l,
+        -2.4795962632247974600749435458479566174227e-27l,
+        -9.1836898637955461484257168364739133978617e-29l,
+        3.2798892370698379101520417273121119278077e-30l,
+        1.1309962886447716931558764576938316992441e-31l,
+      };
+
+      // ln2 in four parts, and pi/2 in five: all but the last have 32 (ln2)
+      // or 27 (pi/2) significant bits, so their products with k are exact for
+      // |k| < 2^21 or 2^26
+      constexpr double ln2_1 = 0.6931471806019545;
+      constexpr double ln2_2 = -4.200915072890502e-11;
+      constexpr double ln2_3 = 2.094174429075368e-21;
+      constexpr double ln2_4 = 1.94704509238075e-31;
+      constexpr double inv_ln2 = 1.4426950408889634;
+
+      constexpr double pio2_1 = 1.570796325802803;
+      constexpr double pio2_2 = 9.920935739593517e-10;
+      constexpr double pio2_3 = 5.721188709663575e-18;
+      constexpr double pio2_4 = 1.6446256892965207e-26;
+      constexpr double pio2_5 = 4.3359050650618903e-35;
+      constexpr double two_over_pi = 0.6366197723675814;
+
+      // 2^26 pi/2: below this, |k| <= 2^26 and the products k pio2_n are exact
+      constexpr double max_trig = 105414357.85197645;
+
+      // the type to compute in
+      template <typename T>
+      using wide_t = typename std::conditional<
+        std::is_same<T, float>::value, double, T>::type;
+
+      // the highest Taylor term needed for the precision of T: double, x87
+      // extended or quad
+      template <typename T>
+      constexpr int last_term(int d53, int d64, int d113)
+      {
+        return std::numeric_limits<T>::digits <= 53 ? d53 :
+          std::numeric_limits<T>::digits <= 64 ? d64 : d113;
+      }
+
+      // Horner's rule, c_j + x*(c_j+step + x*(... + x*c_last)), unrolled at
+      // compile time, where c_j is 1/j! or, if Alternating, (-1)^(j/2)/j!
+      template <typename T, bool Alternating, int J, int Last, int Step>
+      struct horner
+      {
+        static constexpr T eval(T x)
+        {
+          return static_cast<T>(Alternating ? alt_inv_fact[J] : inv_fact[J])
+            + x * horner<T, Alternating, J+Step, Last, Step>::eval(x);
+        }
+      };
+      template <typename T, bool Alternating, int Last, int Step>
+      struct horner<T, Alternating, Last, Last, Step>
+      {
+        static constexpr T eval(T)
+        {
+          return static_cast<T>(Alternating ? alt_inv_fact[Last] : inv_fact[Last]);
+        }
+      };
+
+      // the nearest integer to x, for |x| < 2^62
+      template <typename T>
+      constexpr long long nearest(T x)
+      {
+        return static_cast<long long>(x < T{0} ? x - T{0.5} : x + T{0.5});
+      }
+
+      // 2^n for n >= 0, 62 bits at a time
+      template <typename T>
+      constexpr T pow2(long long n)
+      {
+        return n < 63 ? static_cast<T>(1ll << n) :
+          static_cast<T>(1ll << 62) * pow2<T>(n - 62);
+      }
+      // x * 2^n (exact, unless the result is subnormal), in two steps when 2^n
+      // itself isn't a normal number (when the result is near overflow, or
+      // subnormal)
+      template <typename T>
+      constexpr T scale2(T x, long long n)
+      {
+        return n < 0 ? x / pow2<T>(-n) : x * pow2<T>(n);
+      }
+      template <typename T>
+      constexpr T scale(T x, long long n)
+      {
+        return n >= std::numeric_limits<T>::min_exponent - 1
+          && n < std::numeric_limits<T>::max_exponent ?
+          scale2(x, n) : scale2(scale2(x, n/2), n - n/2);
+      }
+
+      // The reduced argument x - k c, as an unevaluated sum hi + lo. With the
+      // constant split as c1 + c2 + tail, x - k c1 and k c2 are exact; their
+      // difference is split into its rounded value and the rounding error
+      // (Knuth's TwoSum), the tail is taken from the error, and hi + lo is
+      // renormalized (Dekker's Fast2Sum).
+      template <typename T>
+      struct reduced
+      {
+        T hi;
+        T lo;
+      };
+      template <typename T>
+      constexpr reduced<T> fast_two_sum(T hi, T lo, T sum)
+      {
+        return reduced<T>{ sum, lo - (sum - hi) };
+      }
+      template <typename T>
+      constexpr reduced<T> reduce(T a, T b, T tail, T hi, T bv)
+      {
+        return fast_two_sum(hi, ((a - (hi - bv)) - (b + bv)) - tail,
+                            hi + (((a - (hi - bv)) - (b + bv)) - tail));
+      }
+      template <typename T>
+      constexpr reduced<T> reduce(T a, T b, T tail)
+      {
+        return reduce(a, b, tail, a - b, (a - b) - a);
+      }
+
+      // past these, e^x overflows or underflows to 0
+      template <typename T>
+      constexpr T exp_max()
+      {
+        return static_cast<T>(std::numeric_limits<T>::max_exponent) * T{ln2_1};
+      }
+      template <typename T>
+      constexpr T exp_min()
+      {
+        return static_cast<T>(std::numeric_limits<T>::min_exponent
+                              - std::numeric_limits<T>::digits - 1) * T{ln2_1};
+      }
+      template <typename T>
+      constexpr reduced<T> exp_reduce(T x, T k)
+      {
+        return reduce(x - k*T{ln2_1}, k*T{ln2_2}, k*T{ln2_3} + k*T{ln2_4});
+      }
+      template <typename T>
+      constexpr reduced<T> exp_reduce(T x, long long k)
+      {
+        return exp_reduce(x, static_cast<T>(k));
+      }
+
+      // e^(r + lo) for |r| <= ln2/2 and lo below an ulp of r, to first order
+      // in lo
+      template <typename T>
+      constexpr T exp_poly(T r, T lo)
+      {
+        return T{1} + (r + (r*r * horner<T, false, 2, last_term<T>(13, 15, 24), 1>::eval(r)
+                            + lo*(T{1} + r)));
+      }
+      template <typename T>
+      constexpr T exp_poly(reduced<T> r)
+      {
+        return exp_poly(r.hi, r.lo);
+      }
+
+      // e^x = 2^k e^(x - k ln2)
+      template <typename T>
+      constexpr T exp_k(T x, long long k)
+      {
+        return scale(exp_poly(exp_reduce(x, k)), k);
+      }
+      template <typename T>
+      constexpr T exp_wide(T x)
+      {
+        return x != x ? x :
+          x > exp_max<T>() ? std::numeric_limits<T>::infinity() :
+          x < exp_min<T>() ? T{0} :
+          exp_k(x, nearest(x * T{inv_ln2}));
+      }
+      template <typename T>
+      constexpr T exp(T x)
+      {
+        return static_cast<T>(exp_wide(static_cast<wide_t<T>>(x)));
+      }
+
+      template <typename T>
+      constexpr reduced<T> trig_reduce(T x, T k)
+      {
+        return reduce(x - k*T{pio2_1}, k*T{pio2_2}, (k*T{pio2_3} + k*T{pio2_4}) + k*T{pio2_5});
+      }
+      template <typename T>
+      constexpr reduced<T> trig_reduce(T x, long long k)
+      {
+        return trig_reduce(x, static_cast<T>(k));
+      }
+
+      // sin(r + lo) and cos(r + lo) for |r| <= pi/4 and lo below an ulp of r,
+      // to first order in lo
+      template <typename T>
+      constexpr T sin_poly(T r, T lo)
+      {
+        return r + (r*(r*r) * horner<T, true, 3, last_term<T>(17, 19, 29), 2>::eval(r*r)
+                    + lo*(T{1} - T{0.5}*(r*r)));
+      }
+      // with w = 1 - r^2/2, cos r = w + ((1 - w) - r^2/2) + r^4/4! - ..., where
+      // (1 - w) - r^2/2 recovers the rounding error of w
+      template <typename T>
+      constexpr T cos_poly(T r, T lo, T z, T w)
+      {
+        return w + (((T{1} - w) - T{0.5}*z)
+                    + (z*z * horner<T, true, 4, last_term<T>(16, 18, 28), 2>::eval(z) - r*lo));
+      }
+      template <typename T>
+      constexpr T cos_poly(T r, T lo)
+      {
+        return cos_poly(r, lo, r*r, T{1} - T{0.5}*(r*r));
+      }
+      // sin(q pi/2 + r)
+      template <typename T>
+      constexpr T sin_quadrant(reduced<T> r, int q)
+      {
+        return q == 0 ? sin_poly(r.hi, r.lo) :
+          q == 1 ? cos_poly(r.hi, r.lo) :
+          q == 2 ? -sin_poly(r.hi, r.lo) :
+          -cos_poly(r.hi, r.lo);
+      }
+      // sin(x + shift pi/2), where x = k pi/2 + r
+      template <typename T>
+      constexpr T sin_k(T x, long long k, int shift)
+      {
+        return sin_quadrant(trig_reduce(x, k), static_cast<int>((k + shift) & 3));
+      }
+      template <typename T>
+      constexpr bool reducible(T x)
+      {
+        return static_cast<wide_t<T>>(x) > -max_trig && static_cast<wide_t<T>>(x) < max_trig;
+      }
+      template <typename T>
+      constexpr T sin(T x)
+      {
+        return reducible(x) ?
+          static_cast<T>(sin_k(static_cast<wide_t<T>>(x),
+                               nearest(static_cast<wide_t<T>>(x) * wide_t<T>{two_over_pi}), 0)) :
+          throw err::sin_domain_error;
+      }
+      template <typename T>
+      constexpr T cos(T x)
+      {
+        return reducible(x) ?
+          static_cast<T>(sin_k(static_cast<wide_t<T>>(x),
+                               nearest(static_cast<wide_t<T>>(x) * wide_t<T>{two_over_pi}), 1)) :
+          throw err::cos_domain_error;
+      }
     }
   }
+  namespace runtime
+  {
+    // the same reductions and polynomials (which recurse only to a fixed
+    // depth), without evaluating anything twice
+    template <typename FloatingPoint>
+    inline FloatingPoint exp(FloatingPoint x)
+    {
+      namespace poly = detail::poly;
+      using T = poly::wide_t<FloatingPoint>;
+      const T w = static_cast<T>(x);
+      if (w != w) return x;
+      if (w > poly::exp_max<T>()) return std::numeric_limits<FloatingPoint>::infinity();
+      if (w < poly::exp_min<T>()) return FloatingPoint{0};
+      return static_cast<FloatingPoint>(poly::exp_k(w, poly::nearest(w * T{poly::inv_ln2})));
+    }
+
+    template <typename FloatingPoint>
+    inline FloatingPoint sin_shifted(FloatingPoint x, int shift)
+    {
+      namespace poly = detail::poly;
+      using T = poly::wide_t<FloatingPoint>;
+      const long long k = poly::nearest(static_cast<T>(x) * T{poly::two_over_pi});
+      const poly::reduced<T> r = poly::trig_reduce(static_cast<T>(x), k);
+      switch ((k + shift) & 3)
+      {
+        case 0: return static_cast<FloatingPoint>(poly::sin_poly(r.hi, r.lo));
+        case 1: return static_cast<FloatingPoint>(poly::cos_poly(r.hi, r.lo));
+        case 2: return static_cast<FloatingPoint>(-poly::sin_poly(r.hi, r.lo));
+        default: return static_cast<FloatingPoint>(-poly::cos_poly(r.hi, r.lo));
+      }
+    }
+    template <typename FloatingPoint>
+    inline FloatingPoint sin(FloatingPoint x)
+    {
+      if (!detail::poly::reducible(x)) throw err::sin_domain_error;
+      return sin_shifted(x, 0);
+    }
+    template <typename FloatingPoint>
+    inline FloatingPoint cos(FloatingPoint x)
+    {
+      if (!detail::poly::reducible(x)) throw err::cos_domain_error;
+      return sin_shifted(x, 1);
+    }
+  }
+
   template <typename FloatingPoint>
   constexpr FloatingPoint exp(
       FloatingPoint x,
       typename std::enable_if<std::is_floating_point<FloatingPoint>::value>::type* = nullptr)
   {
-    return true ? detail::exp(x, FloatingPoint{1}, FloatingPoint{1}, 2, x) :
-      throw err::exp_runtime_error;
+    return CX_CONSTANT_EVALUATED() ?
+      detail::poly::exp(x) :
+      CX_RUNTIME_DISPATCH(runtime::exp(x), err::exp_runtime_error);
   }
   template <typename Integral>
   constexpr double exp(
       Integral x,
       typename std::enable_if<std::is_integral<Integral>::value>::type* = nullptr)
   {
-    return detail::exp<double>(x, 1.0, 1.0, 2, x);
+    return exp<double>(x);
   }
 
-  //----------------------------------------------------------------------------
-  // sin by Taylor series expansion
-  // The body of trig_series is basically the same for sin and cos.
-  namespace detail
-  {
-    template <typename T>
-    constexpr T trig_series(T x, T sum, T n, int i, int s, T t)
-    {
-      return feq(sum, sum + t*s/n) ?
-        sum :
-        trig_series(x, sum + t*s/n, n*i*(i+1), i+2, -s, t*x*x);
-    }
-  }
   template <typename FloatingPoint>
   constexpr FloatingPoint sin(
       FloatingPoint x,
       typename std::enable_if<std::is_floating_point<FloatingPoint>::value>::type* = nullptr)
   {
-    return true ?
-      detail::trig_series(x, x, FloatingPoint{6}, 4, -1, x*x*x) :
-      throw err::sin_runtime_error;
+    return CX_CONSTANT_EVALUATED() ?
+      detail::poly::sin(x) :
+      CX_RUNTIME_DISPATCH(runtime::sin(x), err::sin_runtime_error);
   }
   template <typename Integral>
   constexpr double sin(
@@ -473,27 +940,21 @@ namespace cx
     return sin<double>(x);
   }
 
-  //----------------------------------------------------------------------------
-  // cos by Taylor series expansion
-  // Note that this function uses the same basic form as the sin expansion, so
-  // trig_series with different inputs does the job.
   template <typename FloatingPoint>
   constexpr FloatingPoint cos(
       FloatingPoint x,
       typename std::enable_if<std::is_floating_point<FloatingPoint>::value>::type* = nullptr)
   {
-    return true ?
-      detail::trig_series(x, FloatingPoint{1}, FloatingPoint{2}, 3, -1, x*x) :
-      throw err::cos_runtime_error;
+    return CX_CONSTANT_EVALUATED() ?
+      detail::poly::cos(x) :
+      CX_RUNTIME_DISPATCH(runtime::cos(x), err::cos_runtime_error);
   }
   template <typename Integral>
   constexpr double cos(
       Integral x,
       typename std::enable_if<std::is_integral<Integral>::value>::type* = nullptr)
   {
-    return detail::trig_series<double>(
-        x, 1.0, 2.0, 3, -1,
-        static_cast<double>(x)*static_cast<double>(x));
+    return cos<double>(x);
   }
 
   //----------------------------------------------------------------------------
@@ -521,8 +982,17 @@ namespace cx
 
   //----------------------------------------------------------------------------
   // arctan by Euler's series
+  //
+  // The series converges only slowly as |x| grows, so |x| > 1 is reduced by
+  // atan(x) = +-pi/2 - atan(1/x); on [-1, 1] each term is at most half the
+  // previous one, and the term cap only guarantees termination.
   namespace detail
   {
+    template <typename T>
+    constexpr int atan_max_terms()
+    {
+      return 2 * std::numeric_limits<T>::digits;
+    }
     template <typename T>
     constexpr T atan_term(T x2, int k)
     {
@@ -538,23 +1008,64 @@ namespace cx
     template <typename T>
     constexpr T atan_sum(T x, T sum, int n)
     {
-      return sum + atan_product(x, n) == sum ?
+      return n > atan_max_terms<T>() || sum + atan_product(x, n) == sum ?
         sum :
         atan_sum(x, sum + atan_product(x, n), n+1);
     }
+    template <typename T>
+    constexpr T atan_series(T x)
+    {
+      return x / (T{1} + x*x) * atan_sum(x, T{1}, 1);
+    }
     constexpr long double pi()
     {
       return 3.1415926535897932385l;
     }
+    template <typename T>
+    constexpr T atan(T x)
+    {
+      return x != x ? x :
+        x > 1 ? static_cast<T>(pi()/2.0l) - atan_series(T{1}/x) :
+        x < -1 ? -static_cast<T>(pi()/2.0l) - atan_series(T{1}/x) :
+        atan_series(x);
+    }
+  }
+  namespace runtime
+  {
+    // each product of terms is the previous product times the next term, so
+    // keep the running product instead of recomputing it
+    template <typename FloatingPoint>
+    inline FloatingPoint atan_series(FloatingPoint x)
+    {
+      using T = FloatingPoint;
+      T sum{1};
+      int n = 1;
+      T product = detail::atan_term(x*x, n);
+      while (n <= detail::atan_max_terms<T>() && sum + product != sum)
+      {
+        sum = sum + product;
+        ++n;
+        product = detail::atan_term(x*x, n) * product;
+      }
+      return x / (T{1} + x*x) * sum;
+    }
+    template <typename FloatingPoint>
+    inline FloatingPoint atan(FloatingPoint x)
+    {
+      using T = FloatingPoint;
+      if (x != x) return x;
+      if (x > 1) return static_cast<T>(detail::pi()/2.0l) - atan_series(T{1}/x);
+      if (x < -1) return -static_cast<T>(detail::pi()/2.0l) - atan_series(T{1}/x);
+      return atan_series(x);
+    }
   }
   template <typename FloatingPoint>
   constexpr FloatingPoint atan(
       FloatingPoint x,
       typename std::enable_if<std::is_floating_point<FloatingPoint>::value>::type* = nullptr)
   {
-    return true ?
-      x / (FloatingPoint{1} + x*x) * detail::atan_sum(x, FloatingPoint{1}, 1) :
-      throw err::atan_runtime_error;
+    return CX_CONSTANT_EVALUATED() ? detail::atan(x) :
+      CX_RUNTIME_DISPATCH(runtime::atan(x), err::atan_runtime_error);
   }
   template <typename Integral>
   constexpr double atan(
@@ -602,12 +1113,33 @@ namespace cx
                     t*x*x*static_cast<T>(n)/(n+3));
     }
   }
+  namespace runtime
+  {
+    template <typename FloatingPoint>
+    inline FloatingPoint asin(FloatingPoint x)
+    {
+      using T = FloatingPoint;
+      if (x == T{-1}) return detail::pi()/T{-2};
+      if (x == T{1}) return detail::pi()/T{2};
+      if (!(x > T{-1} && x < T{1})) throw err::asin_domain_error;
+      T sum = x;
+      T t = x*x*x/T{2};
+      for (int n = 1; !detail::feq(sum, sum + t*static_cast<T>(n)/(n+2)); n += 2)
+      {
+        sum = sum + t*static_cast<T>(n)/(n+2);
+        t = t*x*x*static_cast<T>(n)/(n+3);
+      }
+      return sum;
+    }
+  }
   template <typename FloatingPoint>
   constexpr FloatingPoint asin(
       FloatingPoint x,
       typename std::enable_if<std::is_floating_point<FloatingPoint>::value>::type* = nullptr)
   {
-    return x == FloatingPoint{-1} ? detail::pi()/FloatingPoint{-2} :
+    return !CX_CONSTANT_EVALUATED() ?
+      CX_RUNTIME_DISPATCH(runtime::asin(x), err::asin_domain_error) :
+      x == FloatingPoint{-1} ? detail::pi()/FloatingPoint{-2} :
     x == FloatingPoint{1} ? detail::pi()/FloatingPoint{2} :
     x > FloatingPoint{-1} && x < FloatingPoint{1} ?
       detail::asin_series(x, x, 1, x*x*x/FloatingPoint{2}) :
@@ -651,8 +1183,16 @@ namespace cx
   // For long double, max_exponent = 16384, so we need n = 2^33. Oops. Looks
   // like floor/ceil for long double can only exist for C++14 where we are not
   // limited to recursion.
+  // Zero (of either sign), and anything too large to have a fractional part
+  // (including infinity), is its own floor and ceil; the searches below can't
+  // step in increments smaller than an ulp, so they must not see it.
   namespace detail
   {
+    template <typename T>
+    constexpr bool integral_value(T x)
+    {
+      return x == T{0} || x >= ipow(T{2}, std::numeric_limits<T>::digits - 1);
+    }
     template <typename T>
     constexpr T floor2(T x, T guess, T inc)
     {
@@ -696,6 +1236,23 @@ namespace cx
         ceil(x, guess, dec/T{8});
     }
   }
+  namespace runtime
+  {
+    // floor and ceil are exact, so the standard library's agree with the
+    // searches wherever those terminate
+    template <typename T>
+    inline T floor(T x)
+    {
+      if (x != x) throw err::floor_runtime_error;
+      return std::floor(x);
+    }
+    template <typename T>
+    inline T ceil(T x)
+    {
+      if (x != x) throw err::ceil_runtime_error;
+      return std::ceil(x);
+    }
+  }
 
   constexpr float ceil(float x);
   constexpr double ceil(double x);
@@ -706,7 +1263,10 @@ namespace cx
 
   constexpr float floor(float x)
   {
-    return x < 0 ? -ceil(-x) :
+    return !CX_CONSTANT_EVALUATED() ?
+      CX_RUNTIME_DISPATCH(runtime::floor(x), err::floor_runtime_error) :
+      x < 0 ? -ceil(-x) :
+      detail::integral_value(x) ? x :
       x >= 0 ? detail::floor(
           x, 0.0f,
           detail::ipow(2.0f, std::numeric_limits<float>::max_exponent-1)) :
@@ -714,7 +1274,10 @@ namespace cx
   }
   constexpr double floor(double x)
   {
-    return x < 0 ? -ceil(-x) :
+    return !CX_CONSTANT_EVALUATED() ?
+      CX_RUNTIME_DISPATCH(runtime::floor(x), err::floor_runtime_error) :
+      x < 0 ? -ceil(-x) :
+      detail::integral_value(x) ? x :
       x >= 0 ? detail::floor(
           x, 0.0,
           detail::ipow(2.0, std::numeric_limits<double>::max_exponent-1)) :
@@ -731,7 +1294,10 @@ namespace cx
 
   constexpr float ceil(float x)
   {
-    return x < 0 ? -floor(-x) :
+    return !CX_CONSTANT_EVALUATED() ?
+      CX_RUNTIME_DISPATCH(runtime::ceil(x), err::ceil_runtime_error) :
+      x < 0 ? -floor(-x) :
+      detail::integral_value(x) ? x :
       x >= 0 ? detail::ceil(
           x, detail::ipow(2.0f, std::numeric_limits<float>::max_exponent-1),
           detail::ipow(2.0f, std::numeric_limits<float>::max_exponent-1)) :
@@ -739,7 +1305,10 @@ namespace cx
   }
   constexpr double ceil(double x)
   {
-    return x < 0 ? -floor(-x) :
+    return !CX_CONSTANT_EVALUATED() ?
+      CX_RUNTIME_DISPATCH(runtime::ceil(x), err::ceil_runtime_error) :
+      x < 0 ? -floor(-x) :
+      detail::integral_value(x) ? x :
       x >= 0 ? detail::ceil(
           x, detail::ipow(2.0, std::numeric_limits<double>::max_exponent-1),
           detail::ipow(2.0, std::numeric_limits<double>::max_exponent-1)) :
@@ -756,40 +1325,57 @@ namespace cx
 
   // See above: long double floor/ceil only available for C++14 constexpr
   #if __cplusplus == 201402L
-  constexpr long double ceil(long double x);
-  constexpr long double floor(long double x)
+  namespace detail
   {
-    if (x < 0.0) return -ceil(-x);
-    long double inc = detail::ipow(2.0l, std::numeric_limits<long double>::max_exponent - 1);
-    long double guess = 0.0l;
-    for (;;)
+    constexpr long double floor(long double x)
     {
-      while (guess + inc > x)
+      long double inc = ipow(2.0l, std::numeric_limits<long double>::max_exponent - 1);
+      long double guess = 0.0l;
+      for (;;)
       {
-        inc /= 2.0l;
-        if (inc < 1.0l)
-          return guess;
+        while (guess + inc > x)
+        {
+          inc /= 2.0l;
+          if (inc < 1.0l)
+            return guess;
+        }
+        guess += inc;
       }
-      guess += inc;
     }
-    throw err::floor_runtime_error;
-  }
-  constexpr long double ceil(long double x)
-  {
-    if (x < 0.0l) return -floor(-x);
-    long double dec = detail::ipow(2.0l, std::numeric_limits<long double>::max_exponent - 1);
-    long double guess = dec;
-    for (;;)
+    constexpr long double ceil(long double x)
     {
-      while (guess - dec < x)
+      long double dec = ipow(2.0l, std::numeric_limits<long double>::max_exponent - 1);
+      long double guess = dec;
+      for (;;)
       {
-        dec /= 2.0l;
-        if (dec < 1.0l)
-          return guess;
+        while (guess - dec < x)
+        {
+          dec /= 2.0l;
+          if (dec < 1.0l)
+            return guess;
+        }
+        guess -= dec;
       }
-      guess -= dec;
     }
-    throw err::ceil_runtime_error;
+  }
+  constexpr long double ceil(long double x);
+  constexpr long double floor(long double x)
+  {
+    return !CX_CONSTANT_EVALUATED() ?
+      CX_RUNTIME_DISPATCH(runtime::floor(x), err::floor_runtime_error) :
+      x < 0 ? -ceil(-x) :
+      detail::integral_value(x) ? x :
+      x >= 0 ? detail::floor(x) :
+      throw err::floor_runtime_error;
+  }
+  constexpr long double ceil(long double x)
+  {
+    return !CX_CONSTANT_EVALUATED() ?
+      CX_RUNTIME_DISPATCH(runtime::ceil(x), err::ceil_runtime_error) :
+      x < 0 ? -floor(-x) :
+      detail::integral_value(x) ? x :
+      x >= 0 ? detail::ceil(x) :
+      throw err::ceil_runtime_error;
   }
   #endif
 
@@ -996,18 +1582,27 @@ namespace cx
   //----------------------------------------------------------------------------
   // natural logarithm using
   // https://en.wikipedia.org/wiki/Natural_logarithm#High_precision
-  // domain error occurs if x <= 0
+  // domain error occurs if x <= 0 (or is NaN)
   namespace detail
   {
+
     template <typename T>
     constexpr T log_iter(T x, T y)
     {
       return y + T{2} * (x - cx::exp(y)) / (x + cx::exp(y));
     }
+    // Near the root, rounding can leave the iteration alternating between
+    // neighbouring values, so for |y| > 1 the tolerance is relative.
     template <typename T>
-    constexpr T log(T x, T y)
+    constexpr bool log_converged(T y, T next)
     {
-      return feq(y, log_iter(x, y)) ? y : log(x, log_iter(x, y));
+      return abs(y - next) <= std::numeric_limits<T>::epsilon() * (abs(y) > T{1} ? abs(y) : T{1});
+    }
+    template <typename T>
+    constexpr T log(T x, T y, int n = max_iterations)
+    {
+      return n == 0 || log_converged(y, log_iter(x, y)) ? y :
+        log(x, log_iter(x, y), n - 1);
     }
     constexpr long double e()
     {
@@ -1034,12 +1629,56 @@ namespace cx
         logLT<T>(x / (e() * e() * e() * e() * e())) + T{5};
     }
   }
+  namespace runtime
+  {
+    template <typename T>
+    inline T log(T x, T y)
+    {
+      for (int n = detail::max_iterations; n > 0; --n)
+      {
+        const T ey = exp(y);
+        const T next = y + T{2} * (x - ey) / (x + ey);
+        if (detail::log_converged(y, next)) return y;
+        y = next;
+      }
+      return y;
+    }
+    template <typename FloatingPoint>
+    inline FloatingPoint log(FloatingPoint x)
+    {
+      using T = FloatingPoint;
+      using detail::e;
+      if (!(x > 0)) throw err::log_domain_error;
+      if (x == std::numeric_limits<T>::infinity()) return x;
+      int n = 0;
+      if (x >= T{1024})
+      {
+        for (; !(x < T{1024}); ++n)
+        {
+          x = static_cast<T>(x / (e() * e() * e() * e() * e()));
+        }
+        T r = log(x, T{0});
+        for (; n > 0; --n) r = r + T{5};
+        return r;
+      }
+      for (; !(x > T{0.25}); ++n)
+      {
+        x = static_cast<T>(x * e() * e() * e() * e() * e());
+      }
+      T r = log(x, T{0});
+      for (; n > 0; --n) r = r - T{5};
+      return r;
+    }
+  }
   template <typename FloatingPoint>
   constexpr FloatingPoint log(
       FloatingPoint x,
       typename std::enable_if<std::is_floating_point<FloatingPoint>::value>::type* = nullptr)
   {
-    return x < 0 ? throw err::log_domain_error :
+    return !CX_CONSTANT_EVALUATED() ?
+      CX_RUNTIME_DISPATCH(runtime::log(x), err::log_domain_error) :
+      !(x > 0) ? throw err::log_domain_error :
+      x == std::numeric_limits<FloatingPoint>::infinity() ? x :
       x >= FloatingPoint{1024} ? detail::logLT(x) :
       detail::logGT(x);
   }
@@ -1202,8 +1841,8 @@ namespace cx
       FloatingPoint x, int y,
       typename std::enable_if<std::is_floating_point<FloatingPoint>::value>::type* = nullptr)
   {
-    return true ? detail::ipow(x, y) :
-      throw err::pow_runtime_error;
+    return CX_CONSTANT_EVALUATED() ? detail::ipow(x, y) :
+      CX_RUNTIME_DISPATCH(runtime::ipow(x, y), err::pow_runtime_error);
   }
 
   // pow for general arithmetic types
@@ -1223,12 +1862,19 @@ namespace cx
       typename std::enable_if<
         std::is_integral<Integral>::value>::type* = nullptr)
   {
-    return true ? detail::ipow(static_cast<double>(x), y) :
-      throw err::pow_runtime_error;
+    return CX_CONSTANT_EVALUATED() ? detail::ipow(static_cast<double>(x), y) :
+      CX_RUNTIME_DISPATCH(runtime::ipow(static_cast<double>(x), y),
+                          err::pow_runtime_error);
   }
 
   //----------------------------------------------------------------------------
   // erf: the error function
+  //
+  // The Maclaurin series alternates with terms up to about e^(x^2), so it
+  // loses all precision as |x| grows; from |x| = 2 erf is 1 - erfc instead,
+  // with erfc from its continued fraction (evaluated from a fixed depth, which
+  // is enough from there on), and past the point where erfc is below half an
+  // ulp of 1, erf is +-1.
   namespace detail
   {
     constexpr long double two_over_root_pi()
@@ -1236,6 +1882,29 @@ namespace cx
       return 1.128379167095512573896l;
     }
 
+    template <typename T>
+    constexpr bool erf_saturates(T x)
+    {
+      return x*x > static_cast<T>(std::numeric_limits<T>::digits)
+        * static_cast<T>(0.69314718055994530942l);
+    }
+
+    constexpr int erfc_terms = 100;
+    // x + (1/2)/(x + 1/(x + (3/2)/(x + ...)))
+    template <typename T>
+    constexpr T erfc_cf(T x, T f, int k)
+    {
+      return k == 0 ? f :
+        erfc_cf(x, x + static_cast<T>(k)/T{2}/f, k-1);
+    }
+    // erf(x) for x >= 2
+    template <typename T>
+    constexpr T erf_tail(T x)
+    {
+      return T{1} - cx::exp(-x*x) * static_cast<T>(two_over_root_pi()/2.0l)
+        / erfc_cf(x, x, erfc_terms);
+    }
+
     template <typename T>
     constexpr T erf(T x, T sum, T n, int i, int s, T t)
     {
@@ -1244,14 +1913,54 @@ namespace cx
         erf(x, sum + (t*s/n)/(2*i+1), n*(i+1), i+1, -s, t*x*x);
     }
   }
+  namespace runtime
+  {
+    template <typename FloatingPoint>
+    inline FloatingPoint erf_tail(FloatingPoint x)
+    {
+      using T = FloatingPoint;
+      T f = x;
+      for (int k = detail::erfc_terms; k > 0; --k)
+      {
+        f = x + static_cast<T>(k)/T{2}/f;
+      }
+      return T{1} - cx::exp(-x*x) * static_cast<T>(detail::two_over_root_pi()/2.0l) / f;
+    }
+
+    template <typename FloatingPoint>
+    inline FloatingPoint erf(FloatingPoint x)
+    {
+      using T = FloatingPoint;
+      if (x != x) return x;
+      if (detail::erf_saturates(x)) return x > 0 ? T{1} : T{-1};
+      if (x >= 2) return erf_tail(x);
+      if (x <= -2) return -erf_tail(-x);
+      T sum = x;
+      T n{1};
+      int s = -1;
+      T t = x*x*x;
+      for (int i = 1; !detail::feq(sum, sum + (t*s/n)/(2*i+1)); ++i)
+      {
+        sum = sum + (t*s/n)/(2*i+1);
+        n = n*(i+1);
+        s = -s;
+        t = t*x*x;
+      }
+      return sum * detail::two_over_root_pi();
+    }
+  }
   template <typename FloatingPoint>
   constexpr FloatingPoint erf(
       FloatingPoint x,
       typename std::enable_if<std::is_floating_point<FloatingPoint>::value>::type* = nullptr)
   {
-    return true ? detail::erf(x, x, FloatingPoint{1}, 1, -1, x*x*x)
-      * detail::two_over_root_pi() :
-      throw err::erf_runtime_error;
+    return CX_CONSTANT_EVALUATED() ?
+      x != x ? x :
+      detail::erf_saturates(x) ? (x > 0 ? FloatingPoint{1} : FloatingPoint{-1}) :
+      x >= 2 ? detail::erf_tail(x) :
+      x <= -2 ? -detail::erf_tail(-x) :
+      detail::erf(x, x, FloatingPoint{1}, 1, -1, x*x*x) * detail::two_over_root_pi() :
+      CX_RUNTIME_DISPATCH(runtime::erf(x), err::erf_runtime_error);
   }
   template <typename Integral>
   constexpr double erf(
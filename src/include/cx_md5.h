@@ -1,7 +1,10 @@
 #pragma once
 
 #include "cx_utils.h"
+
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 //----------------------------------------------------------------------------
 // constexpr string hashing: md5
@@ -23,7 +26,7 @@ namespace cx
   {
     namespace
     {
-      extern const char* md5_runtime_error;
+      CX_ERROR_SYMBOL(md5_runtime_error);
     }
   }
 
@@ -144,7 +147,8 @@ namespace cx
 
       // computing leftovers is messy: we need to pad the empty space to a
       // multiple of 64 bytes. the first pad byte is 0x80, the rest are 0.
-      // the original length (in bits) is the last 8 bytes of padding.
+      // the original length (in bits) is the last 8 bytes of padding. (the
+      // original length is 64-bit so that streamed input can exceed 4GB.)
       constexpr uint32_t pad(int len)
       {
         return len == 0 ? 0x00000080 :
@@ -153,16 +157,16 @@ namespace cx
           len == 3 ? 0x80000000 :
           0;
       }
-      constexpr uint32_t origlenbytes(int origlen, int origlenpos)
+      constexpr uint32_t origlenbytes(uint64_t origlen, int origlenpos)
       {
         return origlenpos == 0 ?
-          static_cast<uint64_t>(origlen)*8 & 0xffffffff :
+          static_cast<uint32_t>(origlen*8 & 0xffffffff) :
           origlenpos == -4 ?
-          (static_cast<uint64_t>(origlen) >> 29) :
+          static_cast<uint32_t>(origlen >> 29) :
           0;
       }
       constexpr schedule leftover(const char* buf,
-                                  int len, int origlen, int origlenpos)
+                                  int len, uint64_t origlen, int origlenpos)
       {
         return { { word32le(buf, len) | pad(len) | origlenbytes(origlen, origlenpos),
               word32le(len >= 4 ? buf+4 : buf, len-4)
@@ -283,7 +287,7 @@ namespace cx
       //    fit the 8 bytes of length after padding
       // 3. otherwise we have a block that will fit both padding and the length
       constexpr md5sum md5update(const md5sum& sum, const char* msg,
-                                  int len, int origlen)
+                                  int len, uint64_t origlen)
       {
         return
           len >= 64 ?
@@ -294,7 +298,7 @@ namespace cx
       }
       constexpr md5sum md5withlen(const char* msg, int len)
       {
-        return md5update(init(), msg, len, len);
+        return md5update(init(), msg, len, static_cast<uint64_t>(len));
       }
       constexpr md5sum md5(const char* msg)
       {
@@ -302,9 +306,100 @@ namespace cx
       }
     }
   }
+
+  // runtime version (see cx_runtime.h): the same schedules and round steps, but
+  // iterating over the steps and blocks rather than recursing
+  namespace runtime
+  {
+    // the complete transform, for a schedule block: each step computes a new
+    // value for a, then the state rotates right (as in round1..round4)
+    inline void md5transform(md5sum& sum, const detail::md5::schedule& s)
+    {
+      using namespace detail::md5;
+      uint32_t a = sum.h[0];
+      uint32_t b = sum.h[1];
+      uint32_t c = sum.h[2];
+      uint32_t d = sum.h[3];
+      for (int i = 0; i < 16; ++i)
+      {
+        const uint32_t t = FF(a, b, c, d, s.w[i], r1shift[i&3], r1const[i]);
+        a = d; d = c; c = b; b = t;
+      }
+      for (int i = 0; i < 16; ++i)
+      {
+        const uint32_t t = GG(a, b, c, d, s.w[(1+i*5)%16], r2shift[i&3], r2const[i]);
+        a = d; d = c; c = b; b = t;
+      }
+      for (int i = 0; i < 16; ++i)
+      {
+        const uint32_t t = HH(a, b, c, d, s.w[(5+i*3)%16], r3shift[i&3], r3const[i]);
+        a = d; d = c; c = b; b = t;
+      }
+      for (int i = 0; i < 16; ++i)
+      {
+        const uint32_t t = II(a, b, c, d, s.w[(i*7)%16], r4shift[i&3], r4const[i]);
+        a = d; d = c; c = b; b = t;
+      }
+      sum.h[0] += a;
+      sum.h[1] += b;
+      sum.h[2] += c;
+      sum.h[3] += d;
+    }
+
+    // transform nblocks consecutive 64-byte blocks of a message
+    inline void md5blocks(md5sum& sum, const char* data, size_t nblocks)
+    {
+      for (; nblocks > 0; --nblocks, data += 64)
+      {
+        md5transform(sum, detail::md5::init(data));
+      }
+    }
+
+    // the last two conditions of md5update: the final (less than 64-byte)
+    // piece of the message, padded and followed by the length
+    inline md5sum md5final(md5sum sum, const char* msg, int len, uint64_t origlen)
+    {
+      if (len >= 56)
+      {
+        md5transform(sum, detail::md5::leftover(msg, len, origlen, 64));
+        md5transform(sum, detail::md5::leftover(msg+len, -1, origlen, 56));
+      }
+      else
+      {
+        md5transform(sum, detail::md5::leftover(msg, len, origlen, 56));
+      }
+      return sum;
+    }
+
+    inline md5sum md5(const char* s, size_t len)
+    {
+      md5sum sum = detail::md5::init();
+      md5blocks(sum, s, len / 64);
+      return md5final(sum, s + (len & ~size_t{63}), static_cast<int>(len & 63), len);
+    }
+
+    inline md5sum md5(const char* s)
+    {
+      return md5(s, static_cast<size_t>(strlen(s)));
+    }
+  }
+
   constexpr md5sum md5(const char* s)
   {
-    return true ? detail::md5::md5(s) :
-      throw err::md5_runtime_error;
+    return CX_CONSTANT_EVALUATED() ? detail::md5::md5(s) :
+      CX_RUNTIME_DISPATCH(runtime::md5(s), err::md5_runtime_error);
   }
+
+  // md5 of a buffer that may contain NUL bytes
+  constexpr md5sum md5(const char* s, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::md5::md5withlen(s, static_cast<int>(len)) :
+      CX_RUNTIME_DISPATCH(runtime::md5(s, len), err::md5_runtime_error);
+  }
+
+  // Incremental md5 for runtime use (see sha256_ctx). The result is identical
+  // to cx::md5 on the concatenated input.
+  using md5_ctx = runtime::block_buffer<
+    md5sum, detail::md5::init, runtime::md5blocks, runtime::md5final>;
 }
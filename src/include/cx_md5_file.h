@@ -0,0 +1,33 @@
+#pragma once
+
+#include "cx_file.h"
+#include "cx_md5.h"
+#include "cx_parallel.h"
+
+#include <cstddef>
+
+//----------------------------------------------------------------------------
+// md5 of files (runtime only)
+
+namespace cx
+{
+  // md5 of the contents of a file. The file is memory-mapped and its blocks
+  // are transformed directly from the mapping. Throws std::system_error if
+  // the file can't be read.
+  inline md5sum md5_file(const char* path)
+  {
+    const runtime::mapped_file f(path);
+    return runtime::md5(f.data(), f.size());
+  }
+
+  // md5 of n files at once, writing the digest of paths[i] to out[i]. The
+  // files are shared out among nthreads threads (0 means one per hardware
+  // thread). If any file can't be read, the first error is rethrown after
+  // the other threads have stopped.
+  inline void md5_files(const char* const* paths, size_t n, md5sum* out,
+                        unsigned nthreads = 0)
+  {
+    runtime::parallel_for(n, [&] (size_t i) { out[i] = md5_file(paths[i]); },
+                          nthreads);
+  }
+}
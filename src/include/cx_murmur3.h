@@ -2,10 +2,11 @@
 
 #include "cx_utils.h"
 
+#include <cstddef>
 #include <cstdint>
 
 //----------------------------------------------------------------------------
-// constexpr string hashing: murmur3_32
+// constexpr string hashing: murmur3_32, murmur3_x64_128, murmur3_x86_128
 
 namespace cx
 {
@@ -13,10 +14,24 @@ namespace cx
   {
     namespace
     {
-      extern const char* murmur3_32_runtime_error;
+      CX_ERROR_SYMBOL(murmur3_32_runtime_error);
+      CX_ERROR_SYMBOL(murmur3_x64_128_runtime_error);
+      CX_ERROR_SYMBOL(murmur3_x86_128_runtime_error);
     }
   }
 
+  // Results of the 128-bit variants, as the reference implementation leaves
+  // them: h1 and h2 for x64 (16 bytes per round), h1..h4 for x86 (4 lanes of
+  // 4 bytes per round). The two variants produce different hashes.
+  struct murmur3_128sum
+  {
+    uint64_t h[2];
+  };
+  struct murmur3_x86_128sum
+  {
+    uint32_t h[4];
+  };
+
   namespace detail
   {
     namespace murmur
@@ -31,7 +46,7 @@ namespace cx
         return (((hash^k) << 13) | ((hash^k) >> 19)) * 5 + 0xe6546b64;
       }
 
-      constexpr uint32_t murmur3_32_loop(const char* key, int len, uint32_t hash)
+      constexpr uint32_t murmur3_32_loop(const char* key, size_t len, uint32_t hash)
       {
         return len == 0 ? hash :
           murmur3_32_loop(
@@ -49,18 +64,18 @@ namespace cx
       constexpr uint32_t murmur3_32_end1(uint32_t k, const char* key)
       {
         return murmur3_32_end0(
-            k ^ static_cast<uint32_t>(key[0]));
+            k ^ byte32(key[0]));
       }
 
       constexpr uint32_t murmur3_32_end2(uint32_t k, const char* key)
       {
         return murmur3_32_end1(
-            k ^ (static_cast<uint32_t>(key[1]) << 8), key);
+            k ^ (byte32(key[1]) << 8), key);
       }
       constexpr uint32_t murmur3_32_end3(uint32_t k, const char* key)
       {
         return murmur3_32_end2(
-            k ^ (static_cast<uint32_t>(key[2]) << 16), key);
+            k ^ (byte32(key[2]) << 16), key);
       }
 
       constexpr uint32_t murmur3_32_end(uint32_t hash,
@@ -85,7 +100,7 @@ namespace cx
         return (hash ^ (hash >> 16));
       }
 
-      constexpr uint32_t murmur3_32_final(uint32_t hash, int len)
+      constexpr uint32_t murmur3_32_final(uint32_t hash, size_t len)
       {
         return
           murmur3_32_final3(
@@ -93,22 +108,357 @@ namespace cx
                   murmur3_32_final1(hash ^ static_cast<uint32_t>(len))));
       }
 
-      constexpr uint32_t murmur3_32_value(const char* key, int len,
+      constexpr uint32_t murmur3_32_value(const char* key, size_t len,
                                           uint32_t seed)
       {
         return murmur3_32_final(
             murmur3_32_end(
                 murmur3_32_loop(key, len/4, seed),
-                key+(len/4)*4, len&3),
+                key+(len/4)*4, static_cast<int>(len&3)),
             len);
       }
+
+      constexpr uint32_t rotl32(uint32_t x, int r)
+      {
+        return (x << r) | (x >> (32 - r));
+      }
+      constexpr uint64_t rotl64(uint64_t x, int r)
+      {
+        return (x << r) | (x >> (64 - r));
+      }
+
+      // the 32-bit and 64-bit finalization mixes
+      constexpr uint32_t fmix32(uint32_t h)
+      {
+        return murmur3_32_final3(murmur3_32_final2(murmur3_32_final1(h)));
+      }
+      constexpr uint64_t xorshift33(uint64_t k)
+      {
+        return k ^ (k >> 33);
+      }
+      constexpr uint64_t fmix64(uint64_t k)
+      {
+        return xorshift33(xorshift33(xorshift33(k) * 0xff51afd7ed558ccdull)
+                          * 0xc4ceb9fe1a85ec53ull);
+      }
+
+      //------------------------------------------------------------------------
+      // x64_128: each round mixes two 64-bit words into h1 and h2 in turn
+      constexpr uint64_t x64_c1 = 0x87c37b91114253d5ull;
+      constexpr uint64_t x64_c2 = 0x4cf5ad432745937full;
+
+      constexpr uint64_t x64_128_k1(uint64_t k)
+      {
+        return rotl64(k * x64_c1, 31) * x64_c2;
+      }
+      constexpr uint64_t x64_128_k2(uint64_t k)
+      {
+        return rotl64(k * x64_c2, 33) * x64_c1;
+      }
+      constexpr murmur3_128sum x64_128_round2(const murmur3_128sum& s, uint64_t k2)
+      {
+        return { { s.h[0],
+              (rotl64(s.h[1] ^ x64_128_k2(k2), 31) + s.h[0]) * 5 + 0x38495ab5 } };
+      }
+      constexpr murmur3_128sum x64_128_round1(const murmur3_128sum& s, uint64_t k1)
+      {
+        return { { (rotl64(s.h[0] ^ x64_128_k1(k1), 27) + s.h[1]) * 5 + 0x52dce729,
+              s.h[1] } };
+      }
+      constexpr murmur3_128sum x64_128_round(const murmur3_128sum& s, const char* block)
+      {
+        return x64_128_round2(x64_128_round1(s, word64le(block)), word64le(block+8));
+      }
+      constexpr murmur3_128sum x64_128_loop(const char* key, size_t nblocks,
+                                            const murmur3_128sum& s)
+      {
+        return nblocks == 0 ? s :
+          x64_128_loop(key + 16, nblocks - 1, x64_128_round(s, key));
+      }
+      // the tail bytes are mixed in as (partial) little-endian words
+      constexpr murmur3_128sum x64_128_tail(const murmur3_128sum& s,
+                                            const char* tail, int rem)
+      {
+        return { { rem > 0 ? s.h[0] ^ x64_128_k1(word64le(tail, rem)) : s.h[0],
+              rem > 8 ? s.h[1] ^ x64_128_k2(word64le(tail+8, rem-8)) : s.h[1] } };
+      }
+      // h1 += h2; h2 += h1
+      constexpr murmur3_128sum x64_128_mix(const murmur3_128sum& s)
+      {
+        return { { s.h[0] + s.h[1], s.h[0] + s.h[1] + s.h[1] } };
+      }
+      constexpr murmur3_128sum x64_128_fmix(const murmur3_128sum& s)
+      {
+        return { { fmix64(s.h[0]), fmix64(s.h[1]) } };
+      }
+      constexpr murmur3_128sum x64_128_final(const murmur3_128sum& s, uint64_t len)
+      {
+        return x64_128_mix(x64_128_fmix(x64_128_mix({ { s.h[0] ^ len, s.h[1] ^ len } })));
+      }
+      constexpr murmur3_128sum x64_128_value(const char* key, size_t len, uint32_t seed)
+      {
+        return x64_128_final(
+            x64_128_tail(x64_128_loop(key, len/16, { { seed, seed } }),
+                         key + (len/16)*16, static_cast<int>(len & 15)),
+            len);
+      }
+
+      //------------------------------------------------------------------------
+      // x86_128: each round mixes four 32-bit words into h1..h4 in turn
+      constexpr uint32_t x86_c1 = 0x239b961b;
+      constexpr uint32_t x86_c2 = 0xab0e9789;
+      constexpr uint32_t x86_c3 = 0x38b34ae5;
+      constexpr uint32_t x86_c4 = 0xa1e38b93;
+
+      constexpr uint32_t x86_128_k1(uint32_t k)
+      {
+        return rotl32(k * x86_c1, 15) * x86_c2;
+      }
+      constexpr uint32_t x86_128_k2(uint32_t k)
+      {
+        return rotl32(k * x86_c2, 16) * x86_c3;
+      }
+      constexpr uint32_t x86_128_k3(uint32_t k)
+      {
+        return rotl32(k * x86_c3, 17) * x86_c4;
+      }
+      constexpr uint32_t x86_128_k4(uint32_t k)
+      {
+        return rotl32(k * x86_c4, 18) * x86_c1;
+      }
+      constexpr murmur3_x86_128sum x86_128_round1(const murmur3_x86_128sum& s, uint32_t k)
+      {
+        return { { (rotl32(s.h[0] ^ x86_128_k1(k), 19) + s.h[1]) * 5 + 0x561ccd1b,
+              s.h[1], s.h[2], s.h[3] } };
+      }
+      constexpr murmur3_x86_128sum x86_128_round2(const murmur3_x86_128sum& s, uint32_t k)
+      {
+        return { { s.h[0],
+              (rotl32(s.h[1] ^ x86_128_k2(k), 17) + s.h[2]) * 5 + 0x0bcaa747,
+              s.h[2], s.h[3] } };
+      }
+      constexpr murmur3_x86_128sum x86_128_round3(const murmur3_x86_128sum& s, uint32_t k)
+      {
+        return { { s.h[0], s.h[1],
+              (rotl32(s.h[2] ^ x86_128_k3(k), 15) + s.h[3]) * 5 + 0x96cd1c35,
+              s.h[3] } };
+      }
+      constexpr murmur3_x86_128sum x86_128_round4(const murmur3_x86_128sum& s, uint32_t k)
+      {
+        return { { s.h[0], s.h[1], s.h[2],
+              (rotl32(s.h[3] ^ x86_128_k4(k), 13) + s.h[0]) * 5 + 0x32ac3b17 } };
+      }
+      constexpr murmur3_x86_128sum x86_128_round(const murmur3_x86_128sum& s,
+                                                 const char* block)
+      {
+        return x86_128_round4(
+            x86_128_round3(
+                x86_128_round2(
+                    x86_128_round1(s, word32le(block)),
+                    word32le(block+4)),
+                word32le(block+8)),
+            word32le(block+12));
+      }
+      constexpr murmur3_x86_128sum x86_128_loop(const char* key, size_t nblocks,
+                                                const murmur3_x86_128sum& s)
+      {
+        return nblocks == 0 ? s :
+          x86_128_loop(key + 16, nblocks - 1, x86_128_round(s, key));
+      }
+      constexpr murmur3_x86_128sum x86_128_tail(const murmur3_x86_128sum& s,
+                                                const char* tail, int rem)
+      {
+        return { { rem > 0 ? s.h[0] ^ x86_128_k1(word32le(tail, rem)) : s.h[0],
+              rem > 4 ? s.h[1] ^ x86_128_k2(word32le(tail+4, rem-4)) : s.h[1],
+              rem > 8 ? s.h[2] ^ x86_128_k3(word32le(tail+8, rem-8)) : s.h[2],
+              rem > 12 ? s.h[3] ^ x86_128_k4(word32le(tail+12, rem-12)) : s.h[3] } };
+      }
+      // h1 += h2 + h3 + h4; then h2, h3, h4 += h1
+      constexpr murmur3_x86_128sum x86_128_mix(uint32_t h1, const murmur3_x86_128sum& s)
+      {
+        return { { h1, s.h[1] + h1, s.h[2] + h1, s.h[3] + h1 } };
+      }
+      constexpr murmur3_x86_128sum x86_128_mix(const murmur3_x86_128sum& s)
+      {
+        return x86_128_mix(s.h[0] + s.h[1] + s.h[2] + s.h[3], s);
+      }
+      constexpr murmur3_x86_128sum x86_128_fmix(const murmur3_x86_128sum& s)
+      {
+        return { { fmix32(s.h[0]), fmix32(s.h[1]), fmix32(s.h[2]), fmix32(s.h[3]) } };
+      }
+      constexpr murmur3_x86_128sum x86_128_final(const murmur3_x86_128sum& s, uint32_t len)
+      {
+        return x86_128_mix(x86_128_fmix(x86_128_mix(
+                    { { s.h[0] ^ len, s.h[1] ^ len, s.h[2] ^ len, s.h[3] ^ len } })));
+      }
+      constexpr murmur3_x86_128sum x86_128_value(const char* key, size_t len,
+                                                 uint32_t seed)
+      {
+        return x86_128_final(
+            x86_128_tail(x86_128_loop(key, len/16, { { seed, seed, seed, seed } }),
+                         key + (len/16)*16, static_cast<int>(len & 15)),
+            static_cast<uint32_t>(len));
+      }
+    }
+  }
+
+  // runtime version (see cx_runtime.h): the same block, tail and finalization
+  // functions, with the per-block recursion replaced by a loop
+  namespace runtime
+  {
+    // the block loop, unrolled by 4 (the rounds are a dependency chain, so
+    // this saves only loop overhead; see murmur3_32_many for more overlap)
+    inline uint32_t murmur3_32_blocks(const char* key, size_t nblocks, uint32_t hash)
+    {
+      using namespace detail::murmur;
+      for (; nblocks >= 4; nblocks -= 4, key += 16)
+      {
+        hash = murmur3_32_hashround(murmur3_32_k(load32le(key)), hash);
+        hash = murmur3_32_hashround(murmur3_32_k(load32le(key+4)), hash);
+        hash = murmur3_32_hashround(murmur3_32_k(load32le(key+8)), hash);
+        hash = murmur3_32_hashround(murmur3_32_k(load32le(key+12)), hash);
+      }
+      for (; nblocks > 0; --nblocks, key += 4)
+      {
+        hash = murmur3_32_hashround(murmur3_32_k(load32le(key)), hash);
+      }
+      return hash;
+    }
+
+    inline uint32_t murmur3_32(const char* key, size_t len, uint32_t seed)
+    {
+      return detail::murmur::murmur3_32_final(
+          detail::murmur::murmur3_32_end(
+              murmur3_32_blocks(key, len/4, seed),
+              key + (len & ~size_t{3}), static_cast<int>(len&3)),
+          len);
+    }
+
+    inline uint32_t murmur3_32(const char *key, uint32_t seed)
+    {
+      return murmur3_32(key, static_cast<size_t>(strlen(key)), seed);
+    }
+
+    inline murmur3_128sum murmur3_x64_128(const char* key, size_t len, uint32_t seed)
+    {
+      using namespace detail::murmur;
+      const char* const end = key + (len & ~size_t{15});
+      murmur3_128sum s = { { seed, seed } };
+      for (; key != end; key += 16)
+      {
+        s = x64_128_round(s, key);
+      }
+      return x64_128_final(x64_128_tail(s, key, static_cast<int>(len & 15)), len);
+    }
+
+    inline murmur3_x86_128sum murmur3_x86_128(const char* key, size_t len, uint32_t seed)
+    {
+      using namespace detail::murmur;
+      const char* const end = key + (len & ~size_t{15});
+      murmur3_x86_128sum s = { { seed, seed, seed, seed } };
+      for (; key != end; key += 16)
+      {
+        s = x86_128_round(s, key);
+      }
+      return x86_128_final(x86_128_tail(s, key, static_cast<int>(len & 15)),
+                           static_cast<uint32_t>(len));
     }
   }
 
   constexpr uint32_t murmur3_32(const char *key, uint32_t seed)
   {
-    return true ?
-      detail::murmur::murmur3_32_value(key, strlen(key), seed) :
-      throw err::murmur3_32_runtime_error;
+    return CX_CONSTANT_EVALUATED() ?
+      detail::murmur::murmur3_32_value(key, static_cast<size_t>(strlen(key)), seed) :
+      CX_RUNTIME_DISPATCH(runtime::murmur3_32(key, seed),
+                          err::murmur3_32_runtime_error);
+  }
+
+  // murmur3_32 of a buffer that may contain NULs (constexpr for char arrays)
+  constexpr uint32_t murmur3_32(const char* key, size_t len, uint32_t seed)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::murmur::murmur3_32_value(key, len, seed) :
+      CX_RUNTIME_DISPATCH(runtime::murmur3_32(key, len, seed),
+                          err::murmur3_32_runtime_error);
+  }
+  // and of any other binary key (runtime only)
+  inline uint32_t murmur3_32(const void* key, size_t len, uint32_t seed)
+  {
+    return runtime::murmur3_32(static_cast<const char*>(key), len, seed);
+  }
+
+  // Hash n keys with the same seed, writing the hash of keys[i] to out[i]
+  // (runtime only). Keys are taken four at a time and their rounds are
+  // interleaved, so that the four independent dependency chains overlap.
+  inline void murmur3_32_many(const byte_view* keys, size_t n, uint32_t seed,
+                              uint32_t* out)
+  {
+    using namespace detail::murmur;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+      const byte_view* k = keys + i;
+      const char* p0 = k[0].data;
+      const char* p1 = k[1].data;
+      const char* p2 = k[2].data;
+      const char* p3 = k[3].data;
+      uint32_t h0 = seed, h1 = seed, h2 = seed, h3 = seed;
+
+      // the blocks that all four keys have
+      size_t common = k[0].size;
+      for (size_t j = 1; j < 4; ++j)
+      {
+        if (k[j].size < common) common = k[j].size;
+      }
+      for (size_t b = common / 4; b > 0; --b, p0 += 4, p1 += 4, p2 += 4, p3 += 4)
+      {
+        h0 = murmur3_32_hashround(murmur3_32_k(runtime::load32le(p0)), h0);
+        h1 = murmur3_32_hashround(murmur3_32_k(runtime::load32le(p1)), h1);
+        h2 = murmur3_32_hashround(murmur3_32_k(runtime::load32le(p2)), h2);
+        h3 = murmur3_32_hashround(murmur3_32_k(runtime::load32le(p3)), h3);
+      }
+
+      // then each key's own remaining blocks and tail
+      const char* const p[4] = { p0, p1, p2, p3 };
+      const uint32_t h[4] = { h0, h1, h2, h3 };
+      for (size_t j = 0; j < 4; ++j)
+      {
+        const size_t len = k[j].size;
+        const size_t rest = len/4 - common/4;
+        out[i+j] = murmur3_32_final(
+            murmur3_32_end(runtime::murmur3_32_blocks(p[j], rest, h[j]),
+                           p[j] + rest*4, static_cast<int>(len&3)),
+            len);
+      }
+    }
+    for (; i < n; ++i)
+    {
+      out[i] = runtime::murmur3_32(keys[i].data, keys[i].size, seed);
+    }
+  }
+
+  // the 128-bit variants, of a string or of a buffer that may contain NULs
+  constexpr murmur3_128sum murmur3_x64_128(const char* key, size_t len, uint32_t seed)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::murmur::x64_128_value(key, len, seed) :
+      CX_RUNTIME_DISPATCH(runtime::murmur3_x64_128(key, len, seed),
+                          err::murmur3_x64_128_runtime_error);
+  }
+  constexpr murmur3_128sum murmur3_x64_128(const char* key, uint32_t seed)
+  {
+    return murmur3_x64_128(key, static_cast<size_t>(strlen(key)), seed);
+  }
+
+  constexpr murmur3_x86_128sum murmur3_x86_128(const char* key, size_t len, uint32_t seed)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::murmur::x86_128_value(key, len, seed) :
+      CX_RUNTIME_DISPATCH(runtime::murmur3_x86_128(key, len, seed),
+                          err::murmur3_x86_128_runtime_error);
+  }
+  constexpr murmur3_x86_128sum murmur3_x86_128(const char* key, uint32_t seed)
+  {
+    return murmur3_x86_128(key, static_cast<size_t>(strlen(key)), seed);
   }
 }
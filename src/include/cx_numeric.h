@@ -1,5 +1,7 @@
 #pragma once
 
+#include "cx_runtime.h"
+
 #include <cstddef>
 #include <utility>
 
@@ -12,8 +14,55 @@ namespace cx
   {
     namespace
     {
-      extern const char* accumulate_runtime_error;
-      extern const char* inner_product_runtime_error;
+      CX_ERROR_SYMBOL(accumulate_runtime_error);
+      CX_ERROR_SYMBOL(inner_product_runtime_error);
+    }
+  }
+
+  // runtime versions (see cx_runtime.h): the same operations in the same order
+  // as the constexpr versions
+  namespace runtime
+  {
+    template <typename It, typename T>
+    inline T accumulate(It first, It last, T init)
+    {
+      for (; first != last; ++first)
+      {
+        init = init + *first;
+      }
+      return init;
+    }
+
+    template <typename It, typename T, typename BinaryOp>
+    inline T accumulate(It first, It last, T init, BinaryOp op)
+    {
+      for (; first != last; ++first)
+      {
+        init = op(init, *first);
+      }
+      return init;
+    }
+
+    template <typename It1, typename It2, typename T>
+    inline T inner_product(It1 first1, It1 last1, It2 first2, T value)
+    {
+      for (; first1 != last1; ++first1, ++first2)
+      {
+        value = value + *first1 * *first2;
+      }
+      return value;
+    }
+
+    template <typename It1, typename It2, typename T,
+              typename BinaryOp1, typename BinaryOp2>
+    inline T inner_product(It1 first1, It1 last1, It2 first2, T value,
+                           BinaryOp1 op1, BinaryOp2 op2)
+    {
+      for (; first1 != last1; ++first1, ++first2)
+      {
+        value = op1(value, op2(*first1, *first2));
+      }
+      return value;
     }
   }
 
@@ -21,30 +70,33 @@ namespace cx
   template <typename It, typename T>
   constexpr T accumulate(It first, It last, T init)
   {
-    return true ?
+    return CX_CONSTANT_EVALUATED() ?
       first == last ? init :
       accumulate(first + 1, last, init + *first) :
-      throw err::accumulate_runtime_error;
+      CX_RUNTIME_DISPATCH(runtime::accumulate(first, last, init),
+                          err::accumulate_runtime_error);
   }
 
   template <typename It, typename T, typename BinaryOp>
   constexpr T accumulate(It first, It last, T init, BinaryOp op)
   {
-    return true ?
+    return CX_CONSTANT_EVALUATED() ?
       first == last ? init :
       accumulate(first + 1, last, op(init, *first), op) :
-      throw err::accumulate_runtime_error;
+      CX_RUNTIME_DISPATCH(runtime::accumulate(first, last, init, op),
+                          err::accumulate_runtime_error);
   }
 
   // inner_product
   template <typename It1, typename It2, typename T>
   constexpr T inner_product(It1 first1, It1 last1, It2 first2, T value)
   {
-    return true ?
+    return CX_CONSTANT_EVALUATED() ?
       first1 == last1 ? value :
       inner_product(first1 + 1, last1, first2 + 1,
                     value + *first1 * *first2) :
-      throw err::inner_product_runtime_error;
+      CX_RUNTIME_DISPATCH(runtime::inner_product(first1, last1, first2, value),
+                          err::inner_product_runtime_error);
   }
 
   template <typename It1, typename It2, typename T,
@@ -57,6 +109,8 @@ namespace cx
       inner_product(first1 + 1, last1, first2 + 1,
                     op1(value, op2(*first1, *first2)),
                     op1, op2) :
-      throw err::inner_product_runtime_error;
+      CX_RUNTIME_DISPATCH(runtime::inner_product(first1, last1, first2, value,
+                                                 op1, op2),
+                          err::inner_product_runtime_error);
   }
 }
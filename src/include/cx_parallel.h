@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// a minimal work-sharing pool (runtime only)
+
+namespace cx
+{
+  namespace runtime
+  {
+    // Call f(i) for each i in [0, n) on a pool of nthreads threads (the
+    // calling thread is one of them; 0 means one per hardware thread). Each
+    // thread takes the next index as it finishes the last one, so uneven work
+    // items balance out. If any call throws, no further items are started and
+    // the first exception is rethrown once all threads have finished.
+    template <typename F>
+    void parallel_for(size_t n, F f, unsigned nthreads = 0)
+    {
+      if (nthreads == 0) nthreads = std::thread::hardware_concurrency();
+      if (nthreads == 0) nthreads = 1;
+      if (nthreads > n) nthreads = static_cast<unsigned>(n);
+
+      std::atomic<size_t> next{0};
+      std::exception_ptr error;
+      std::mutex error_mutex;
+
+      const auto work = [&] {
+        for (size_t i = next++; i < n; i = next++)
+        {
+          try
+          {
+            f(i);
+          }
+          catch (...)
+          {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+            next = n;
+          }
+        }
+      };
+
+      std::vector<std::thread> threads;
+      for (unsigned t = 1; t < nthreads; ++t)
+      {
+        threads.emplace_back(work);
+      }
+      work();
+      for (std::thread& t : threads)
+      {
+        t.join();
+      }
+      if (error) std::rethrow_exception(error);
+    }
+  }
+}
@@ -13,7 +13,7 @@ namespace cx
   {
     namespace
     {
-      extern const char* pcg32_runtime_error;
+      CX_ERROR_SYMBOL(pcg32_runtime_error);
     }
   }
 
@@ -0,0 +1,258 @@
+#pragma once
+
+#include "cx_array.h"
+#include "cx_file.h"
+#include "cx_parallel.h"
+#include "cx_pcg32.h"
+#include "cx_sha256.h"
+#include "cx_utils.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// rolling hashing (Buzhash) and content-defined chunking
+//
+// Buzhash maps each byte through a table of random words and combines them
+// with rotations, so the hash of a window of w bytes can be rolled forward a
+// byte at a time: rotate, remove the outgoing byte, add the incoming one.
+//
+//   h(s[0..w)) = rotl(T[s[0]], w-1) ^ rotl(T[s[1]], w-2) ^ ... ^ T[s[w-1]]
+//
+// The table is generated at compile time from pcg32. Its seed is fixed, not
+// per build (unlike cx_guid's): chunk boundaries must not move when the
+// program is rebuilt.
+//
+// The chunker (runtime only) splits data where the hash of the last 48 bytes
+// has its low bits clear, so an insertion or deletion moves only the
+// boundaries near it, and identical content elsewhere still yields identical
+// chunks. Each chunk is fingerprinted with sha256.
+
+namespace cx
+{
+  namespace err
+  {
+    namespace
+    {
+      CX_ERROR_SYMBOL(buzhash_runtime_error);
+    }
+  }
+
+  constexpr uint64_t buzhash_seed = 0x62757a6861736821ull;
+
+  namespace detail
+  {
+    namespace buzhash
+    {
+      template <uint64_t S, size_t ...Is>
+      constexpr array<uint32_t, sizeof...(Is)> table(std::index_sequence<Is...>)
+      {
+        return { pcg::pcg32_output(pcg::pcg32_advance(S, static_cast<int>(Is) + 1))... };
+      }
+    }
+  }
+
+  // entry b is the random word for byte value b
+  template <uint64_t Seed = buzhash_seed>
+  struct buzhash_table
+  {
+    static constexpr array<uint32_t, 256> values =
+      detail::buzhash::table<Seed>(std::make_index_sequence<256>());
+  };
+
+  template <uint64_t Seed>
+  constexpr array<uint32_t, 256> buzhash_table<Seed>::values;
+
+  namespace detail
+  {
+    namespace buzhash
+    {
+      constexpr uint32_t rotl(uint32_t x, size_t n)
+      {
+        return (n & 31) == 0 ? x : (x << (n & 31)) | (x >> (32 - (n & 31)));
+      }
+
+      template <size_t W, size_t ...Is>
+      constexpr array<uint32_t, sizeof...(Is)> outgoing(std::index_sequence<Is...>)
+      {
+        return { rotl(buzhash_table<>::values[Is], W)... };
+      }
+
+      // the table rotated by w: what rolling a window of w bytes removes
+      template <size_t W>
+      struct outgoing_table
+      {
+        static constexpr array<uint32_t, 256> values =
+          outgoing<W>(std::make_index_sequence<256>());
+      };
+
+      template <size_t W>
+      constexpr array<uint32_t, 256> outgoing_table<W>::values;
+    }
+  }
+
+  namespace detail
+  {
+    namespace buzhash
+    {
+      constexpr uint32_t t(char c)
+      {
+        return buzhash_table<>::values[byte32(c)];
+      }
+
+      // as with fnv, recurse in chunks to bound the recursion depth
+      struct state
+      {
+        uint32_t h;
+        const char* s;
+        size_t len;
+      };
+      constexpr state steps(const state& p, int maxdepth)
+      {
+        return p.len == 0 || maxdepth == 0 ? p :
+          steps({ rotl(p.h, 1) ^ t(*p.s), p.s + 1, p.len - 1 }, maxdepth - 1);
+      }
+      constexpr state steps_bychunk(const state& p)
+      {
+        return p.len == 0 ? p : steps_bychunk(steps(p, 256));
+      }
+      constexpr uint32_t buzhash(const char* s, size_t len)
+      {
+        return steps_bychunk({ 0, s, len }).h;
+      }
+    }
+  }
+
+  // runtime versions (see cx_runtime.h)
+  namespace runtime
+  {
+    inline uint32_t buzhash(const char* s, size_t len)
+    {
+      const uint32_t* const t = buzhash_table<>::values.begin();
+      uint32_t h = 0;
+      for (size_t i = 0; i < len; ++i)
+      {
+        h = detail::buzhash::rotl(h, 1) ^ t[byte32(s[i])];
+      }
+      return h;
+    }
+  }
+
+  // the Buzhash of a window of len bytes
+  constexpr uint32_t buzhash(const char* s)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::buzhash::buzhash(s, static_cast<size_t>(strlen(s))) :
+      CX_RUNTIME_DISPATCH(runtime::buzhash(s, static_cast<size_t>(strlen(s))),
+                          err::buzhash_runtime_error);
+  }
+  constexpr uint32_t buzhash(const char* s, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::buzhash::buzhash(s, len) :
+      CX_RUNTIME_DISPATCH(runtime::buzhash(s, len), err::buzhash_runtime_error);
+  }
+
+  // roll the hash h of a window of w bytes forward: out leaves the window and
+  // in enters it
+  constexpr uint32_t buzhash_roll(uint32_t h, size_t w, char out, char in)
+  {
+    return detail::buzhash::rotl(h, 1) ^ detail::buzhash::rotl(detail::buzhash::t(out), w)
+      ^ detail::buzhash::t(in);
+  }
+
+  //----------------------------------------------------------------------------
+  // content-defined chunking (runtime only)
+
+  struct chunk
+  {
+    size_t offset;
+    size_t size;
+    sha256sum digest;
+  };
+
+  class chunker
+  {
+  public:
+    // the rolling hash window
+    static constexpr size_t window = 48;
+
+    // Chunks are at least min_size and at most max_size bytes (except the
+    // last, which may be shorter). Past min_size, each position is a
+    // boundary with probability 1/2^k, where 2^k is avg_size - min_size
+    // rounded down to a power of two, so chunks average about
+    // min_size + 2^k bytes.
+    explicit chunker(size_t min_size = 2048, size_t avg_size = 8192,
+                     size_t max_size = 65536)
+      : m_min(min_size > window ? min_size : size_t{window}),
+        m_max(max_size > m_min ? max_size : m_min),
+        m_mask(mask(avg_size > m_min ? avg_size - m_min : 1))
+    {}
+
+    size_t min_size() const { return m_min; }
+    size_t max_size() const { return m_max; }
+
+    // The size of the chunk at the start of data. Only the bytes from
+    // min_size - window onwards are hashed, and the hash of the window
+    // ending at each position is tested for a boundary. Each step is two
+    // table lookups (the outgoing byte's entry comes pre-rotated), a rotate
+    // and two xors. To chunk a stream, call this with at least max_size bytes
+    // buffered (or all that remain).
+    size_t next(const char* data, size_t size) const
+    {
+      if (size <= m_min) return size;
+      const uint32_t* const t = buzhash_table<>::values.begin();
+      const uint32_t* const u = detail::buzhash::outgoing_table<window>::values.begin();
+      const size_t end = size < m_max ? size : m_max;
+      const uint32_t mask = m_mask;
+      const size_t start = m_min - window;
+      const uint8_t* const p = reinterpret_cast<const uint8_t*>(data);
+
+      uint32_t h = runtime::buzhash(data + start, window);
+      for (size_t i = m_min; i < end; ++i)
+      {
+        if ((h & mask) == 0) return i;
+        h = detail::buzhash::rotl(h, 1) ^ u[p[i - window]] ^ t[p[i]];
+      }
+      return end;
+    }
+
+    // split data into chunks, and fingerprint them concurrently on nthreads
+    // threads (0 means one per hardware thread)
+    std::vector<chunk> split(const char* data, size_t size, unsigned nthreads = 0) const
+    {
+      std::vector<chunk> chunks;
+      for (size_t offset = 0; offset < size; )
+      {
+        const size_t n = next(data + offset, size - offset);
+        chunks.push_back({ offset, n, sha256sum{} });
+        offset += n;
+      }
+      runtime::parallel_for(chunks.size(), [&] (size_t i) {
+          chunks[i].digest = runtime::sha256(data + chunks[i].offset, chunks[i].size);
+        }, nthreads);
+      return chunks;
+    }
+
+    // split a (memory-mapped) file
+    std::vector<chunk> split_file(const char* path, unsigned nthreads = 0) const
+    {
+      const runtime::mapped_file f(path);
+      return split(f.data(), f.size(), nthreads);
+    }
+
+  private:
+    static uint32_t mask(size_t n)
+    {
+      size_t p = 1;
+      while (p <= n / 2) p *= 2;
+      return static_cast<uint32_t>(p - 1);
+    }
+
+    size_t m_min;
+    size_t m_max;
+    uint32_t m_mask;
+  };
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+//----------------------------------------------------------------------------
+// runtime evaluation
+//
+// By default, each function guards itself with a reference to an undefined
+// err:: symbol, so that a call which isn't evaluated at compile time fails to
+// link. Defining CX_RUNTIME (before including any cx header, and consistently
+// across a program) turns this into a supported runtime mode:
+//
+// - the err:: symbols are defined, so domain errors throw a const char*
+// - when not constant-evaluated, each function dispatches to an iterative
+//   implementation in cx::runtime, which performs exactly the same arithmetic
+//   as the constexpr version and therefore produces bit-identical results
+//
+// Detection of constant evaluation uses __builtin_is_constant_evaluated(),
+// which both clang and gcc (9+) provide in C++14 mode.
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CX_UNUSED __attribute__((unused))
+#else
+#define CX_UNUSED
+#endif
+
+#ifdef CX_RUNTIME
+
+#define CX_ERROR_SYMBOL(name) CX_UNUSED const char* name = #name
+#define CX_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#define CX_RUNTIME_DISPATCH(call, error) call
+
+#else
+
+#define CX_ERROR_SYMBOL(name) extern const char* name
+#define CX_CONSTANT_EVALUATED() true
+#define CX_RUNTIME_DISPATCH(call, error) throw error
+
+#endif
@@ -1,9 +1,14 @@
 #pragma once
 
+#include "cx_cpuid.h"
 #include "cx_utils.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
 //----------------------------------------------------------------------------
-// constexpr string hashing: sha-256
+// constexpr string hashing: sha-256 and sha-224
 
 namespace cx
 {
@@ -21,7 +26,8 @@ namespace cx
   {
     namespace
     {
-      extern const char* sha256_runtime_error;
+      CX_ERROR_SYMBOL(sha256_runtime_error);
+      CX_ERROR_SYMBOL(sha224_runtime_error);
     }
   }
 
@@ -30,6 +36,12 @@ namespace cx
     uint32_t h[8];
   };
 
+  // sha-224 is sha-256 from a different initial state, truncated to 7 words
+  struct sha224sum
+  {
+    uint32_t h[7];
+  };
+
   namespace detail
   {
     namespace sha256
@@ -76,6 +88,11 @@ namespace cx
         return { { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
               0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 } };
       }
+      constexpr sha256sum init224()
+      {
+        return { { 0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939,
+              0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4 } };
+      }
       // schedule from an existing buffer
       constexpr schedule init(const char* buf)
       {
@@ -87,7 +104,8 @@ namespace cx
 
       // computing leftovers is messy: we need to pad the empty space to a
       // multiple of 64 bytes. the first pad byte is 0x80, the rest are 0.
-      // the original length (in bits) is the last 8 bytes of padding.
+      // the original length (in bits) is the last 8 bytes of padding. (the
+      // original length is 64-bit so that streamed input can exceed 4GB.)
       constexpr uint32_t pad(int len)
       {
         return len == 3 ? 0x00000080 :
@@ -96,16 +114,16 @@ namespace cx
           len == 0 ? 0x80000000 :
           0;
       }
-      constexpr uint32_t origlenbytes(int origlen, int origlenpos)
+      constexpr uint32_t origlenbytes(uint64_t origlen, int origlenpos)
       {
         return origlenpos == -4 ?
-          static_cast<uint64_t>(origlen)*8 & 0xffffffff :
+          static_cast<uint32_t>(origlen*8 & 0xffffffff) :
           origlenpos == 0 ?
-          (static_cast<uint64_t>(origlen) >> 29) :
+          static_cast<uint32_t>(origlen >> 29) :
           0;
       }
       constexpr schedule leftover(const char* buf,
-                                  int len, int origlen, int origlenpos)
+                                  int len, uint64_t origlen, int origlenpos)
       {
         return { { word32be(buf, len) | pad(len) | origlenbytes(origlen, origlenpos),
               word32be(len >= 4 ? buf+4 : buf, len-4)
@@ -289,7 +307,7 @@ namespace cx
       //    fit the 8 bytes of length after padding
       // 3. otherwise we have a block that will fit both padding and the length
       constexpr sha256sum sha256update(const sha256sum& sum, const char* msg,
-                                     int len, int origlen)
+                                     int len, uint64_t origlen)
       {
         return
           len >= 64 ?
@@ -301,12 +319,16 @@ namespace cx
       }
       constexpr sha256sum sha256withlen(const char* msg, int len)
       {
-        return sha256update(init(), msg, len, len);
+        return sha256update(init(), msg, len, static_cast<uint64_t>(len));
       }
       constexpr sha256sum sha256(const char* msg)
       {
         return sha256withlen(msg, strlen(msg));
       }
+      constexpr sha256sum sha224withlen(const char* msg, int len)
+      {
+        return sha256update(init224(), msg, len, static_cast<uint64_t>(len));
+      }
       // convert a sha256sum to little-endian
       constexpr sha256sum sha256tole(const sha256sum& sum)
       {
@@ -317,11 +339,792 @@ namespace cx
               endianswap(sum.h[6]), endianswap(sum.h[7]),
           } };
       }
+      constexpr sha224sum sha224truncate(const sha256sum& sum)
+      {
+        return { { sum.h[0], sum.h[1], sum.h[2], sum.h[3],
+              sum.h[4], sum.h[5], sum.h[6] } };
+      }
+    }
+  }
+
+  // runtime version (see cx_runtime.h): the same schedules and round
+  // functions, but iterating over the rounds and blocks rather than recursing
+  namespace runtime
+  {
+    // the 64 rounds of the compression function, given the extended schedule
+    // with the round constants already added in (wk[i] = roundconst[i] + w[i])
+    inline void sha256rounds(sha256sum& sum, const uint32_t* wk)
+    {
+      using namespace detail::sha256;
+      // each round computes new values for a and e, then the state rotates
+      // right (as in sha256compress)
+      uint32_t a = sum.h[0];
+      uint32_t b = sum.h[1];
+      uint32_t c = sum.h[2];
+      uint32_t d = sum.h[3];
+      uint32_t e = sum.h[4];
+      uint32_t f = sum.h[5];
+      uint32_t g = sum.h[6];
+      uint32_t h = sum.h[7];
+      for (int i = 0; i < 64; ++i)
+      {
+        const uint32_t t1 = h + S1(e) + ch(e, f, g) + wk[i];
+        const uint32_t t2 = S0(a) + maj(a, b, c);
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+      }
+      sum.h[0] += a;
+      sum.h[1] += b;
+      sum.h[2] += c;
+      sum.h[3] += d;
+      sum.h[4] += e;
+      sum.h[5] += f;
+      sum.h[6] += g;
+      sum.h[7] += h;
+    }
+
+    // the complete transform, for a schedule block (only the first 16 words of
+    // the schedule are used: the extension is done here)
+    inline void sha256transform(sha256sum& sum, const detail::sha256::schedule& s)
+    {
+      using namespace detail::sha256;
+      uint32_t w[64];
+      for (int i = 0; i < 16; ++i)
+      {
+        w[i] = s.w[i];
+      }
+      for (int i = 16; i < 64; ++i)
+      {
+        w[i] = w[i-16] + w[i-7] + s0(w[i-15]) + s1(w[i-2]);
+      }
+      for (int i = 0; i < 64; ++i)
+      {
+        w[i] += roundconst[i];
+      }
+      sha256rounds(sum, w);
+    }
+
+    //--------------------------------------------------------------------------
+    // block functions: transform nblocks consecutive 64-byte blocks of a
+    // message. sha256blocks picks the fastest one for this cpu (see cx_cpuid.h)
+
+    inline void sha256blocks_scalar(sha256sum& sum, const char* data, size_t nblocks)
+    {
+      for (; nblocks > 0; --nblocks, data += 64)
+      {
+        sha256transform(sum, detail::sha256::init(data));
+      }
+    }
+
+#if CX_X86_SIMD
+    namespace detail_sha256
+    {
+      // loads without telling the compiler that char data is aligned
+      __attribute__((target("sse2")))
+      inline __m128i load128(const void* p)
+      {
+        return _mm_loadu_si128(static_cast<const __m128i*>(p));
+      }
+      __attribute__((target("sse2")))
+      inline void store128(void* p, __m128i x)
+      {
+        _mm_storeu_si128(static_cast<__m128i*>(p), x);
+      }
+
+      // byte order shuffle for big-endian words
+      __attribute__((target("ssse3")))
+      inline __m128i bswap32(__m128i x)
+      {
+        return _mm_shuffle_epi8(
+            x, _mm_set_epi64x(0x0c0d0e0f08090a0bll, 0x0405060700010203ll));
+      }
+
+      // four steps of the message schedule: given w[t-16..t-1] in x0..x3,
+      // compute w[t..t+3]. s1 depends on w[t-2] and w[t-1], so the upper two
+      // words need the lower two to be finished first.
+      __attribute__((target("ssse3")))
+      inline __m128i rotr(__m128i x, int n)
+      {
+        return _mm_or_si128(_mm_srli_epi32(x, n), _mm_slli_epi32(x, 32-n));
+      }
+      __attribute__((target("ssse3")))
+      inline __m128i s0(__m128i x)
+      {
+        return _mm_xor_si128(_mm_xor_si128(rotr(x, 7), rotr(x, 18)),
+                             _mm_srli_epi32(x, 3));
+      }
+      __attribute__((target("ssse3")))
+      inline __m128i s1(__m128i x)
+      {
+        return _mm_xor_si128(_mm_xor_si128(rotr(x, 17), rotr(x, 19)),
+                             _mm_srli_epi32(x, 10));
+      }
+      __attribute__((target("ssse3")))
+      inline __m128i extend4(__m128i x0, __m128i x1, __m128i x2, __m128i x3)
+      {
+        __m128i t = _mm_add_epi32(
+            _mm_add_epi32(x0, s0(_mm_alignr_epi8(x1, x0, 4))),
+            _mm_alignr_epi8(x3, x2, 4));
+        t = _mm_add_epi32(t, s1(_mm_srli_si128(x3, 8)));
+        return _mm_add_epi32(t, s1(_mm_slli_si128(t, 8)));
+      }
+
+      // the same for two blocks at once, one in each 128-bit lane
+      __attribute__((target("avx2")))
+      inline __m256i rotr(__m256i x, int n)
+      {
+        return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32-n));
+      }
+      __attribute__((target("avx2")))
+      inline __m256i s0(__m256i x)
+      {
+        return _mm256_xor_si256(_mm256_xor_si256(rotr(x, 7), rotr(x, 18)),
+                                _mm256_srli_epi32(x, 3));
+      }
+      __attribute__((target("avx2")))
+      inline __m256i s1(__m256i x)
+      {
+        return _mm256_xor_si256(_mm256_xor_si256(rotr(x, 17), rotr(x, 19)),
+                                _mm256_srli_epi32(x, 10));
+      }
+      __attribute__((target("avx2")))
+      inline __m256i extend4(__m256i x0, __m256i x1, __m256i x2, __m256i x3)
+      {
+        __m256i t = _mm256_add_epi32(
+            _mm256_add_epi32(x0, s0(_mm256_alignr_epi8(x1, x0, 4))),
+            _mm256_alignr_epi8(x3, x2, 4));
+        t = _mm256_add_epi32(t, s1(_mm256_srli_si256(x3, 8)));
+        return _mm256_add_epi32(t, s1(_mm256_slli_si256(t, 8)));
+      }
+
+      // four rounds with the sha extensions: the state is kept as ABEF/CDGH
+      // and sha256rnds2 does two rounds from the low half of k+w
+      __attribute__((target("sha,sse4.1")))
+      inline void rounds4(__m128i& abef, __m128i& cdgh, __m128i w, int i)
+      {
+        const __m128i wk = _mm_add_epi32(
+            w, load128(&detail::sha256::roundconst[i]));
+        cdgh = _mm_sha256rnds2_epu32(cdgh, abef, wk);
+        abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(wk, 0x0e));
+      }
+      __attribute__((target("sha,sse4.1")))
+      inline __m128i extend4_sha(__m128i x0, __m128i x1, __m128i x2, __m128i x3)
+      {
+        return _mm_sha256msg2_epu32(
+            _mm_add_epi32(_mm_sha256msg1_epu32(x0, x1), _mm_alignr_epi8(x3, x2, 4)),
+            x3);
+      }
+    }
+
+    // ssse3: the message schedule four words at a time, scalar rounds
+    __attribute__((target("ssse3")))
+    inline void sha256blocks_ssse3(sha256sum& sum, const char* data, size_t nblocks)
+    {
+      using namespace detail_sha256;
+      const uint32_t* k = detail::sha256::roundconst;
+      alignas(16) uint32_t wk[64];
+      for (; nblocks > 0; --nblocks, data += 64)
+      {
+        __m128i x0 = bswap32(load128(data));
+        __m128i x1 = bswap32(load128(data + 16));
+        __m128i x2 = bswap32(load128(data + 32));
+        __m128i x3 = bswap32(load128(data + 48));
+        store128(wk, _mm_add_epi32(x0, load128(k)));
+        store128(wk + 4, _mm_add_epi32(x1, load128(k + 4)));
+        store128(wk + 8, _mm_add_epi32(x2, load128(k + 8)));
+        store128(wk + 12, _mm_add_epi32(x3, load128(k + 12)));
+        for (int i = 16; i < 64; i += 4)
+        {
+          const __m128i x = extend4(x0, x1, x2, x3);
+          store128(wk + i, _mm_add_epi32(x, load128(k + i)));
+          x0 = x1; x1 = x2; x2 = x3; x3 = x;
+        }
+        sha256rounds(sum, wk);
+      }
+    }
+
+    // avx2: the message schedules of two blocks at once, scalar rounds
+    __attribute__((target("avx2")))
+    inline void sha256blocks_avx2(sha256sum& sum, const char* data, size_t nblocks)
+    {
+      using namespace detail_sha256;
+      const uint32_t* k = detail::sha256::roundconst;
+      alignas(32) uint32_t wk[2][64];
+      const __m256i swap = _mm256_broadcastsi128_si256(
+          _mm_set_epi64x(0x0c0d0e0f08090a0bll, 0x0405060700010203ll));
+      for (; nblocks >= 2; nblocks -= 2, data += 128)
+      {
+        __m256i x[4];
+        for (int j = 0; j < 4; ++j)
+        {
+          x[j] = _mm256_shuffle_epi8(
+              _mm256_inserti128_si256(
+                  _mm256_castsi128_si256(load128(data + 16*j)),
+                  load128(data + 64 + 16*j), 1),
+              swap);
+        }
+        for (int i = 0; i < 64; i += 4)
+        {
+          if (i >= 16)
+          {
+            const __m256i t = extend4(x[0], x[1], x[2], x[3]);
+            x[0] = x[1]; x[1] = x[2]; x[2] = x[3]; x[3] = t;
+          }
+          const __m256i v = _mm256_add_epi32(
+              x[i < 16 ? i/4 : 3],
+              _mm256_broadcastsi128_si256(load128(k + i)));
+          store128(&wk[0][i], _mm256_castsi256_si128(v));
+          store128(&wk[1][i], _mm256_extracti128_si256(v, 1));
+        }
+        sha256rounds(sum, wk[0]);
+        sha256rounds(sum, wk[1]);
+      }
+      if (nblocks > 0)
+      {
+        sha256blocks_ssse3(sum, data, nblocks);
+      }
+    }
+
+    // sha extensions: the whole transform in hardware
+    __attribute__((target("sha,sse4.1")))
+    inline void sha256blocks_shani(sha256sum& sum, const char* data, size_t nblocks)
+    {
+      using namespace detail_sha256;
+      // rearrange the state from ABCD/EFGH to ABEF/CDGH
+      const __m128i dcba = _mm_shuffle_epi32(load128(&sum.h[0]), 0xb1);
+      const __m128i hgfe = _mm_shuffle_epi32(load128(&sum.h[4]), 0x1b);
+      __m128i abef = _mm_alignr_epi8(dcba, hgfe, 8);
+      __m128i cdgh = _mm_blend_epi16(hgfe, dcba, 0xf0);
+
+      for (; nblocks > 0; --nblocks, data += 64)
+      {
+        const __m128i abef0 = abef;
+        const __m128i cdgh0 = cdgh;
+
+        __m128i x0 = bswap32(load128(data));
+        __m128i x1 = bswap32(load128(data + 16));
+        __m128i x2 = bswap32(load128(data + 32));
+        __m128i x3 = bswap32(load128(data + 48));
+        rounds4(abef, cdgh, x0, 0);
+        rounds4(abef, cdgh, x1, 4);
+        rounds4(abef, cdgh, x2, 8);
+        rounds4(abef, cdgh, x3, 12);
+        for (int i = 16; i < 64; i += 16)
+        {
+          x0 = extend4_sha(x0, x1, x2, x3);
+          rounds4(abef, cdgh, x0, i);
+          x1 = extend4_sha(x1, x2, x3, x0);
+          rounds4(abef, cdgh, x1, i + 4);
+          x2 = extend4_sha(x2, x3, x0, x1);
+          rounds4(abef, cdgh, x2, i + 8);
+          x3 = extend4_sha(x3, x0, x1, x2);
+          rounds4(abef, cdgh, x3, i + 12);
+        }
+
+        abef = _mm_add_epi32(abef, abef0);
+        cdgh = _mm_add_epi32(cdgh, cdgh0);
+      }
+
+      // and back again
+      const __m128i feba = _mm_shuffle_epi32(abef, 0x1b);
+      const __m128i dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+      store128(&sum.h[0], _mm_blend_epi16(feba, dchg, 0xf0));
+      store128(&sum.h[4], _mm_alignr_epi8(dchg, feba, 8));
+    }
+#endif
+
+    using sha256blocks_fn = void (*)(sha256sum&, const char*, size_t);
+
+    inline sha256blocks_fn sha256blocks_select()
+    {
+#if CX_X86_SIMD
+      const cpu_features& f = cpu();
+      return f.sha && f.sse41 ? sha256blocks_shani :
+        f.avx2 ? sha256blocks_avx2 :
+        f.ssse3 ? sha256blocks_ssse3 :
+        sha256blocks_scalar;
+#else
+      return sha256blocks_scalar;
+#endif
+    }
+
+    inline void sha256blocks(sha256sum& sum, const char* data, size_t nblocks)
+    {
+      static const sha256blocks_fn f = sha256blocks_select();
+      f(sum, data, nblocks);
+    }
+
+    // the last two conditions of sha256update: the final (less than 64-byte)
+    // piece of the message, padded and followed by the big-endian bit length
+    // (one block, or two if the length doesn't fit after it), built in a
+    // buffer so that it goes through sha256blocks like the rest
+    inline sha256sum sha256final(sha256sum sum, const char* msg,
+                                 int len, uint64_t origlen)
+    {
+      char block[128] = {};
+      const size_t n = static_cast<size_t>(len);
+      if (n > 0) std::memcpy(block, msg, n);
+      block[n] = static_cast<char>(0x80);
+      const size_t nblocks = n >= 56 ? 2 : 1;
+      const uint64_t bits = origlen * 8;
+      for (size_t i = 0; i < 8; ++i)
+      {
+        block[nblocks*64 - 1 - i] = static_cast<char>(bits >> (8*i));
+      }
+      sha256blocks(sum, block, nblocks);
+      return detail::sha256::sha256tole(sum);
+    }
+
+    // the whole message, from a given initial state
+    inline sha256sum sha256withinit(sha256sum sum, const char* s, size_t len)
+    {
+      sha256blocks(sum, s, len / 64);
+      return sha256final(sum, s + (len & ~size_t{63}), static_cast<int>(len & 63), len);
+    }
+
+    inline sha256sum sha256(const char* s, size_t len)
+    {
+      return sha256withinit(detail::sha256::init(), s, len);
+    }
+
+    inline sha256sum sha256(const char* s)
+    {
+      return sha256(s, static_cast<size_t>(strlen(s)));
+    }
+
+    inline sha224sum sha224(const char* s, size_t len)
+    {
+      return detail::sha256::sha224truncate(
+          sha256withinit(detail::sha256::init224(), s, len));
+    }
+
+    inline sha224sum sha224(const char* s)
+    {
+      return sha224(s, static_cast<size_t>(strlen(s)));
     }
   }
+
   constexpr sha256sum sha256(const char* s)
   {
-    return true ? detail::sha256::sha256tole(detail::sha256::sha256(s)) :
-      throw err::sha256_runtime_error;
+    return CX_CONSTANT_EVALUATED() ?
+      detail::sha256::sha256tole(detail::sha256::sha256(s)) :
+      CX_RUNTIME_DISPATCH(runtime::sha256(s), err::sha256_runtime_error);
+  }
+
+  // sha256 of a buffer that may contain NUL bytes
+  constexpr sha256sum sha256(const char* s, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::sha256::sha256tole(
+          detail::sha256::sha256withlen(s, static_cast<int>(len))) :
+      CX_RUNTIME_DISPATCH(runtime::sha256(s, len), err::sha256_runtime_error);
+  }
+
+  constexpr sha224sum sha224(const char* s)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::sha256::sha224truncate(detail::sha256::sha256tole(
+          detail::sha256::sha224withlen(s, strlen(s)))) :
+      CX_RUNTIME_DISPATCH(runtime::sha224(s), err::sha224_runtime_error);
+  }
+
+  constexpr sha224sum sha224(const char* s, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::sha256::sha224truncate(detail::sha256::sha256tole(
+          detail::sha256::sha224withlen(s, static_cast<int>(len)))) :
+      CX_RUNTIME_DISPATCH(runtime::sha224(s, len), err::sha224_runtime_error);
+  }
+
+  // Incremental sha256 for runtime use, e.g. on data that arrives in chunks or
+  // is too large to buffer (see runtime::block_buffer in cx_utils.h). The
+  // result is identical to cx::sha256 on the concatenated input.
+  //
+  // cx::sha256_ctx ctx;
+  // while (size_t n = read(buf, sizeof(buf))) ctx.update(buf, n);
+  // auto sum = ctx.final();
+  using sha256_ctx = runtime::block_buffer<
+    sha256sum, detail::sha256::init, runtime::sha256blocks, runtime::sha256final>;
+
+  //----------------------------------------------------------------------------
+  // multi-buffer sha256 (runtime only)
+  //
+  // Hashing many small messages one after another is bound by the latency of
+  // the round dependency chain. Instead, N independent messages are hashed in
+  // the N lanes of a vector register, with one vector instruction doing the
+  // same step of each lane's round. The schedules are built by the same
+  // init/leftover functions as the constexpr version, transposed so that
+  // w[j][lane] is word j of that lane's block. When a lane's message is
+  // finished, the lane is refilled with the next message.
+
+  namespace runtime
+  {
+#if CX_X86_SIMD
+    namespace detail_sha256_mb
+    {
+      // aligned loads and stores of a row of lanes
+      __attribute__((target("sse2")))
+      inline __m128i load4(const uint32_t* p)
+      {
+        return _mm_load_si128(static_cast<const __m128i*>(static_cast<const void*>(p)));
+      }
+      __attribute__((target("sse2")))
+      inline void store4(uint32_t* p, __m128i x)
+      {
+        _mm_store_si128(static_cast<__m128i*>(static_cast<void*>(p)), x);
+      }
+      __attribute__((target("avx2")))
+      inline __m256i load8(const uint32_t* p)
+      {
+        return _mm256_load_si256(static_cast<const __m256i*>(static_cast<const void*>(p)));
+      }
+      __attribute__((target("avx2")))
+      inline void store8(uint32_t* p, __m256i x)
+      {
+        _mm256_store_si256(static_cast<__m256i*>(static_cast<void*>(p)), x);
+      }
+
+      // the round functions, on N lanes at once
+      __attribute__((target("sse2")))
+      inline __m128i rotr(__m128i x, int n)
+      {
+        return _mm_or_si128(_mm_srli_epi32(x, n), _mm_slli_epi32(x, 32-n));
+      }
+      __attribute__((target("sse2")))
+      inline __m128i xor3(__m128i x, __m128i y, __m128i z)
+      {
+        return _mm_xor_si128(_mm_xor_si128(x, y), z);
+      }
+      __attribute__((target("sse2")))
+      inline __m128i s0(__m128i x)
+      {
+        return xor3(rotr(x, 7), rotr(x, 18), _mm_srli_epi32(x, 3));
+      }
+      __attribute__((target("sse2")))
+      inline __m128i s1(__m128i x)
+      {
+        return xor3(rotr(x, 17), rotr(x, 19), _mm_srli_epi32(x, 10));
+      }
+      __attribute__((target("sse2")))
+      inline __m128i S0(__m128i a)
+      {
+        return xor3(rotr(a, 2), rotr(a, 13), rotr(a, 22));
+      }
+      __attribute__((target("sse2")))
+      inline __m128i S1(__m128i e)
+      {
+        return xor3(rotr(e, 6), rotr(e, 11), rotr(e, 25));
+      }
+      __attribute__((target("sse2")))
+      inline __m128i ch(__m128i e, __m128i f, __m128i g)
+      {
+        return _mm_xor_si128(_mm_and_si128(e, f), _mm_andnot_si128(e, g));
+      }
+      __attribute__((target("sse2")))
+      inline __m128i maj(__m128i a, __m128i b, __m128i c)
+      {
+        return _mm_or_si128(_mm_and_si128(a, b), _mm_and_si128(c, _mm_or_si128(a, b)));
+      }
+
+      __attribute__((target("avx2")))
+      inline __m256i rotr(__m256i x, int n)
+      {
+        return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32-n));
+      }
+      __attribute__((target("avx2")))
+      inline __m256i xor3(__m256i x, __m256i y, __m256i z)
+      {
+        return _mm256_xor_si256(_mm256_xor_si256(x, y), z);
+      }
+      __attribute__((target("avx2")))
+      inline __m256i s0(__m256i x)
+      {
+        return xor3(rotr(x, 7), rotr(x, 18), _mm256_srli_epi32(x, 3));
+      }
+      __attribute__((target("avx2")))
+      inline __m256i s1(__m256i x)
+      {
+        return xor3(rotr(x, 17), rotr(x, 19), _mm256_srli_epi32(x, 10));
+      }
+      __attribute__((target("avx2")))
+      inline __m256i S0(__m256i a)
+      {
+        return xor3(rotr(a, 2), rotr(a, 13), rotr(a, 22));
+      }
+      __attribute__((target("avx2")))
+      inline __m256i S1(__m256i e)
+      {
+        return xor3(rotr(e, 6), rotr(e, 11), rotr(e, 25));
+      }
+      __attribute__((target("avx2")))
+      inline __m256i ch(__m256i e, __m256i f, __m256i g)
+      {
+        return _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+      }
+      __attribute__((target("avx2")))
+      inline __m256i maj(__m256i a, __m256i b, __m256i c)
+      {
+        return _mm256_or_si256(_mm256_and_si256(a, b),
+                               _mm256_and_si256(c, _mm256_or_si256(a, b)));
+      }
+
+      // avx-512 has rotates, and ternary logic for the three-input functions.
+      // (the zero-masked shifts avoid spurious uninitialized warnings from the
+      // unmasked intrinsics in some gcc versions.)
+      template <int n>
+      __attribute__((target("avx512f")))
+      inline __m512i rotr(__m512i x)
+      {
+        return _mm512_maskz_ror_epi32(0xffff, x, n);
+      }
+      template <int n>
+      __attribute__((target("avx512f")))
+      inline __m512i shr(__m512i x)
+      {
+        return _mm512_maskz_srli_epi32(0xffff, x, n);
+      }
+      __attribute__((target("avx512f")))
+      inline __m512i xor3(__m512i x, __m512i y, __m512i z)
+      {
+        return _mm512_ternarylogic_epi32(x, y, z, 0x96);
+      }
+      __attribute__((target("avx512f")))
+      inline __m512i s0(__m512i x)
+      {
+        return xor3(rotr<7>(x), rotr<18>(x), shr<3>(x));
+      }
+      __attribute__((target("avx512f")))
+      inline __m512i s1(__m512i x)
+      {
+        return xor3(rotr<17>(x), rotr<19>(x), shr<10>(x));
+      }
+      __attribute__((target("avx512f")))
+      inline __m512i S0(__m512i a)
+      {
+        return xor3(rotr<2>(a), rotr<13>(a), rotr<22>(a));
+      }
+      __attribute__((target("avx512f")))
+      inline __m512i S1(__m512i e)
+      {
+        return xor3(rotr<6>(e), rotr<11>(e), rotr<25>(e));
+      }
+      __attribute__((target("avx512f")))
+      inline __m512i ch(__m512i e, __m512i f, __m512i g)
+      {
+        return _mm512_ternarylogic_epi32(e, f, g, 0xca);
+      }
+      __attribute__((target("avx512f")))
+      inline __m512i maj(__m512i a, __m512i b, __m512i c)
+      {
+        return _mm512_ternarylogic_epi32(a, b, c, 0xe8);
+      }
+    }
+
+    // one block transform in each of N lanes: st[i][lane] is word i of that
+    // lane's state, w[j][lane] is word j of its block (the schedule is
+    // extended in place, 16 words at a time)
+    __attribute__((target("sse2")))
+    inline void sha256lanes4(uint32_t st[][4], const uint32_t w[][4])
+    {
+      using namespace detail_sha256_mb;
+      __m128i x[16];
+      for (int j = 0; j < 16; ++j) x[j] = load4(w[j]);
+      __m128i a = load4(st[0]), b = load4(st[1]), c = load4(st[2]), d = load4(st[3]);
+      __m128i e = load4(st[4]), f = load4(st[5]), g = load4(st[6]), h = load4(st[7]);
+      for (int i = 0; i < 64; ++i)
+      {
+        __m128i& wi = x[i & 15];
+        if (i >= 16)
+        {
+          wi = _mm_add_epi32(_mm_add_epi32(wi, x[(i+9) & 15]),
+                             _mm_add_epi32(s0(x[(i+1) & 15]), s1(x[(i+14) & 15])));
+        }
+        const __m128i t1 = _mm_add_epi32(
+            _mm_add_epi32(h, S1(e)),
+            _mm_add_epi32(ch(e, f, g),
+                          _mm_add_epi32(wi, _mm_set1_epi32(
+                                            static_cast<int>(detail::sha256::roundconst[i])))));
+        const __m128i t2 = _mm_add_epi32(S0(a), maj(a, b, c));
+        h = g; g = f; f = e; e = _mm_add_epi32(d, t1);
+        d = c; c = b; b = a; a = _mm_add_epi32(t1, t2);
+      }
+      const __m128i v[8] = { a, b, c, d, e, f, g, h };
+      for (int i = 0; i < 8; ++i)
+      {
+        store4(st[i], _mm_add_epi32(load4(st[i]), v[i]));
+      }
+    }
+
+    __attribute__((target("avx2")))
+    inline void sha256lanes8(uint32_t st[][8], const uint32_t w[][8])
+    {
+      using namespace detail_sha256_mb;
+      __m256i x[16];
+      for (int j = 0; j < 16; ++j) x[j] = load8(w[j]);
+      __m256i a = load8(st[0]), b = load8(st[1]), c = load8(st[2]), d = load8(st[3]);
+      __m256i e = load8(st[4]), f = load8(st[5]), g = load8(st[6]), h = load8(st[7]);
+      for (int i = 0; i < 64; ++i)
+      {
+        __m256i& wi = x[i & 15];
+        if (i >= 16)
+        {
+          wi = _mm256_add_epi32(_mm256_add_epi32(wi, x[(i+9) & 15]),
+                                _mm256_add_epi32(s0(x[(i+1) & 15]), s1(x[(i+14) & 15])));
+        }
+        const __m256i t1 = _mm256_add_epi32(
+            _mm256_add_epi32(h, S1(e)),
+            _mm256_add_epi32(ch(e, f, g),
+                             _mm256_add_epi32(wi, _mm256_set1_epi32(
+                                                  static_cast<int>(detail::sha256::roundconst[i])))));
+        const __m256i t2 = _mm256_add_epi32(S0(a), maj(a, b, c));
+        h = g; g = f; f = e; e = _mm256_add_epi32(d, t1);
+        d = c; c = b; b = a; a = _mm256_add_epi32(t1, t2);
+      }
+      const __m256i v[8] = { a, b, c, d, e, f, g, h };
+      for (int i = 0; i < 8; ++i)
+      {
+        store8(st[i], _mm256_add_epi32(load8(st[i]), v[i]));
+      }
+    }
+
+    __attribute__((target("avx512f")))
+    inline void sha256lanes16(uint32_t st[][16], const uint32_t w[][16])
+    {
+      using namespace detail_sha256_mb;
+      __m512i x[16];
+      for (int j = 0; j < 16; ++j) x[j] = _mm512_load_si512(w[j]);
+      __m512i a = _mm512_load_si512(st[0]), b = _mm512_load_si512(st[1]);
+      __m512i c = _mm512_load_si512(st[2]), d = _mm512_load_si512(st[3]);
+      __m512i e = _mm512_load_si512(st[4]), f = _mm512_load_si512(st[5]);
+      __m512i g = _mm512_load_si512(st[6]), h = _mm512_load_si512(st[7]);
+      for (int i = 0; i < 64; ++i)
+      {
+        __m512i& wi = x[i & 15];
+        if (i >= 16)
+        {
+          wi = _mm512_add_epi32(_mm512_add_epi32(wi, x[(i+9) & 15]),
+                                _mm512_add_epi32(s0(x[(i+1) & 15]), s1(x[(i+14) & 15])));
+        }
+        const __m512i t1 = _mm512_add_epi32(
+            _mm512_add_epi32(h, S1(e)),
+            _mm512_add_epi32(ch(e, f, g),
+                             _mm512_add_epi32(wi, _mm512_set1_epi32(
+                                                  static_cast<int>(detail::sha256::roundconst[i])))));
+        const __m512i t2 = _mm512_add_epi32(S0(a), maj(a, b, c));
+        h = g; g = f; f = e; e = _mm512_add_epi32(d, t1);
+        d = c; c = b; b = a; a = _mm512_add_epi32(t1, t2);
+      }
+      const __m512i v[8] = { a, b, c, d, e, f, g, h };
+      for (int i = 0; i < 8; ++i)
+      {
+        _mm512_store_si512(st[i], _mm512_add_epi32(_mm512_load_si512(st[i]), v[i]));
+      }
+    }
+#endif
+
+    // feeds messages through the N lanes of a block function. a lane's blocks
+    // are the message's whole 64-byte blocks, then one or two padded blocks
+    // (as in sha256final). once fewer than a quarter of the lanes are still
+    // busy and no messages are waiting, the stragglers are finished one at a
+    // time with sha256blocks.
+    template <size_t N>
+    void sha256_many_lanes(const byte_view* msgs, size_t n, sha256sum* out,
+                           void (*lanes)(uint32_t[][N], const uint32_t[][N]))
+    {
+      struct lane
+      {
+        size_t msg;
+        size_t block;
+        size_t nblocks;
+      };
+      alignas(64) uint32_t st[8][N] = {};
+      alignas(64) uint32_t w[16][N] = {};
+      lane ln[N];
+      bool busy[N];
+      size_t next = 0;
+      size_t nbusy = 0;
+
+      const auto start = [&] (size_t l) {
+        busy[l] = next < n;
+        if (!busy[l]) return;
+        const size_t len = msgs[next].size;
+        ln[l] = { next++, 0, len / 64 + ((len & 63) >= 56 ? 2 : 1) };
+        const sha256sum s = detail::sha256::init();
+        for (int i = 0; i < 8; ++i) st[i][l] = s.h[i];
+        ++nbusy;
+      };
+      const auto schedule = [&] (const lane& x) {
+        const byte_view& m = msgs[x.msg];
+        const size_t nfull = m.size / 64;
+        const char* tail = m.data + nfull * 64;
+        const int r = static_cast<int>(m.size & 63);
+        return x.block < nfull ? detail::sha256::init(m.data + x.block * 64) :
+          x.block == nfull ? detail::sha256::leftover(tail, r, m.size, r >= 56 ? 64 : 56) :
+          detail::sha256::leftover(tail + r, -1, m.size, 56);
+      };
+
+      for (size_t l = 0; l < N; ++l) start(l);
+      while (nbusy > 0)
+      {
+        if (next == n && nbusy * 4 <= N) break;
+        for (size_t l = 0; l < N; ++l)
+        {
+          if (!busy[l]) continue;
+          const detail::sha256::schedule s = schedule(ln[l]);
+          for (int j = 0; j < 16; ++j) w[j][l] = s.w[j];
+        }
+        lanes(st, w);
+        for (size_t l = 0; l < N; ++l)
+        {
+          if (!busy[l] || ++ln[l].block < ln[l].nblocks) continue;
+          sha256sum s;
+          for (int i = 0; i < 8; ++i) s.h[i] = st[i][l];
+          out[ln[l].msg] = detail::sha256::sha256tole(s);
+          --nbusy;
+          start(l);
+        }
+      }
+
+      for (size_t l = 0; l < N; ++l)
+      {
+        if (!busy[l]) continue;
+        sha256sum s;
+        for (int i = 0; i < 8; ++i) s.h[i] = st[i][l];
+        const byte_view& m = msgs[ln[l].msg];
+        const size_t nfull = m.size / 64;
+        if (ln[l].block < nfull)
+        {
+          sha256blocks(s, m.data + ln[l].block * 64, nfull - ln[l].block);
+          ln[l].block = nfull;
+        }
+        for (; ln[l].block < ln[l].nblocks; ++ln[l].block)
+        {
+          sha256transform(s, schedule(ln[l]));
+        }
+        out[ln[l].msg] = detail::sha256::sha256tole(s);
+      }
+    }
+  }
+
+  // Hash n independent messages, writing each digest to out[i] (the same as
+  // cx::sha256(msgs[i].data, msgs[i].size)). This is the fast way to hash a
+  // large batch of small messages; it uses 16, 8 or 4 lanes (avx-512, avx2 or
+  // sse2) depending on the cpu. With the SHA extensions, one message at a
+  // time is faster than any number of lanes, so that is what it does.
+  inline void sha256_many(const byte_view* msgs, size_t n, sha256sum* out)
+  {
+#if CX_X86_SIMD
+    const runtime::cpu_features& f = runtime::cpu();
+    if (!(f.sha && f.sse41))
+    {
+      if (f.avx512f) return runtime::sha256_many_lanes<16>(msgs, n, out, runtime::sha256lanes16);
+      if (f.avx2) return runtime::sha256_many_lanes<8>(msgs, n, out, runtime::sha256lanes8);
+      if (f.sse2) return runtime::sha256_many_lanes<4>(msgs, n, out, runtime::sha256lanes4);
+    }
+#endif
+    for (size_t i = 0; i < n; ++i)
+    {
+      out[i] = runtime::sha256(msgs[i].data, msgs[i].size);
+    }
   }
 }
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "cx_file.h"
+#include "cx_parallel.h"
+#include "cx_sha256.h"
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// tree-hashed sha256 of large data (runtime only)
+//
+// A single sha256 stream can't use more than one core. Instead, the data is
+// split into fixed-size leaves (1 MiB by default) which are hashed
+// concurrently, and the leaf digests are combined pairwise, level by level,
+// into a root digest. As in RFC 6962, leaves and interior nodes are hashed
+// with different prefixes:
+//
+//   leaf = sha256(0x00 || bytes)
+//   node = sha256(0x01 || left || right)
+//
+// and a node without a right child is carried up unchanged. An empty input
+// is one empty leaf. The root depends on the leaf size, so digests only
+// compare equal when made with the same leaf size.
+//
+// A sha256_tree keeps every level, so when part of the data changes only the
+// leaves covering the change, and their ancestors, are rehashed.
+
+namespace cx
+{
+  namespace runtime
+  {
+    namespace detail_sha256_tree
+    {
+      inline sha256sum leaf(const char* data, size_t len)
+      {
+        const char prefix = 0;
+        sha256_ctx ctx;
+        ctx.update(&prefix, 1);
+        ctx.update(data, len);
+        return ctx.final();
+      }
+
+      inline sha256sum node(const sha256sum& left, const sha256sum& right)
+      {
+        char buf[1 + 2 * sizeof(left.h)];
+        buf[0] = 1;
+        std::memcpy(buf + 1, left.h, sizeof(left.h));
+        std::memcpy(buf + 1 + sizeof(left.h), right.h, sizeof(right.h));
+        return sha256(buf, sizeof(buf));
+      }
+
+      // nodes [lo, hi) of the level above src (interior nodes are cheap, so
+      // they are shared out among the threads in runs)
+      inline void combine(const std::vector<sha256sum>& src, std::vector<sha256sum>& dst,
+                          size_t lo, size_t hi, unsigned nthreads)
+      {
+        const size_t run = 256;
+        parallel_for((hi - lo + run - 1) / run, [&] (size_t r) {
+            const size_t end = lo + (r + 1) * run < hi ? lo + (r + 1) * run : hi;
+            for (size_t j = lo + r * run; j < end; ++j)
+            {
+              dst[j] = 2 * j + 1 < src.size() ? node(src[2 * j], src[2 * j + 1]) : src[2 * j];
+            }
+          }, nthreads);
+      }
+    }
+  }
+
+  class sha256_tree
+  {
+  public:
+    static constexpr size_t default_leaf_size = size_t{1} << 20;
+
+    explicit sha256_tree(size_t leaf_size = default_leaf_size)
+      : m_leaf_size(leaf_size > 0 ? leaf_size : size_t{default_leaf_size}), m_size(0)
+    {}
+
+    // hash all of the data, on nthreads threads (0 means one per hardware
+    // thread)
+    void build(const char* data, size_t size, unsigned nthreads = 0)
+    {
+      m_levels.clear();
+      update(data, size, 0, size, nthreads);
+    }
+
+    // The bytes [offset, offset + len) of the data have changed: data and size
+    // are its new contents (which may have a different size, in which case
+    // everything from the old or new end is rehashed too). Only the leaves
+    // covering the change, and their ancestors, are rehashed.
+    void update(const char* data, size_t size, size_t offset, size_t len,
+                unsigned nthreads = 0)
+    {
+      const size_t n = size == 0 ? 1 : (size - 1) / m_leaf_size + 1;
+      size_t lo = offset / m_leaf_size;
+      size_t hi = len == 0 ? lo : (offset + len - 1) / m_leaf_size + 1;
+      if (m_levels.empty())
+      {
+        m_levels.resize(1);
+        lo = 0;
+        hi = n;
+      }
+      else if (size != m_size)
+      {
+        const size_t last = m_levels[0].size() < n ? m_levels[0].size() : n;
+        if (last - 1 < lo) lo = last - 1;
+        hi = n;
+      }
+      if (hi > n) hi = n;
+      m_size = size;
+      if (lo >= hi) return;
+
+      std::vector<sha256sum>& leaves = m_levels[0];
+      leaves.resize(n);
+      runtime::parallel_for(hi - lo, [&] (size_t i) {
+          const size_t begin = (lo + i) * m_leaf_size;
+          const size_t end = begin + m_leaf_size < size ? begin + m_leaf_size : size;
+          leaves[lo + i] = runtime::detail_sha256_tree::leaf(data + begin, end - begin);
+        }, nthreads);
+
+      size_t k = 0;
+      for (; m_levels[k].size() > 1; ++k)
+      {
+        if (m_levels.size() == k + 1) m_levels.resize(k + 2);
+        const size_t count = (m_levels[k].size() + 1) / 2;
+        // a level's end changes only when the size does, and then hi covers it
+        m_levels[k + 1].resize(count);
+        lo /= 2;
+        hi = (hi + 1) / 2;
+        runtime::detail_sha256_tree::combine(m_levels[k], m_levels[k + 1], lo, hi, nthreads);
+      }
+      m_levels.resize(k + 1);
+    }
+
+    sha256sum root() const { return m_levels.back()[0]; }
+
+    size_t leaf_size() const { return m_leaf_size; }
+    size_t leaf_count() const { return m_levels.empty() ? 0 : m_levels[0].size(); }
+    const sha256sum& leaf(size_t i) const { return m_levels[0][i]; }
+
+  private:
+    size_t m_leaf_size;
+    size_t m_size;
+    // m_levels[0] holds the leaf digests, m_levels.back() the root
+    std::vector<std::vector<sha256sum>> m_levels;
+  };
+
+  // the tree-hashed sha256 of n bytes, or of a (memory-mapped) file
+  inline sha256sum sha256_tree_hash(const char* data, size_t size,
+                                    size_t leaf_size = sha256_tree::default_leaf_size,
+                                    unsigned nthreads = 0)
+  {
+    sha256_tree t(leaf_size);
+    t.build(data, size, nthreads);
+    return t.root();
+  }
+  inline sha256sum sha256_tree_file(const char* path,
+                                    size_t leaf_size = sha256_tree::default_leaf_size,
+                                    unsigned nthreads = 0)
+  {
+    const runtime::mapped_file f(path);
+    return sha256_tree_hash(f.data(), f.size(), leaf_size, nthreads);
+  }
+}
@@ -0,0 +1,712 @@
+#pragma once
+
+#include "cx_cpuid.h"
+#include "cx_utils.h"
+
+#include <cstddef>
+#include <cstdint>
+
+//----------------------------------------------------------------------------
+// constexpr string hashing: sha-512, sha-384 and sha-512/256
+
+namespace cx
+{
+  // Results of the sha-512 family. As with sha256sum, the words are stored so
+  // that the bytes of h in memory are the digest.
+  //
+  // sha-384 and sha-512/256 are sha-512 from different initial states,
+  // truncated to 6 and 4 words.
+
+  namespace err
+  {
+    namespace
+    {
+      CX_ERROR_SYMBOL(sha512_runtime_error);
+      CX_ERROR_SYMBOL(sha384_runtime_error);
+      CX_ERROR_SYMBOL(sha512_256_runtime_error);
+    }
+  }
+
+  struct sha512sum
+  {
+    uint64_t h[8];
+  };
+
+  struct sha384sum
+  {
+    uint64_t h[6];
+  };
+
+  struct sha512_256sum
+  {
+    uint64_t h[4];
+  };
+
+  namespace detail
+  {
+    namespace sha512
+    {
+      // round constants (the fractional parts of the cube roots of the first
+      // 80 primes 2..409)
+      constexpr uint64_t roundconst[80] =
+      {
+        0x428a2f98d728ae22ull, 0x7137449123ef65cdull, 0xb5c0fbcfec4d3b2full,
+        0xe9b5dba58189dbbcull, 0x3956c25bf348b538ull, 0x59f111f1b605d019ull,
+        0x923f82a4af194f9bull, 0xab1c5ed5da6d8118ull, 0xd807aa98a3030242ull,
+        0x12835b0145706fbeull, 0x243185be4ee4b28cull, 0x550c7dc3d5ffb4e2ull,
+        0x72be5d74f27b896full, 0x80deb1fe3b1696b1ull, 0x9bdc06a725c71235ull,
+        0xc19bf174cf692694ull, 0xe49b69c19ef14ad2ull, 0xefbe4786384f25e3ull,
+        0x0fc19dc68b8cd5b5ull, 0x240ca1cc77ac9c65ull, 0x2de92c6f592b0275ull,
+        0x4a7484aa6ea6e483ull, 0x5cb0a9dcbd41fbd4ull, 0x76f988da831153b5ull,
+        0x983e5152ee66dfabull, 0xa831c66d2db43210ull, 0xb00327c898fb213full,
+        0xbf597fc7beef0ee4ull, 0xc6e00bf33da88fc2ull, 0xd5a79147930aa725ull,
+        0x06ca6351e003826full, 0x142929670a0e6e70ull, 0x27b70a8546d22ffcull,
+        0x2e1b21385c26c926ull, 0x4d2c6dfc5ac42aedull, 0x53380d139d95b3dfull,
+        0x650a73548baf63deull, 0x766a0abb3c77b2a8ull, 0x81c2c92e47edaee6ull,
+        0x92722c851482353bull, 0xa2bfe8a14cf10364ull, 0xa81a664bbc423001ull,
+        0xc24b8b70d0f89791ull, 0xc76c51a30654be30ull, 0xd192e819d6ef5218ull,
+        0xd69906245565a910ull, 0xf40e35855771202aull, 0x106aa07032bbd1b8ull,
+        0x19a4c116b8d2d0c8ull, 0x1e376c085141ab53ull, 0x2748774cdf8eeb99ull,
+        0x34b0bcb5e19b48a8ull, 0x391c0cb3c5c95a63ull, 0x4ed8aa4ae3418acbull,
+        0x5b9cca4f7763e373ull, 0x682e6ff3d6b2b8a3ull, 0x748f82ee5defb2fcull,
+        0x78a5636f43172f60ull, 0x84c87814a1f0ab72ull, 0x8cc702081a6439ecull,
+        0x90befffa23631e28ull, 0xa4506cebde82bde9ull, 0xbef9a3f7b2c67915ull,
+        0xc67178f2e372532bull, 0xca273eceea26619cull, 0xd186b8c721c0c207ull,
+        0xeada7dd6cde0eb1eull, 0xf57d4f7fee6ed178ull, 0x06f067aa72176fbaull,
+        0x0a637dc5a2c898a6ull, 0x113f9804bef90daeull, 0x1b710b35131c471bull,
+        0x28db77f523047d84ull, 0x32caab7b40c72493ull, 0x3c9ebe0a15c9bebcull,
+        0x431d67c49c100d4cull, 0x4cc5d4becb3e42b6ull, 0x597f299cfc657e2aull,
+        0x5fcb6fab3ad6faecull, 0x6c44198c4a475817ull
+      };
+
+      // a schedule is the chunk of buffer to work on, extended to 80 words
+      struct schedule
+      {
+        uint64_t w[80];
+      };
+
+      // add two sha512sums
+      constexpr sha512sum sumadd(const sha512sum& s1, const sha512sum& s2)
+      {
+        return { { s1.h[0] + s2.h[0], s1.h[1] + s2.h[1],
+              s1.h[2] + s2.h[2], s1.h[3] + s2.h[3],
+              s1.h[4] + s2.h[4], s1.h[5] + s2.h[5],
+              s1.h[6] + s2.h[6], s1.h[7] + s2.h[7] } };
+      }
+      // initial states
+      constexpr sha512sum init()
+      {
+        return { { 0x6a09e667f3bcc908ull, 0xbb67ae8584caa73bull,
+              0x3c6ef372fe94f82bull, 0xa54ff53a5f1d36f1ull,
+              0x510e527fade682d1ull, 0x9b05688c2b3e6c1full,
+              0x1f83d9abfb41bd6bull, 0x5be0cd19137e2179ull } };
+      }
+      constexpr sha512sum init384()
+      {
+        return { { 0xcbbb9d5dc1059ed8ull, 0x629a292a367cd507ull,
+              0x9159015a3070dd17ull, 0x152fecd8f70e5939ull,
+              0x67332667ffc00b31ull, 0x8eb44a8768581511ull,
+              0xdb0c2e0d64f98fa7ull, 0x47b5481dbefa4fa4ull } };
+      }
+      constexpr sha512sum init512_256()
+      {
+        return { { 0x22312194fc2bf72cull, 0x9f555fa3c84c64c2ull,
+              0x2393b86b6f53b151ull, 0x963877195940eabdull,
+              0x96283ee2a88effe3ull, 0xbe5e1e2553863992ull,
+              0x2b0199fc2c85b8aaull, 0x0eb72ddc81c52ca2ull } };
+      }
+      // schedule from an existing buffer
+      constexpr schedule init(const char* buf)
+      {
+        return { { word64be(buf), word64be(buf+8), word64be(buf+16), word64be(buf+24),
+              word64be(buf+32), word64be(buf+40), word64be(buf+48), word64be(buf+56),
+              word64be(buf+64), word64be(buf+72), word64be(buf+80), word64be(buf+88),
+              word64be(buf+96), word64be(buf+104), word64be(buf+112), word64be(buf+120) } };
+      }
+
+      // padding as for sha-256, but to a multiple of 128 bytes, and the
+      // original length (in bits) is the last 16 bytes of padding
+      constexpr uint64_t pad(int len)
+      {
+        return len >= 0 && len < 8 ? 0x80ull << (56 - 8*len) : 0;
+      }
+      constexpr uint64_t origlenbytes(uint64_t origlen, int origlenpos)
+      {
+        return origlenpos == -8 ? origlen*8 :
+          origlenpos == 0 ? origlen >> 61 :
+          0;
+      }
+      constexpr schedule leftover(const char* buf,
+                                  int len, uint64_t origlen, int origlenpos)
+      {
+        return { { word64be(buf, len) | pad(len) | origlenbytes(origlen, origlenpos),
+              word64be(len >= 8 ? buf+8 : buf, len-8)
+                | pad(len-8) | origlenbytes(origlen, origlenpos-8),
+              word64be(len >= 16 ? buf+16 : buf, len-16)
+                | pad(len-16) | origlenbytes(origlen, origlenpos-16),
+              word64be(len >= 24 ? buf+24 : buf, len-24)
+                | pad(len-24) | origlenbytes(origlen, origlenpos-24),
+              word64be(len >= 32 ? buf+32 : buf, len-32)
+                | pad(len-32) | origlenbytes(origlen, origlenpos-32),
+              word64be(len >= 40 ? buf+40 : buf, len-40)
+                | pad(len-40) | origlenbytes(origlen, origlenpos-40),
+              word64be(len >= 48 ? buf+48 : buf, len-48)
+                | pad(len-48) | origlenbytes(origlen, origlenpos-48),
+              word64be(len >= 56 ? buf+56 : buf, len-56)
+                | pad(len-56) | origlenbytes(origlen, origlenpos-56),
+              word64be(len >= 64 ? buf+64 : buf, len-64)
+                | pad(len-64) | origlenbytes(origlen, origlenpos-64),
+              word64be(len >= 72 ? buf+72 : buf, len-72)
+                | pad(len-72) | origlenbytes(origlen, origlenpos-72),
+              word64be(len >= 80 ? buf+80 : buf, len-80)
+                | pad(len-80) | origlenbytes(origlen, origlenpos-80),
+              word64be(len >= 88 ? buf+88 : buf, len-88)
+                | pad(len-88) | origlenbytes(origlen, origlenpos-88),
+              word64be(len >= 96 ? buf+96 : buf, len-96)
+                | pad(len-96) | origlenbytes(origlen, origlenpos-96),
+              word64be(len >= 104 ? buf+104 : buf, len-104)
+                | pad(len-104) | origlenbytes(origlen, origlenpos-104),
+              word64be(len >= 112 ? buf+112 : buf, len-112)
+                | pad(len-112) | origlenbytes(origlen, origlenpos-112),
+              word64be(len >= 120 ? buf+120 : buf, len-120)
+                | pad(len-120) | origlenbytes(origlen, origlenpos-120) } };
+      }
+
+      constexpr uint64_t rotateR(uint64_t x, int n)
+      {
+        return (x << (64-n)) | (x >> n);
+      }
+      constexpr uint64_t s0(uint64_t x)
+      {
+        return rotateR(x, 1) ^ rotateR(x, 8) ^ (x >> 7);
+      }
+      constexpr uint64_t s1(uint64_t x)
+      {
+        return rotateR(x, 19) ^ rotateR(x, 61) ^ (x >> 6);
+      }
+
+      constexpr uint64_t extendvalue(const uint64_t* w, int i, int n)
+      {
+        return i < n ? w[i] :
+          extendvalue(w, i-16, n) + extendvalue(w, i-7, n)
+          + s0(extendvalue(w, i-15, n)) + s1(extendvalue(w, i-2, n));
+      }
+
+      // extend the 16 words in the schedule to the whole 80, by 16s (see
+      // sha256extend)
+      constexpr schedule sha512extend16(const schedule& s)
+      {
+        return { { s.w[0], s.w[1], s.w[2], s.w[3],
+              s.w[4], s.w[5], s.w[6], s.w[7],
+              s.w[8], s.w[9], s.w[10], s.w[11],
+              s.w[12], s.w[13], s.w[14], s.w[15],
+              extendvalue(s.w, 16, 16), extendvalue(s.w, 17, 16),
+              extendvalue(s.w, 18, 16), extendvalue(s.w, 19, 16),
+              extendvalue(s.w, 20, 16), extendvalue(s.w, 21, 16),
+              extendvalue(s.w, 22, 16), extendvalue(s.w, 23, 16),
+              extendvalue(s.w, 24, 16), extendvalue(s.w, 25, 16),
+              extendvalue(s.w, 26, 16), extendvalue(s.w, 27, 16),
+              extendvalue(s.w, 28, 16), extendvalue(s.w, 29, 16),
+              extendvalue(s.w, 30, 16), extendvalue(s.w, 31, 16) } };
+      }
+      constexpr schedule sha512extend32(const schedule& s)
+      {
+        return { { s.w[0], s.w[1], s.w[2], s.w[3],
+              s.w[4], s.w[5], s.w[6], s.w[7],
+              s.w[8], s.w[9], s.w[10], s.w[11],
+              s.w[12], s.w[13], s.w[14], s.w[15],
+              s.w[16], s.w[17], s.w[18], s.w[19],
+              s.w[20], s.w[21], s.w[22], s.w[23],
+              s.w[24], s.w[25], s.w[26], s.w[27],
+              s.w[28], s.w[29], s.w[30], s.w[31],
+              extendvalue(s.w, 32, 32), extendvalue(s.w, 33, 32),
+              extendvalue(s.w, 34, 32), extendvalue(s.w, 35, 32),
+              extendvalue(s.w, 36, 32), extendvalue(s.w, 37, 32),
+              extendvalue(s.w, 38, 32), extendvalue(s.w, 39, 32),
+              extendvalue(s.w, 40, 32), extendvalue(s.w, 41, 32),
+              extendvalue(s.w, 42, 32), extendvalue(s.w, 43, 32),
+              extendvalue(s.w, 44, 32), extendvalue(s.w, 45, 32),
+              extendvalue(s.w, 46, 32), extendvalue(s.w, 47, 32) } };
+      }
+      constexpr schedule sha512extend48(const schedule& s)
+      {
+        return { { s.w[0], s.w[1], s.w[2], s.w[3],
+              s.w[4], s.w[5], s.w[6], s.w[7],
+              s.w[8], s.w[9], s.w[10], s.w[11],
+              s.w[12], s.w[13], s.w[14], s.w[15],
+              s.w[16], s.w[17], s.w[18], s.w[19],
+              s.w[20], s.w[21], s.w[22], s.w[23],
+              s.w[24], s.w[25], s.w[26], s.w[27],
+              s.w[28], s.w[29], s.w[30], s.w[31],
+              s.w[32], s.w[33], s.w[34], s.w[35],
+              s.w[36], s.w[37], s.w[38], s.w[39],
+              s.w[40], s.w[41], s.w[42], s.w[43],
+              s.w[44], s.w[45], s.w[46], s.w[47],
+              extendvalue(s.w, 48, 48), extendvalue(s.w, 49, 48),
+              extendvalue(s.w, 50, 48), extendvalue(s.w, 51, 48),
+              extendvalue(s.w, 52, 48), extendvalue(s.w, 53, 48),
+              extendvalue(s.w, 54, 48), extendvalue(s.w, 55, 48),
+              extendvalue(s.w, 56, 48), extendvalue(s.w, 57, 48),
+              extendvalue(s.w, 58, 48), extendvalue(s.w, 59, 48),
+              extendvalue(s.w, 60, 48), extendvalue(s.w, 61, 48),
+              extendvalue(s.w, 62, 48), extendvalue(s.w, 63, 48) } };
+      }
+      constexpr schedule sha512extend64(const schedule& s)
+      {
+        return { { s.w[0], s.w[1], s.w[2], s.w[3],
+              s.w[4], s.w[5], s.w[6], s.w[7],
+              s.w[8], s.w[9], s.w[10], s.w[11],
+              s.w[12], s.w[13], s.w[14], s.w[15],
+              s.w[16], s.w[17], s.w[18], s.w[19],
+              s.w[20], s.w[21], s.w[22], s.w[23],
+              s.w[24], s.w[25], s.w[26], s.w[27],
+              s.w[28], s.w[29], s.w[30], s.w[31],
+              s.w[32], s.w[33], s.w[34], s.w[35],
+              s.w[36], s.w[37], s.w[38], s.w[39],
+              s.w[40], s.w[41], s.w[42], s.w[43],
+              s.w[44], s.w[45], s.w[46], s.w[47],
+              s.w[48], s.w[49], s.w[50], s.w[51],
+              s.w[52], s.w[53], s.w[54], s.w[55],
+              s.w[56], s.w[57], s.w[58], s.w[59],
+              s.w[60], s.w[61], s.w[62], s.w[63],
+              extendvalue(s.w, 64, 64), extendvalue(s.w, 65, 64),
+              extendvalue(s.w, 66, 64), extendvalue(s.w, 67, 64),
+              extendvalue(s.w, 68, 64), extendvalue(s.w, 69, 64),
+              extendvalue(s.w, 70, 64), extendvalue(s.w, 71, 64),
+              extendvalue(s.w, 72, 64), extendvalue(s.w, 73, 64),
+              extendvalue(s.w, 74, 64), extendvalue(s.w, 75, 64),
+              extendvalue(s.w, 76, 64), extendvalue(s.w, 77, 64),
+              extendvalue(s.w, 78, 64), extendvalue(s.w, 79, 64) } };
+      }
+      constexpr schedule sha512extend(const schedule& s)
+      {
+        return sha512extend64(sha512extend48(sha512extend32(sha512extend16(s))));
+      }
+
+      // the compression function, in 80 rounds
+      constexpr uint64_t S1(uint64_t e)
+      {
+        return rotateR(e, 14) ^ rotateR(e, 18) ^ rotateR(e, 41);
+      }
+      constexpr uint64_t ch(uint64_t e, uint64_t f, uint64_t g)
+      {
+        return (e & f) ^ (~e & g);
+      }
+      constexpr uint64_t temp1(const sha512sum& sum, int i)
+      {
+        return sum.h[7] + S1(sum.h[4]) + ch(sum.h[4], sum.h[5], sum.h[6])
+          + roundconst[i];
+      }
+      constexpr uint64_t S0(uint64_t a)
+      {
+        return rotateR(a, 28) ^ rotateR(a, 34) ^ rotateR(a, 39);
+      }
+      constexpr uint64_t maj(uint64_t a, uint64_t b, uint64_t c)
+      {
+        return (a & b) ^ (a & c) ^ (b & c);
+      }
+      constexpr uint64_t temp2(const sha512sum& sum)
+      {
+        return S0(sum.h[0]) + maj(sum.h[0], sum.h[1], sum.h[2]);
+      }
+
+      // rotate sha512sums right and left (each round step does this)
+      constexpr sha512sum rotateCR(const sha512sum& sum)
+      {
+        return { { sum.h[7], sum.h[0], sum.h[1], sum.h[2],
+              sum.h[3], sum.h[4], sum.h[5], sum.h[6] } };
+      }
+      constexpr sha512sum rotateCL(const sha512sum& sum)
+      {
+        return { { sum.h[1], sum.h[2], sum.h[3], sum.h[4],
+              sum.h[5], sum.h[6], sum.h[7], sum.h[0] } };
+      }
+
+      constexpr sha512sum sha512round(const sha512sum& sum, uint64_t t1, uint64_t t2)
+      {
+        return { { sum.h[0], sum.h[1], sum.h[2], sum.h[3] + t1,
+              sum.h[4], sum.h[5], sum.h[6], t1 + t2 } };
+      }
+      constexpr sha512sum sha512compress(const sha512sum& sum, const schedule& s, int step)
+      {
+        return step == 80 ? sum :
+          rotateCL(
+              sha512compress(
+                  rotateCR(sha512round(sum, temp1(sum, step) + s.w[step], temp2(sum))),
+                  s, step + 1));
+      }
+
+      // the complete transform, for a message that is a multiple of 128 bytes
+      constexpr sha512sum sha512transform(const sha512sum& sum, const schedule& s)
+      {
+        return sumadd(sha512compress(sum, sha512extend(s), 0), sum);
+      }
+
+      // as sha256update: whole blocks, then the padding and length, which
+      // need an extra block when 112 bytes or more are left
+      constexpr sha512sum sha512update(const sha512sum& sum, const char* msg,
+                                       int len, uint64_t origlen)
+      {
+        return
+          len >= 128 ?
+          sha512update(sha512transform(sum, init(msg)), msg+128, len-128, origlen) :
+          len >= 112 ?
+          sha512update(sha512transform(
+                           sum, leftover(msg, len, origlen, 128)), msg+len, -1, origlen) :
+          sha512transform(sum, leftover(msg, len, origlen, 112));
+      }
+      constexpr sha512sum sha512withlen(const sha512sum& sum, const char* msg, int len)
+      {
+        return sha512update(sum, msg, len, static_cast<uint64_t>(len));
+      }
+
+      // convert a sha512sum to little-endian, and truncate it
+      constexpr sha512sum sha512tole(const sha512sum& sum)
+      {
+        return { {
+            endianswap(sum.h[0]), endianswap(sum.h[1]),
+              endianswap(sum.h[2]), endianswap(sum.h[3]),
+              endianswap(sum.h[4]), endianswap(sum.h[5]),
+              endianswap(sum.h[6]), endianswap(sum.h[7]),
+          } };
+      }
+      constexpr sha384sum sha384truncate(const sha512sum& sum)
+      {
+        return { { sum.h[0], sum.h[1], sum.h[2], sum.h[3], sum.h[4], sum.h[5] } };
+      }
+      constexpr sha512_256sum sha512_256truncate(const sha512sum& sum)
+      {
+        return { { sum.h[0], sum.h[1], sum.h[2], sum.h[3] } };
+      }
+    }
+  }
+
+  // runtime version (see cx_runtime.h): the same schedules and round
+  // functions, but iterating over the rounds and blocks rather than recursing
+  namespace runtime
+  {
+    // the 80 rounds of the compression function, given the extended schedule
+    // with the round constants already added in (wk[i] = roundconst[i] + w[i])
+    inline void sha512rounds(sha512sum& sum, const uint64_t* wk)
+    {
+      using namespace detail::sha512;
+      uint64_t a = sum.h[0];
+      uint64_t b = sum.h[1];
+      uint64_t c = sum.h[2];
+      uint64_t d = sum.h[3];
+      uint64_t e = sum.h[4];
+      uint64_t f = sum.h[5];
+      uint64_t g = sum.h[6];
+      uint64_t h = sum.h[7];
+      for (int i = 0; i < 80; ++i)
+      {
+        const uint64_t t1 = h + S1(e) + ch(e, f, g) + wk[i];
+        const uint64_t t2 = S0(a) + maj(a, b, c);
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+      }
+      sum.h[0] += a;
+      sum.h[1] += b;
+      sum.h[2] += c;
+      sum.h[3] += d;
+      sum.h[4] += e;
+      sum.h[5] += f;
+      sum.h[6] += g;
+      sum.h[7] += h;
+    }
+
+    // the complete transform, for a schedule block (only the first 16 words of
+    // the schedule are used: the extension is done here)
+    inline void sha512transform(sha512sum& sum, const detail::sha512::schedule& s)
+    {
+      using namespace detail::sha512;
+      uint64_t w[80];
+      for (int i = 0; i < 16; ++i)
+      {
+        w[i] = s.w[i];
+      }
+      for (int i = 16; i < 80; ++i)
+      {
+        w[i] = w[i-16] + w[i-7] + s0(w[i-15]) + s1(w[i-2]);
+      }
+      for (int i = 0; i < 80; ++i)
+      {
+        w[i] += roundconst[i];
+      }
+      sha512rounds(sum, w);
+    }
+
+    //--------------------------------------------------------------------------
+    // block functions: transform nblocks consecutive 128-byte blocks of a
+    // message. sha512blocks picks the fastest one for this cpu (see
+    // cx_cpuid.h)
+
+    inline void sha512blocks_scalar(sha512sum& sum, const char* data, size_t nblocks)
+    {
+      for (; nblocks > 0; --nblocks, data += 128)
+      {
+        sha512transform(sum, detail::sha512::init(data));
+      }
+    }
+
+#if CX_X86_SIMD
+    namespace detail_sha512
+    {
+      // loads without telling the compiler that char data is aligned
+      __attribute__((target("sse2")))
+      inline __m128i load128(const void* p)
+      {
+        return _mm_loadu_si128(static_cast<const __m128i*>(p));
+      }
+      __attribute__((target("sse2")))
+      inline void store128(void* p, __m128i x)
+      {
+        _mm_storeu_si128(static_cast<__m128i*>(p), x);
+      }
+
+      // byte order shuffle for big-endian words
+      __attribute__((target("ssse3")))
+      inline __m128i bswap64(__m128i x)
+      {
+        return _mm_shuffle_epi8(
+            x, _mm_set_epi64x(0x08090a0b0c0d0e0fll, 0x0001020304050607ll));
+      }
+
+      // two steps of the message schedule: w[t..t+1] depend only on words up
+      // to w[t-1], so unlike sha-256 neither waits on the other. The words are
+      // read back from memory with unaligned loads, which is cheaper than
+      // shuffling a window of registers.
+      __attribute__((target("ssse3")))
+      inline __m128i rotr(__m128i x, int n)
+      {
+        return _mm_or_si128(_mm_srli_epi64(x, n), _mm_slli_epi64(x, 64-n));
+      }
+      __attribute__((target("ssse3")))
+      inline __m128i s0(__m128i x)
+      {
+        return _mm_xor_si128(_mm_xor_si128(rotr(x, 1), rotr(x, 8)),
+                             _mm_srli_epi64(x, 7));
+      }
+      __attribute__((target("ssse3")))
+      inline __m128i s1(__m128i x)
+      {
+        return _mm_xor_si128(_mm_xor_si128(rotr(x, 19), rotr(x, 61)),
+                             _mm_srli_epi64(x, 6));
+      }
+      __attribute__((target("ssse3")))
+      inline __m128i extend2(const uint64_t* w)
+      {
+        return _mm_add_epi64(
+            _mm_add_epi64(load128(w - 16), s0(load128(w - 15))),
+            _mm_add_epi64(load128(w - 7), s1(load128(w - 2))));
+      }
+
+      // the same for two blocks at once, one in each 128-bit lane (x points to
+      // the vector holding w[t-16..t-15] of both)
+      __attribute__((target("avx2")))
+      inline __m256i rotr(__m256i x, int n)
+      {
+        return _mm256_or_si256(_mm256_srli_epi64(x, n), _mm256_slli_epi64(x, 64-n));
+      }
+      __attribute__((target("avx2")))
+      inline __m256i s0(__m256i x)
+      {
+        return _mm256_xor_si256(_mm256_xor_si256(rotr(x, 1), rotr(x, 8)),
+                                _mm256_srli_epi64(x, 7));
+      }
+      __attribute__((target("avx2")))
+      inline __m256i s1(__m256i x)
+      {
+        return _mm256_xor_si256(_mm256_xor_si256(rotr(x, 19), rotr(x, 61)),
+                                _mm256_srli_epi64(x, 6));
+      }
+      __attribute__((target("avx2")))
+      inline __m256i extend2(const __m256i* x)
+      {
+        return _mm256_add_epi64(
+            _mm256_add_epi64(x[0], s0(_mm256_alignr_epi8(x[1], x[0], 8))),
+            _mm256_add_epi64(_mm256_alignr_epi8(x[5], x[4], 8), s1(x[7])));
+      }
+    }
+
+    // ssse3: the message schedule two words at a time, scalar rounds
+    __attribute__((target("ssse3")))
+    inline void sha512blocks_ssse3(sha512sum& sum, const char* data, size_t nblocks)
+    {
+      using namespace detail_sha512;
+      const uint64_t* k = detail::sha512::roundconst;
+      alignas(16) uint64_t wk[80];
+      alignas(16) uint64_t w[80];
+      for (; nblocks > 0; --nblocks, data += 128)
+      {
+        for (int i = 0; i < 80; i += 2)
+        {
+          const __m128i x = i < 16 ? bswap64(load128(data + 8*i)) : extend2(w + i);
+          store128(w + i, x);
+          store128(wk + i, _mm_add_epi64(x, load128(k + i)));
+        }
+        sha512rounds(sum, wk);
+      }
+    }
+
+    // avx2: the message schedules of two blocks at once, scalar rounds
+    __attribute__((target("avx2")))
+    inline void sha512blocks_avx2(sha512sum& sum, const char* data, size_t nblocks)
+    {
+      using namespace detail_sha512;
+      const uint64_t* k = detail::sha512::roundconst;
+      alignas(32) uint64_t wk[2][80];
+      const __m256i swap = _mm256_broadcastsi128_si256(
+          _mm_set_epi64x(0x08090a0b0c0d0e0fll, 0x0001020304050607ll));
+      __m256i x[40];
+      for (; nblocks >= 2; nblocks -= 2, data += 256)
+      {
+        for (int i = 0; i < 80; i += 2)
+        {
+          const __m256i t = i < 16 ?
+            _mm256_shuffle_epi8(
+                _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(load128(data + 8*i)),
+                    load128(data + 128 + 8*i), 1),
+                swap) :
+            extend2(x + i/2 - 8);
+          x[i/2] = t;
+          const __m256i v = _mm256_add_epi64(
+              t, _mm256_broadcastsi128_si256(load128(k + i)));
+          store128(&wk[0][i], _mm256_castsi256_si128(v));
+          store128(&wk[1][i], _mm256_extracti128_si256(v, 1));
+        }
+        sha512rounds(sum, wk[0]);
+        sha512rounds(sum, wk[1]);
+      }
+      if (nblocks > 0)
+      {
+        sha512blocks_ssse3(sum, data, nblocks);
+      }
+    }
+#endif
+
+    using sha512blocks_fn = void (*)(sha512sum&, const char*, size_t);
+
+    inline sha512blocks_fn sha512blocks_select()
+    {
+#if CX_X86_SIMD
+      const cpu_features& f = cpu();
+      return f.avx2 ? sha512blocks_avx2 :
+        f.ssse3 ? sha512blocks_ssse3 :
+        sha512blocks_scalar;
+#else
+      return sha512blocks_scalar;
+#endif
+    }
+
+    inline void sha512blocks(sha512sum& sum, const char* data, size_t nblocks)
+    {
+      static const sha512blocks_fn f = sha512blocks_select();
+      f(sum, data, nblocks);
+    }
+
+    // the last two conditions of sha512update: the final (less than 128-byte)
+    // piece of the message, padded and followed by the length
+    inline sha512sum sha512final(sha512sum sum, const char* msg,
+                                 int len, uint64_t origlen)
+    {
+      if (len >= 112)
+      {
+        sha512transform(sum, detail::sha512::leftover(msg, len, origlen, 128));
+        sha512transform(sum, detail::sha512::leftover(msg+len, -1, origlen, 112));
+      }
+      else
+      {
+        sha512transform(sum, detail::sha512::leftover(msg, len, origlen, 112));
+      }
+      return detail::sha512::sha512tole(sum);
+    }
+
+    // the whole message, from a given initial state
+    inline sha512sum sha512withinit(sha512sum sum, const char* s, size_t len)
+    {
+      sha512blocks(sum, s, len / 128);
+      return sha512final(sum, s + (len & ~size_t{127}), static_cast<int>(len & 127), len);
+    }
+
+    inline sha512sum sha512(const char* s, size_t len)
+    {
+      return sha512withinit(detail::sha512::init(), s, len);
+    }
+    inline sha512sum sha512(const char* s)
+    {
+      return sha512(s, static_cast<size_t>(strlen(s)));
+    }
+
+    inline sha384sum sha384(const char* s, size_t len)
+    {
+      return detail::sha512::sha384truncate(
+          sha512withinit(detail::sha512::init384(), s, len));
+    }
+    inline sha384sum sha384(const char* s)
+    {
+      return sha384(s, static_cast<size_t>(strlen(s)));
+    }
+
+    inline sha512_256sum sha512_256(const char* s, size_t len)
+    {
+      return detail::sha512::sha512_256truncate(
+          sha512withinit(detail::sha512::init512_256(), s, len));
+    }
+    inline sha512_256sum sha512_256(const char* s)
+    {
+      return sha512_256(s, static_cast<size_t>(strlen(s)));
+    }
+  }
+
+  constexpr sha512sum sha512(const char* s)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::sha512::sha512tole(
+          detail::sha512::sha512withlen(detail::sha512::init(), s, strlen(s))) :
+      CX_RUNTIME_DISPATCH(runtime::sha512(s), err::sha512_runtime_error);
+  }
+  // (the overloads with a length take buffers that may contain NUL bytes)
+  constexpr sha512sum sha512(const char* s, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::sha512::sha512tole(
+          detail::sha512::sha512withlen(detail::sha512::init(), s,
+                                        static_cast<int>(len))) :
+      CX_RUNTIME_DISPATCH(runtime::sha512(s, len), err::sha512_runtime_error);
+  }
+
+  constexpr sha384sum sha384(const char* s)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::sha512::sha384truncate(detail::sha512::sha512tole(
+          detail::sha512::sha512withlen(detail::sha512::init384(), s, strlen(s)))) :
+      CX_RUNTIME_DISPATCH(runtime::sha384(s), err::sha384_runtime_error);
+  }
+  constexpr sha384sum sha384(const char* s, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::sha512::sha384truncate(detail::sha512::sha512tole(
+          detail::sha512::sha512withlen(detail::sha512::init384(), s,
+                                        static_cast<int>(len)))) :
+      CX_RUNTIME_DISPATCH(runtime::sha384(s, len), err::sha384_runtime_error);
+  }
+
+  constexpr sha512_256sum sha512_256(const char* s)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::sha512::sha512_256truncate(detail::sha512::sha512tole(
+          detail::sha512::sha512withlen(detail::sha512::init512_256(), s,
+                                        strlen(s)))) :
+      CX_RUNTIME_DISPATCH(runtime::sha512_256(s), err::sha512_256_runtime_error);
+  }
+  constexpr sha512_256sum sha512_256(const char* s, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::sha512::sha512_256truncate(detail::sha512::sha512tole(
+          detail::sha512::sha512withlen(detail::sha512::init512_256(), s,
+                                        static_cast<int>(len)))) :
+      CX_RUNTIME_DISPATCH(runtime::sha512_256(s, len), err::sha512_256_runtime_error);
+  }
+}
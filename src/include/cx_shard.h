@@ -0,0 +1,154 @@
+#pragma once
+
+#include "cx_fnv1.h"
+#include "cx_murmur3.h"
+#include "cx_utils.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+//----------------------------------------------------------------------------
+// consistent hashing: Jump Consistent Hash and weighted rendezvous hashing
+//
+// Both map a 64-bit key (a hash of the real key, e.g. its fnv1a) to one of n
+// shards so that changing n moves only about 1/n of the keys.
+//
+// jump_consistent_hash (Lamping and Veach, https://arxiv.org/abs/1406.2294)
+// needs no table at all, but the shards must be numbered 0..n-1 and can only be
+// added or removed at the end:
+//
+//   auto shard = cx::jump_consistent_hash(cx::fnv1a(key, len), 16);
+//
+// Rendezvous (highest random weight) hashing scores every node against the key
+// and picks the best, so any node can be removed (only its keys move), and
+// nodes can be weighted. The node table is built at compile time, each node
+// identified by the fnv1a of its name:
+//
+//   constexpr cx::shard_node nodes[] = {
+//     { "cache-a", 1.0 }, { "cache-b", 1.0 }, { "cache-c", 2.0 } };
+//   auto node = cx::rendezvous_hash(cx::fnv1a(key, len), nodes);
+//
+// A node's score is -weight / ln(u), where u in (0,1) comes from the murmur3
+// 64-bit finalizer of the key xor the node's id. The logarithm is computed here
+// (an exponent and a short series) rather than by libm, so every process
+// routes a key identically, and the same code runs at compile time. A lookup
+// allocates nothing and compares scores without branching on them; it costs
+// O(n), with one division per node. The rendezvous functions use C++14 constexpr loops.
+
+namespace cx
+{
+  namespace detail
+  {
+    namespace jump
+    {
+      constexpr int64_t buckets(uint64_t key, int64_t b, int64_t j, int32_t n);
+
+      // the next bucket the key jumps to, from its LCG state
+      constexpr int64_t step(uint64_t key, int64_t b, int32_t n)
+      {
+        return buckets(key, b,
+                       static_cast<int64_t>(static_cast<double>(b + 1)
+                                            * (static_cast<double>(int64_t{1} << 31)
+                                               / static_cast<double>((key >> 33) + 1))),
+                       n);
+      }
+      constexpr int64_t buckets(uint64_t key, int64_t b, int64_t j, int32_t n)
+      {
+        return j < n ? step(key * 2862933555777941757ull + 1, j, n) : b;
+      }
+    }
+  }
+
+  // The bucket in [0, buckets) for key; buckets must be positive. The
+  // recursion depth is about ln(buckets), so (unlike the string hashes) this
+  // also runs as is at runtime.
+  constexpr int32_t jump_consistent_hash(uint64_t key, int32_t buckets)
+  {
+    return assert(buckets > 0),
+      static_cast<int32_t>(detail::jump::buckets(key, -1, 0, buckets));
+  }
+
+  //----------------------------------------------------------------------------
+  // weighted rendezvous hashing
+
+  struct shard_node
+  {
+    // a node named by a string (at runtime, this requires CX_RUNTIME: see
+    // cx_runtime.h)
+    constexpr shard_node(const char* name, double w = 1.0)
+      : id(fnv1a(name)), weight(w)
+    {}
+    constexpr shard_node(uint64_t i, double w = 1.0)
+      : id(i), weight(w)
+    {}
+
+    uint64_t id;
+    double weight;
+  };
+
+  namespace detail
+  {
+    namespace rendezvous
+    {
+      constexpr double ln2 = 0.6931471805599453;
+
+      // floor(log2(x)) for x > 0 (the builtin is a constant expression in
+      // clang and gcc, and one instruction at runtime)
+      constexpr int ilog2(uint64_t x)
+      {
+        return 63 - __builtin_clzll(x);
+      }
+
+      // -ln(u) for u = x / 2^53, with x odd and below 2^53. Write x = m * 2^e
+      // with m in [1,2); then -ln(u) = (53 - e) ln 2 - ln(m), and with
+      // t = (m-1)/(m+1) < 1/3, ln(m) = 2(t + t^3/3 + ... + t^9/9) to within
+      // 1e-6 relative, which is far below the sampling noise of any weight.
+      constexpr double neglog(uint64_t x)
+      {
+        const int e = ilog2(x);
+        const double m = static_cast<double>(x << (52 - e)) * (1.0 / 4503599627370496.0);
+        const double t = (m - 1.0) / (m + 1.0);
+        const double t2 = t * t;
+        const double lnm =
+          2.0 * t * (1.0 + t2 * (1.0 / 3 + t2 * (1.0 / 5 + t2 * (1.0 / 7 + t2 * (1.0 / 9)))));
+        return (53 - e) * ln2 - lnm;
+      }
+
+      // the key's random point for node id, as an odd 53-bit integer
+      constexpr uint64_t point(uint64_t key, uint64_t id)
+      {
+        return (murmur::fmix64(key ^ id) >> 11) | 1;
+      }
+    }
+  }
+
+  // The index of the node with the highest score for key: nodes[i] scores
+  // weight_i / -ln(u_i), and the winner is the greatest. Comparing
+  // w_i / d_i > w_best / d_best as w_i * d_best > w_best * d_i avoids a
+  // division per node. Ties go to the lower index. There must be at least one
+  // node.
+  constexpr size_t rendezvous_hash(uint64_t key, const shard_node* nodes, size_t n)
+  {
+    assert(n > 0);
+    size_t best = 0;
+    double w = nodes[0].weight;
+    double d = detail::rendezvous::neglog(detail::rendezvous::point(key, nodes[0].id));
+    for (size_t i = 1; i < n; ++i)
+    {
+      const double wi = nodes[i].weight;
+      const double di = detail::rendezvous::neglog(detail::rendezvous::point(key, nodes[i].id));
+      const bool better = wi * d > w * di;
+      best = better ? i : best;
+      w = better ? wi : w;
+      d = better ? di : d;
+    }
+    return best;
+  }
+
+  template <size_t N>
+  constexpr size_t rendezvous_hash(uint64_t key, const shard_node (&nodes)[N])
+  {
+    return rendezvous_hash(key, nodes, N);
+  }
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include "cx_fnv1.h"
+#include "cx_pcg32.h"
+#include "cx_utils.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+//----------------------------------------------------------------------------
+// constexpr keyed hashing: SipHash-2-4 and SipHash-1-3
+// see https://www.aumasson.jp/siphash/siphash.pdf
+//
+// SipHash is a keyed hash: without the 128-bit key, an attacker can't choose
+// keys that collide, so a hash table using it can't be flooded. The key is
+// usually drawn at process start; cx_siphash_key (below) instead draws it at
+// compile time from pcg32, seeded differently on every build:
+//
+//   constexpr cx::siphash_key key = cx_siphash_key;
+//   auto h = cx::siphash13(key, s, len);
+//
+// Like cx_guid, cx_siphash_key differs per line and per compile, so a table
+// must hash through a single key object rather than expanding the macro in
+// more than one place. SipHash-1-3 (one compression round and three
+// finalization rounds) is the faster variant used by hash tables;
+// SipHash-2-4 is the original.
+//
+// cx_siphash_key is not a secret. Its only inputs are the file name, the
+// line, and the build date and time, and the key itself is a constant in the
+// binary: anyone with the binary can read it, anyone who knows roughly when it
+// was built can guess it, and reproducible builds (which pin __DATE__ and
+// __TIME__, e.g. through SOURCE_DATE_EPOCH) give every build the same key. It
+// only varies hashing between builds. Where an attacker can choose the keys
+// hashed, draw the key at runtime from real entropy (e.g. std::random_device
+// or the OS) and pass the 16 bytes to make_siphash_key.
+
+namespace cx
+{
+  namespace err
+  {
+    namespace
+    {
+      CX_ERROR_SYMBOL(siphash_runtime_error);
+    }
+  }
+
+  struct siphash_key
+  {
+    uint64_t k0;
+    uint64_t k1;
+  };
+
+  // a key from 16 bytes, as in the reference implementation
+  constexpr siphash_key make_siphash_key(const char* k)
+  {
+    return { word64le(k), word64le(k+8) };
+  }
+
+  // a key drawn from pcg32, seeded with S
+  template <uint64_t S>
+  constexpr siphash_key siphash_keygen()
+  {
+    return {
+      uint64_t{pcg::pcg32_output(pcg::pcg32_advance(S, 1))} << 32
+        | pcg::pcg32_output(pcg::pcg32_advance(S, 2)),
+      uint64_t{pcg::pcg32_output(pcg::pcg32_advance(S, 3))} << 32
+        | pcg::pcg32_output(pcg::pcg32_advance(S, 4)) };
+  }
+
+  namespace detail
+  {
+    namespace siphash
+    {
+      constexpr uint64_t rotl(uint64_t x, int r)
+      {
+        return (x << r) | (x >> (64 - r));
+      }
+
+      struct state
+      {
+        uint64_t v0, v1, v2, v3;
+      };
+
+      constexpr state init(const siphash_key& k)
+      {
+        return { k.k0 ^ 0x736f6d6570736575ull, k.k1 ^ 0x646f72616e646f6dull,
+            k.k0 ^ 0x6c7967656e657261ull, k.k1 ^ 0x7465646279746573ull };
+      }
+
+      // one SipRound, in four steps (each step's additions, then its
+      // rotations and xors)
+      constexpr state step4(const state& s)
+      {
+        return { s.v0, rotl(s.v1, 17) ^ s.v2, rotl(s.v2, 32), rotl(s.v3, 21) ^ s.v0 };
+      }
+      constexpr state step3(const state& s)
+      {
+        return step4({ s.v0 + s.v3, s.v1, s.v2 + s.v1, s.v3 });
+      }
+      constexpr state step2(const state& s)
+      {
+        return step3({ rotl(s.v0, 32), rotl(s.v1, 13) ^ s.v0, s.v2, rotl(s.v3, 16) ^ s.v2 });
+      }
+      constexpr state sipround(const state& s)
+      {
+        return step2({ s.v0 + s.v1, s.v1, s.v2 + s.v3, s.v3 });
+      }
+      constexpr state siprounds(const state& s, int n)
+      {
+        return n == 0 ? s : siprounds(sipround(s), n - 1);
+      }
+
+      // absorb one message word m with C rounds
+      constexpr state absorb(const state& s, uint64_t m)
+      {
+        return { s.v0 ^ m, s.v1, s.v2, s.v3 };
+      }
+      template <int C>
+      constexpr state compress(const state& s, uint64_t m)
+      {
+        return absorb(siprounds({ s.v0, s.v1, s.v2, s.v3 ^ m }, C), m);
+      }
+
+      // as with fnv, recurse in chunks to bound the recursion depth
+      struct lanes
+      {
+        state v;
+        const char* s;
+        size_t len;
+      };
+      template <int C>
+      constexpr lanes words(const lanes& l, int maxdepth)
+      {
+        return l.len < 8 || maxdepth == 0 ? l :
+          words<C>({ compress<C>(l.v, word64le(l.s)), l.s + 8, l.len - 8 }, maxdepth - 1);
+      }
+      template <int C>
+      constexpr lanes words_bychunk(const lanes& l)
+      {
+        return l.len < 8 ? l : words_bychunk<C>(words<C>(l, 256));
+      }
+
+      constexpr uint64_t fold(const state& s)
+      {
+        return s.v0 ^ s.v1 ^ s.v2 ^ s.v3;
+      }
+      template <int D>
+      constexpr uint64_t finalize(const state& s)
+      {
+        return fold(siprounds({ s.v0, s.v1, s.v2 ^ 0xff, s.v3 }, D));
+      }
+      // the last word holds the remaining 0-7 bytes, with the length (mod
+      // 256) in its top byte
+      constexpr uint64_t lastword(const char* s, size_t rem, size_t len)
+      {
+        return word64le(s, static_cast<int>(rem)) | uint64_t{len & 0xff} << 56;
+      }
+      template <int C, int D>
+      constexpr uint64_t last(const lanes& l, size_t len)
+      {
+        return finalize<D>(compress<C>(l.v, lastword(l.s, l.len, len)));
+      }
+
+      template <int C, int D>
+      constexpr uint64_t siphash(const siphash_key& k, const char* s, size_t len)
+      {
+        return last<C, D>(words_bychunk<C>({ init(k), s, len }), len);
+      }
+    }
+  }
+
+  // runtime versions (see cx_runtime.h)
+  namespace runtime
+  {
+    namespace detail_siphash
+    {
+      inline void siprounds(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3, int n)
+      {
+        using detail::siphash::rotl;
+        for (int i = 0; i < n; ++i)
+        {
+          v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+          v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+          v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+          v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+        }
+      }
+    }
+
+    // the state is four locals, so it stays in registers
+    template <int C, int D>
+    inline uint64_t siphash(const siphash_key& k, const char* s, size_t len)
+    {
+      uint64_t v0 = k.k0 ^ 0x736f6d6570736575ull;
+      uint64_t v1 = k.k1 ^ 0x646f72616e646f6dull;
+      uint64_t v2 = k.k0 ^ 0x6c7967656e657261ull;
+      uint64_t v3 = k.k1 ^ 0x7465646279746573ull;
+
+      const char* const end = s + (len & ~size_t{7});
+      for (; s != end; s += 8)
+      {
+        const uint64_t m = load64le(s);
+        v3 ^= m;
+        detail_siphash::siprounds(v0, v1, v2, v3, C);
+        v0 ^= m;
+      }
+      char tail[8] = {};
+      if ((len & 7) > 0) std::memcpy(tail, s, len & 7);
+      const uint64_t m = load64le(tail) | uint64_t{len & 0xff} << 56;
+      v3 ^= m;
+      detail_siphash::siprounds(v0, v1, v2, v3, C);
+      v0 ^= m;
+
+      v2 ^= 0xff;
+      detail_siphash::siprounds(v0, v1, v2, v3, D);
+      return v0 ^ v1 ^ v2 ^ v3;
+    }
+
+    inline uint64_t siphash24(const siphash_key& k, const char* s, size_t len)
+    {
+      return siphash<2, 4>(k, s, len);
+    }
+    inline uint64_t siphash13(const siphash_key& k, const char* s, size_t len)
+    {
+      return siphash<1, 3>(k, s, len);
+    }
+  }
+
+  // (the overloads with a length take buffers that may contain NUL bytes)
+  constexpr uint64_t siphash24(const siphash_key& k, const char* s)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::siphash::siphash<2, 4>(k, s, static_cast<size_t>(strlen(s))) :
+      CX_RUNTIME_DISPATCH(runtime::siphash24(k, s, static_cast<size_t>(strlen(s))),
+                          err::siphash_runtime_error);
+  }
+  constexpr uint64_t siphash24(const siphash_key& k, const char* s, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::siphash::siphash<2, 4>(k, s, len) :
+      CX_RUNTIME_DISPATCH(runtime::siphash24(k, s, len), err::siphash_runtime_error);
+  }
+
+  constexpr uint64_t siphash13(const siphash_key& k, const char* s)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::siphash::siphash<1, 3>(k, s, static_cast<size_t>(strlen(s))) :
+      CX_RUNTIME_DISPATCH(runtime::siphash13(k, s, static_cast<size_t>(strlen(s))),
+                          err::siphash_runtime_error);
+  }
+  constexpr uint64_t siphash13(const siphash_key& k, const char* s, size_t len)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::siphash::siphash<1, 3>(k, s, len) :
+      CX_RUNTIME_DISPATCH(runtime::siphash13(k, s, len), err::siphash_runtime_error);
+  }
+}
+
+// a siphash_key drawn at compile time, seeded differently on every compile and
+// on every line; predictable, and a constant in the binary (see above)
+#define cx_siphash_key cx::siphash_keygen<cx::fnv1(__FILE__ __DATE__ __TIME__) + __LINE__>()
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "cx_murmur3.h"
+#include "cx_utils.h"
+
+#include <cstddef>
+#include <cstdint>
+
+//----------------------------------------------------------------------------
+// constexpr Bloom filter
+//
+// A static_bloom<Bits, K> is built at compile time from a list of strings.
+// A lookup answers "definitely not in the list" or "possibly in the list",
+// with a false positive rate that falls as Bits grows relative to the
+// number of keys:
+//
+//   constexpr const char* blocked[] = { "curl", "wget", "python-requests" };
+//   constexpr auto bloom = cx::make_static_bloom<1024, 4>(blocked);
+//   if (bloom.might_contain(agent)) { ...do the exact check... }
+//
+// The filter is blocked: the bits are split into 512-bit (64-byte, one cache
+// line) blocks, and each key sets K bits in a single block. The first hash
+// (murmur3_32 with one seed) picks the block. The second (murmur3_32 with
+// another seed) gives the start and step of K probes within the block, as in
+// double hashing. A lookup therefore reads one cache line, and on a miss it
+// usually stops at the first clear bit. Building uses C++14 constexpr loops.
+
+namespace cx
+{
+  namespace detail
+  {
+    namespace bloom
+    {
+      constexpr uint32_t seed1 = 0x9747b28cu;
+      constexpr uint32_t seed2 = 0x85ebca6bu;
+
+      constexpr size_t block_bits = 512;
+      constexpr size_t block_words = block_bits / 64;
+
+      // the first word of the key's block (by multiply-shift, so the number
+      // of blocks needn't be a power of 2)
+      constexpr size_t block(uint32_t h1, size_t nblocks)
+      {
+        return static_cast<size_t>((uint64_t{h1} * nblocks) >> 32) * block_words;
+      }
+      // bit i of a key within its block
+      constexpr size_t probe(uint32_t h2, size_t i)
+      {
+        return (h2 + i * ((h2 >> 9) | 1)) & (block_bits - 1);
+      }
+    }
+  }
+
+  template <size_t Bits, size_t K>
+  class static_bloom
+  {
+    static_assert(Bits > 0 && Bits % detail::bloom::block_bits == 0,
+                  "static_bloom bits must be a multiple of 512");
+    static_assert(K > 0, "static_bloom must set at least one bit per key");
+
+    static constexpr size_t B = Bits / detail::bloom::block_bits;
+
+  public:
+    template <size_t N>
+    constexpr static_bloom(const char* const (&keys)[N])
+      : m_words{}
+    {
+      for (size_t k = 0; k < N; ++k)
+      {
+        insert(keys[k], static_cast<size_t>(strlen(keys[k])));
+      }
+    }
+
+    constexpr size_t bits() const { return Bits; }
+    constexpr size_t hashes() const { return K; }
+
+    // false if s is certainly not one of the keys (at runtime, this requires
+    // CX_RUNTIME: see cx_runtime.h)
+    constexpr bool might_contain(const char* s) const
+    {
+      return might_contain(s, static_cast<size_t>(strlen(s)));
+    }
+    constexpr bool might_contain(const char* s, size_t len) const
+    {
+      return test(&m_words[detail::bloom::block(murmur3_32(s, len, detail::bloom::seed1), B)],
+                  murmur3_32(s, len, detail::bloom::seed2));
+    }
+
+  private:
+    constexpr void insert(const char* s, size_t len)
+    {
+      const size_t w = detail::bloom::block(murmur3_32(s, len, detail::bloom::seed1), B);
+      const uint32_t h2 = murmur3_32(s, len, detail::bloom::seed2);
+      for (size_t i = 0; i < K; ++i)
+      {
+        const size_t b = detail::bloom::probe(h2, i);
+        m_words[w + b / 64] |= uint64_t{1} << (b % 64);
+      }
+    }
+
+    static constexpr bool test(const uint64_t* block, uint32_t h2)
+    {
+      for (size_t i = 0; i < K; ++i)
+      {
+        const size_t b = detail::bloom::probe(h2, i);
+        if ((block[b / 64] & (uint64_t{1} << (b % 64))) == 0) return false;
+      }
+      return true;
+    }
+
+    alignas(64) uint64_t m_words[Bits / 64];
+  };
+
+  template <size_t Bits, size_t K, size_t N>
+  constexpr static_bloom<Bits, K> make_static_bloom(const char* const (&keys)[N])
+  {
+    return static_bloom<Bits, K>(keys);
+  }
+}
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "cx_algorithm.h"
+#include "cx_array.h"
+#include "cx_fnv1.h"
+#include "cx_murmur3.h"
+#include "cx_utils.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+//----------------------------------------------------------------------------
+// constexpr perfect-hash map
+//
+// The table is laid out at compile time by hash-and-displace: each key's hash
+// picks a bucket, and each bucket gets a small "pilot" value, found by search,
+// that moves all of its keys into free slots. A lookup is then one key hash,
+// one pilot load, one probe and one key comparison. Building the table uses
+// C++14 constexpr loops.
+
+namespace cx
+{
+  namespace err
+  {
+    namespace
+    {
+      CX_ERROR_SYMBOL(static_map_duplicate_key);
+      CX_ERROR_SYMBOL(static_map_build_error);
+      CX_ERROR_SYMBOL(static_map_key_error);
+    }
+  }
+
+  // Hash and equality for static_map keys: string keys (NUL-terminated) use
+  // fnv1a, integral keys the murmur3 64-bit finalizer
+  template <typename K, typename = void>
+  struct static_map_hash;
+
+  template <>
+  struct static_map_hash<const char*>
+  {
+    static constexpr uint64_t hash(const char* s) { return fnv1a(s); }
+    static constexpr bool equal(const char* a, const char* b)
+    {
+      return strcmp(a, b) == 0;
+    }
+  };
+
+  template <typename K>
+  struct static_map_hash<K, typename std::enable_if<std::is_integral<K>::value>::type>
+  {
+    static constexpr uint64_t hash(K k)
+    {
+      return detail::murmur::fmix64(static_cast<uint64_t>(k));
+    }
+    static constexpr bool equal(K a, K b) { return a == b; }
+  };
+
+  namespace detail
+  {
+    namespace smap
+    {
+      // one bucket per 4 keys on average; the table is at most half full
+      constexpr size_t bucket_count(size_t n)
+      {
+        return n / 4 + 1;
+      }
+      constexpr size_t pow2_at_least(size_t n, size_t p = 1)
+      {
+        return p >= n ? p : pow2_at_least(n, p * 2);
+      }
+      constexpr size_t table_size(size_t n)
+      {
+        return pow2_at_least(2 * n);
+      }
+
+      constexpr size_t bucket(uint64_t h, size_t nbuckets)
+      {
+        return static_cast<size_t>((h >> 32) % nbuckets);
+      }
+      constexpr size_t slot(uint64_t h, uint64_t pilot, size_t tsize)
+      {
+        return static_cast<size_t>(
+            murmur::fmix64(h ^ (pilot * 0x9e3779b97f4a7c15ull)) & (tsize - 1));
+      }
+
+      // the pilot for each bucket, and the key index in each slot (empty
+      // slots hold index 0, see below)
+      template <size_t N>
+      struct layout
+      {
+        uint16_t pilot[bucket_count(N)];
+        size_t index[table_size(N)];
+      };
+
+      template <typename H, typename K, typename V, size_t N>
+      constexpr layout<N> build(const pair<K, V> (&kv)[N])
+      {
+        constexpr size_t B = bucket_count(N);
+        constexpr size_t M = table_size(N);
+        layout<N> l{};
+
+        // hash the keys and group them by bucket: bucket b holds
+        // members[start[b]] to members[start[b+1]-1]
+        uint64_t h[N] = {};
+        size_t start[B+1] = {};
+        for (size_t i = 0; i < N; ++i)
+        {
+          h[i] = H::hash(kv[i].first);
+          ++start[bucket(h[i], B) + 1];
+        }
+        size_t maxsize = 0;
+        for (size_t b = 0; b < B; ++b)
+        {
+          if (start[b+1] > maxsize) maxsize = start[b+1];
+          start[b+1] += start[b];
+        }
+        size_t members[N] = {};
+        size_t fill[B] = {};
+        for (size_t i = 0; i < N; ++i)
+        {
+          const size_t b = bucket(h[i], B);
+          members[start[b] + fill[b]++] = i;
+        }
+
+        // keys with the same hash share a bucket, so duplicates are found
+        // within buckets
+        for (size_t b = 0; b < B; ++b)
+        {
+          for (size_t i = start[b]; i < start[b+1]; ++i)
+          {
+            for (size_t j = start[b]; j < i; ++j)
+            {
+              if (h[members[i]] == h[members[j]]
+                  && H::equal(kv[members[i]].first, kv[members[j]].first))
+              {
+                throw err::static_map_duplicate_key;
+              }
+            }
+          }
+        }
+
+        // place the biggest buckets first, while the table is emptiest
+        bool taken[M] = {};
+        for (size_t size = maxsize; size > 0; --size)
+        {
+          for (size_t b = 0; b < B; ++b)
+          {
+            if (start[b+1] - start[b] != size) continue;
+
+            uint64_t p = 0;
+            for (; p <= 0xffff; ++p)
+            {
+              bool ok = true;
+              for (size_t i = start[b]; ok && i < start[b+1]; ++i)
+              {
+                const size_t s = slot(h[members[i]], p, M);
+                ok = !taken[s];
+                for (size_t j = start[b]; ok && j < i; ++j)
+                {
+                  ok = s != slot(h[members[j]], p, M);
+                }
+              }
+              if (ok) break;
+            }
+            // only reachable if two different keys have the same hash
+            if (p > 0xffff) throw err::static_map_build_error;
+
+            l.pilot[b] = static_cast<uint16_t>(p);
+            for (size_t i = start[b]; i < start[b+1]; ++i)
+            {
+              const size_t s = slot(h[members[i]], p, M);
+              taken[s] = true;
+              l.index[s] = members[i];
+            }
+          }
+        }
+        return l;
+      }
+    }
+  }
+
+  // A fixed map from N keys to values, built at compile time from an array of
+  // key-value pairs. Declared constexpr (or static constexpr), the whole
+  // table is constant data. As with the other functions here, lookups at
+  // runtime require CX_RUNTIME.
+  template <typename K, typename V, size_t N, typename H = static_map_hash<K>>
+  class static_map
+  {
+    static_assert(N > 0, "static_map must have at least one key");
+
+    static constexpr size_t B = detail::smap::bucket_count(N);
+    static constexpr size_t M = detail::smap::table_size(N);
+
+  public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = pair<K, V>;
+
+    constexpr static_map(const value_type (&kv)[N])
+      : static_map(kv, detail::smap::build<H>(kv),
+                   std::make_index_sequence<B>(), std::make_index_sequence<M>())
+    {}
+
+    constexpr size_t size() const { return N; }
+
+    // a pointer to the value for key, or nullptr if key isn't in the map
+    constexpr const V* find(const K& key) const
+    {
+      return find(key, (m_entries.begin() + slot(H::hash(key))));
+    }
+
+    constexpr bool contains(const K& key) const
+    {
+      return find(key) != nullptr;
+    }
+
+    // the value for key, which must be in the map
+    constexpr const V& at(const K& key) const
+    {
+      return find(key) ? *find(key) : throw err::static_map_key_error;
+    }
+
+  private:
+    template <size_t ...Bs, size_t ...Ss>
+    constexpr static_map(const value_type (&kv)[N],
+                         const detail::smap::layout<N>& l,
+                         std::index_sequence<Bs...>, std::index_sequence<Ss...>)
+      : m_pilots{ l.pilot[Bs]... }
+      , m_entries{ kv[l.index[Ss]]... }
+    {}
+
+    constexpr size_t slot(uint64_t h) const
+    {
+      return detail::smap::slot(h, m_pilots[detail::smap::bucket(h, B)], M);
+    }
+
+    // An empty slot holds a copy of the first entry. That can't give a false
+    // match: the first key hashes to its own slot, never to an empty one.
+    constexpr const V* find(const K& key, const value_type* e) const
+    {
+      return H::equal(e->first, key) ? &e->second : nullptr;
+    }
+
+    array<uint16_t, B> m_pilots;
+    array<value_type, M> m_entries;
+  };
+
+  template <typename K, typename V, size_t N>
+  constexpr static_map<K, V, N> make_static_map(const pair<K, V> (&kv)[N])
+  {
+    return static_map<K, V, N>(kv);
+  }
+}
@@ -16,7 +16,7 @@ namespace cx
   {
     namespace
     {
-      extern const char* strenc_runtime_error;
+      CX_ERROR_SYMBOL(strenc_runtime_error);
     }
   }
 
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "cx_algorithm.h"
+#include "cx_fnv1.h"
+#include "cx_static_map.h"
+
+#include <cstddef>
+#include <utility>
+
+//----------------------------------------------------------------------------
+// switch on strings
+//
+// A string_switch numbers a fixed set of case strings. Calling it on a string
+// hashes the string once (fnv1a), finds the only case with that hash, and
+// confirms the match with a single strcmp, so it is exact. The result is the
+// index of the case (or size() for no match), suitable for a switch statement
+// whose labels are also computed at compile time:
+//
+//   constexpr auto verbs = cx::make_string_switch({ "GET", "PUT", "POST" });
+//   switch (verbs(s))
+//   {
+//     case verbs["GET"]: ...
+//     case verbs["PUT"]: ...
+//     default: ...
+//   }
+//
+// Cases whose hashes collide would be indistinguishable, so they are a compile
+// error, as is a label that isn't one of the cases.
+
+namespace cx
+{
+  namespace err
+  {
+    namespace
+    {
+      CX_ERROR_SYMBOL(string_switch_hash_collision);
+    }
+  }
+
+  namespace detail
+  {
+    namespace sswitch
+    {
+      // whether s[i] has a different hash from each of s[j], ..., s[n-1]
+      constexpr bool distinct_from(const char* const* s, size_t n, size_t i, size_t j)
+      {
+        return j >= n ||
+          (fnv1a(s[i]) != fnv1a(s[j]) && distinct_from(s, n, i, j + 1));
+      }
+      constexpr bool distinct_hashes(const char* const* s, size_t n, size_t i)
+      {
+        return i >= n ||
+          (distinct_from(s, n, i, i + 1) && distinct_hashes(s, n, i + 1));
+      }
+
+      template <size_t N>
+      struct numbered
+      {
+        pair<const char*, size_t> kv[N];
+      };
+
+      // pair each case with its index, checking that the hashes are distinct
+      template <size_t N, size_t ...Is>
+      constexpr numbered<N> number(const char* const (&s)[N], std::index_sequence<Is...>)
+      {
+        return distinct_hashes(s, N, 0) ?
+          numbered<N>{ { { s[Is], Is }... } } :
+          throw err::string_switch_hash_collision;
+      }
+    }
+  }
+
+  // true if no two of the strings have the same fnv1a hash (which includes no
+  // two being the same string)
+  template <size_t N>
+  constexpr bool distinct_hashes(const char* const (&s)[N])
+  {
+    return detail::sswitch::distinct_hashes(s, N, 0);
+  }
+
+  template <size_t N>
+  class string_switch
+  {
+  public:
+    constexpr string_switch(const char* const (&cases)[N])
+      : m_map(detail::sswitch::number(cases, std::make_index_sequence<N>()).kv)
+    {}
+
+    constexpr size_t size() const { return N; }
+
+    // the index of the case equal to s, or size() if there is none
+    constexpr size_t operator()(const char* s) const
+    {
+      return index(m_map.find(s));
+    }
+
+    // the index of a case string (for case labels)
+    constexpr size_t operator[](const char* c) const
+    {
+      return m_map.at(c);
+    }
+
+  private:
+    constexpr size_t index(const size_t* p) const
+    {
+      return p ? *p : N;
+    }
+
+    static_map<const char*, size_t, N> m_map;
+  };
+
+  template <size_t N>
+  constexpr string_switch<N> make_string_switch(const char* const (&cases)[N])
+  {
+    return string_switch<N>(cases);
+  }
+}
@@ -11,7 +11,7 @@ namespace cx
   {
     namespace
     {
-      extern const char* typeid_runtime_error;
+      CX_ERROR_SYMBOL(typeid_runtime_error);
     }
   }
 
@@ -1,6 +1,10 @@
 #pragma once
 
+#include "cx_runtime.h"
+
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 //----------------------------------------------------------------------------
 // constexpr utils
@@ -15,8 +19,8 @@ namespace cx
   {
     namespace
     {
-      extern const char* strlen_runtime_error;
-      extern const char* strcmp_runtime_error;
+      CX_ERROR_SYMBOL(strlen_runtime_error);
+      CX_ERROR_SYMBOL(strcmp_runtime_error);
     }
   }
   namespace detail_s
@@ -40,39 +44,85 @@ namespace cx
       return *p.s == 0 ? p :
         strlen_bychunk(stradd({0, p.len}, strlen({ p.s, 0 }, maxdepth)), maxdepth);
     }
+
+    constexpr int strcmp(const char* a, const char* b)
+    {
+      return *a == 0 && *b == 0 ? 0 :
+        *a == 0 ? -1 :
+        *b == 0 ? 1 :
+        *a < *b ? -1 :
+        *a > *b ? 1 :
+        *a == *b ? strcmp(a+1, b+1) :
+        throw err::strcmp_runtime_error;
+    }
+  }
+
+  // runtime versions (see cx_runtime.h)
+  namespace runtime
+  {
+    inline int strlen(const char* s)
+    {
+      return static_cast<int>(std::strlen(s));
+    }
+
+    // the same tri-state result as the constexpr version (which compares
+    // plain chars, not unsigned chars as std::strcmp does)
+    inline int strcmp(const char* a, const char* b)
+    {
+      while (*a != 0 && *a == *b)
+      {
+        ++a;
+        ++b;
+      }
+      return *a == *b ? 0 :
+        *a == 0 ? -1 :
+        *b == 0 ? 1 :
+        *a < *b ? -1 : 1;
+    }
   }
+
   // max recursion = 256 (strlen, especially of a long string, often happens at
   // the beginning of an algorithm, so that should be fine)
   constexpr int strlen(const char* s)
   {
-    return true ?
+    return CX_CONSTANT_EVALUATED() ?
       detail_s::strlen_bychunk(detail_s::strlen({s, 0}, 256), 256).len :
-      throw err::strlen_runtime_error;
+      CX_RUNTIME_DISPATCH(runtime::strlen(s), err::strlen_runtime_error);
   }
 
   constexpr int strcmp(const char* a, const char* b)
   {
-    return *a == 0 && *b == 0 ? 0 :
-      *a == 0 ? -1 :
-      *b == 0 ? 1 :
-      *a < *b ? -1 :
-      *a > *b ? 1 :
-      *a == *b ? strcmp(a+1, b+1) :
-      throw err::strcmp_runtime_error;
+    return CX_CONSTANT_EVALUATED() ? detail_s::strcmp(a, b) :
+      CX_RUNTIME_DISPATCH(runtime::strcmp(a, b), err::strcmp_runtime_error);
   }
   constexpr int strless(const char* a, const char* b)
   {
     return strcmp(a, b) == -1;
   }
 
+  // convert a char to uint32_t as the unsigned byte value (char may be signed,
+  // and sign extension would corrupt the other bytes of a word)
+  constexpr uint32_t byte32(char c)
+  {
+    return static_cast<uint32_t>(static_cast<unsigned char>(c));
+  }
+
+  // a run of bytes (which may contain NULs), for runtime functions that take
+  // several buffers at once
+  struct byte_view
+  {
+    const char* data;
+    size_t size;
+  };
+
   // convert char* buffer (fragment) to uint32_t (little-endian)
   constexpr uint32_t word32le(const char* s, int len)
   {
     return
-      (len > 0 ? static_cast<uint32_t>(s[0]) : 0)
-      + (len > 1 ? (static_cast<uint32_t>(s[1]) << 8) : 0)
-      + (len > 2 ? (static_cast<uint32_t>(s[2]) << 16) : 0)
-      + (len > 3 ? (static_cast<uint32_t>(s[3]) << 24) : 0);
+      (len > 0 ? byte32(s[0]) : 0)
+      + (len > 1 ? (byte32(s[1]) << 8) : 0)
+      + (len > 2 ? (byte32(s[2]) << 16) : 0)
+      + (len > 3 ? (byte32(s[3]) << 24) : 0);
   }
   // convert char* buffer (complete) to uint32_t (little-endian)
   constexpr uint32_t word32le(const char* s)
@@ -84,10 +134,10 @@ namespace cx
   constexpr uint32_t word32be(const char* s, int len)
   {
     return
-      (len > 0 ? (static_cast<uint32_t>(s[0]) << 24) : 0)
-      + (len > 1 ? (static_cast<uint32_t>(s[1]) << 16) : 0)
-      + (len > 2 ? (static_cast<uint32_t>(s[2]) << 8) : 0)
-      + (len > 3 ? static_cast<uint32_t>(s[3]) : 0);
+      (len > 0 ? (byte32(s[0]) << 24) : 0)
+      + (len > 1 ? (byte32(s[1]) << 16) : 0)
+      + (len > 2 ? (byte32(s[2]) << 8) : 0)
+      + (len > 3 ? byte32(s[3]) : 0);
   }
   // convert char* buffer (complete) to uint32_t (big-endian)
   constexpr uint32_t word32be(const char* s)
@@ -95,6 +145,132 @@ namespace cx
     return word32be(s, 4);
   }
 
+  // convert char* buffer (fragment) to uint64_t (little-endian)
+  constexpr uint64_t word64le(const char* s, int len)
+  {
+    return static_cast<uint64_t>(word32le(s, len))
+      | (static_cast<uint64_t>(word32le(len > 4 ? s+4 : s, len-4)) << 32);
+  }
+  // convert char* buffer (complete) to uint64_t (little-endian)
+  constexpr uint64_t word64le(const char* s)
+  {
+    return word64le(s, 8);
+  }
+
+  // convert char* buffer (fragment) to uint64_t (big-endian)
+  constexpr uint64_t word64be(const char* s, int len)
+  {
+    return (static_cast<uint64_t>(word32be(s, len)) << 32)
+      | static_cast<uint64_t>(word32be(len > 4 ? s+4 : s, len-4));
+  }
+  // convert char* buffer (complete) to uint64_t (big-endian)
+  constexpr uint64_t word64be(const char* s)
+  {
+    return word64be(s, 8);
+  }
+
+  namespace runtime
+  {
+    // word32le for runtime use: a single unaligned load on little-endian
+    // targets
+    inline uint32_t load32le(const char* s)
+    {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+      uint32_t w;
+      std::memcpy(&w, s, sizeof(w));
+      return w;
+#else
+      return word32le(s);
+#endif
+    }
+    // and word64le
+    inline uint64_t load64le(const char* s)
+    {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+      uint64_t w;
+      std::memcpy(&w, s, sizeof(w));
+      return w;
+#else
+      return word64le(s);
+#endif
+    }
+    // and the reverse: store w little-endian
+    inline void store64le(char* s, uint64_t w)
+    {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+      std::memcpy(s, &w, sizeof(w));
+#else
+      for (size_t i = 0; i < 8; ++i)
+      {
+        s[i] = static_cast<char>(w >> (8 * i));
+      }
+#endif
+    }
+
+    // Incremental hashing with a 64-byte block function (md5_ctx, sha256_ctx).
+    // Whole blocks are transformed directly from the input; only a partial
+    // block is buffered between calls. Init gives the initial state, Blocks
+    // transforms whole blocks, and Final pads the partial block and gives the
+    // digest.
+    template <typename Sum, Sum (*Init)(),
+              void (*Blocks)(Sum&, const char*, size_t),
+              Sum (*Final)(Sum, const char*, int, uint64_t)>
+    class block_buffer
+    {
+    public:
+      block_buffer() { init(); }
+
+      // reset to the initial state
+      void init()
+      {
+        m_sum = Init();
+        m_buflen = 0;
+        m_len = 0;
+      }
+
+      void update(const void* data, size_t len)
+      {
+        // data may be null when there is none
+        if (len == 0) return;
+        const char* p = static_cast<const char*>(data);
+        m_len += len;
+
+        // top up a partial block first
+        if (m_buflen > 0)
+        {
+          const size_t n = len < 64 - m_buflen ? len : 64 - m_buflen;
+          std::memcpy(m_buf + m_buflen, p, n);
+          m_buflen += n;
+          p += n;
+          len -= n;
+          if (m_buflen < 64) return;
+          Blocks(m_sum, m_buf, 1);
+          m_buflen = 0;
+        }
+
+        Blocks(m_sum, p, len / 64);
+        p += len & ~size_t{63};
+        len &= 63;
+
+        std::memcpy(m_buf, p, len);
+        m_buflen = len;
+      }
+
+      // the digest of everything so far; the context is unchanged, so more
+      // data may be added afterwards
+      Sum final() const
+      {
+        return Final(m_sum, m_buf, static_cast<int>(m_buflen), m_len);
+      }
+
+    private:
+      Sum m_sum;
+      char m_buf[64];
+      size_t m_buflen;
+      uint64_t m_len;
+    };
+  }
+
   // swap endianness of various size integral types
   constexpr uint64_t endianswap(uint64_t x)
   {
@@ -0,0 +1,854 @@
+#pragma once
+
+#include "cx_cpuid.h"
+#include "cx_utils.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+//----------------------------------------------------------------------------
+// constexpr string hashing: xxh32, xxh64, xxh3_64 (xxHash 0.8)
+
+namespace cx
+{
+  namespace err
+  {
+    namespace
+    {
+      CX_ERROR_SYMBOL(xxh32_runtime_error);
+      CX_ERROR_SYMBOL(xxh64_runtime_error);
+      CX_ERROR_SYMBOL(xxh3_64_runtime_error);
+    }
+  }
+
+  namespace detail
+  {
+    namespace xxh
+    {
+      constexpr uint32_t p32_1 = 0x9e3779b1u;
+      constexpr uint32_t p32_2 = 0x85ebca77u;
+      constexpr uint32_t p32_3 = 0xc2b2ae3du;
+      constexpr uint32_t p32_4 = 0x27d4eb2fu;
+      constexpr uint32_t p32_5 = 0x165667b1u;
+
+      constexpr uint64_t p64_1 = 0x9e3779b185ebca87ull;
+      constexpr uint64_t p64_2 = 0xc2b2ae3d27d4eb4full;
+      constexpr uint64_t p64_3 = 0x165667b19e3779f9ull;
+      constexpr uint64_t p64_4 = 0x85ebca77c2b2ae63ull;
+      constexpr uint64_t p64_5 = 0x27d4eb2f165667c5ull;
+
+      constexpr uint32_t rotl32(uint32_t x, int r)
+      {
+        return (x << r) | (x >> (32 - r));
+      }
+      constexpr uint64_t rotl64(uint64_t x, int r)
+      {
+        return (x << r) | (x >> (64 - r));
+      }
+      constexpr uint32_t xorshift32(uint32_t h, int n)
+      {
+        return h ^ (h >> n);
+      }
+      constexpr uint64_t xorshift64(uint64_t h, int n)
+      {
+        return h ^ (h >> n);
+      }
+
+      //------------------------------------------------------------------------
+      // xxh32: four accumulators, each taking 4 bytes of every 16-byte stripe
+      constexpr uint32_t round32(uint32_t acc, uint32_t in)
+      {
+        return rotl32(acc + in * p32_2, 13) * p32_1;
+      }
+
+      // the accumulators, and the bytes remaining
+      struct lanes32
+      {
+        uint32_t v[4];
+        const char* s;
+        size_t len;
+      };
+      constexpr lanes32 stripe32(const lanes32& l)
+      {
+        return { { round32(l.v[0], word32le(l.s)), round32(l.v[1], word32le(l.s+4)),
+              round32(l.v[2], word32le(l.s+8)), round32(l.v[3], word32le(l.s+12)) },
+            l.s + 16, l.len - 16 };
+      }
+      // as with fnv, recurse in chunks to bound the recursion depth
+      constexpr lanes32 stripes32(const lanes32& l, int maxdepth)
+      {
+        return l.len < 16 || maxdepth == 0 ? l : stripes32(stripe32(l), maxdepth-1);
+      }
+      constexpr lanes32 stripes32_bychunk(const lanes32& l)
+      {
+        return l.len < 16 ? l : stripes32_bychunk(stripes32(l, 256));
+      }
+      constexpr uint32_t converge32(const lanes32& l)
+      {
+        return rotl32(l.v[0], 1) + rotl32(l.v[1], 7)
+          + rotl32(l.v[2], 12) + rotl32(l.v[3], 18);
+      }
+
+      // the last 0-15 bytes: 4 at a time, then 1 at a time
+      constexpr uint32_t tail32(uint32_t h, const char* s, size_t len)
+      {
+        return len >= 4 ?
+          tail32(rotl32(h + word32le(s) * p32_3, 17) * p32_4, s+4, len-4) :
+          len > 0 ?
+          tail32(rotl32(h + byte32(*s) * p32_5, 11) * p32_1, s+1, len-1) :
+          h;
+      }
+      constexpr uint32_t avalanche32(uint32_t h)
+      {
+        return xorshift32(xorshift32(xorshift32(h, 15) * p32_2, 13) * p32_3, 16);
+      }
+
+      constexpr uint32_t xxh32_end(uint32_t h, const char* s, size_t len, size_t totallen)
+      {
+        return avalanche32(tail32(h + static_cast<uint32_t>(totallen), s, len));
+      }
+      constexpr uint32_t xxh32_long(const lanes32& l, size_t len)
+      {
+        return xxh32_end(converge32(l), l.s, l.len, len);
+      }
+      constexpr uint32_t xxh32(const char* s, size_t len, uint32_t seed)
+      {
+        return len >= 16 ?
+          xxh32_long(stripes32_bychunk(
+                         { { seed + p32_1 + p32_2, seed + p32_2, seed, seed - p32_1 },
+                           s, len }), len) :
+          xxh32_end(seed + p32_5, s, len, len);
+      }
+
+      //------------------------------------------------------------------------
+      // xxh64: four accumulators, each taking 8 bytes of every 32-byte stripe
+      constexpr uint64_t round64(uint64_t acc, uint64_t in)
+      {
+        return rotl64(acc + in * p64_2, 31) * p64_1;
+      }
+      constexpr uint64_t merge64(uint64_t h, uint64_t v)
+      {
+        return (h ^ round64(0, v)) * p64_1 + p64_4;
+      }
+
+      struct lanes64
+      {
+        uint64_t v[4];
+        const char* s;
+        size_t len;
+      };
+      constexpr lanes64 stripe64(const lanes64& l)
+      {
+        return { { round64(l.v[0], word64le(l.s)), round64(l.v[1], word64le(l.s+8)),
+              round64(l.v[2], word64le(l.s+16)), round64(l.v[3], word64le(l.s+24)) },
+            l.s + 32, l.len - 32 };
+      }
+      constexpr lanes64 stripes64(const lanes64& l, int maxdepth)
+      {
+        return l.len < 32 || maxdepth == 0 ? l : stripes64(stripe64(l), maxdepth-1);
+      }
+      constexpr lanes64 stripes64_bychunk(const lanes64& l)
+      {
+        return l.len < 32 ? l : stripes64_bychunk(stripes64(l, 256));
+      }
+      constexpr uint64_t converge64(const lanes64& l)
+      {
+        return merge64(merge64(merge64(merge64(
+                                           rotl64(l.v[0], 1) + rotl64(l.v[1], 7)
+                                           + rotl64(l.v[2], 12) + rotl64(l.v[3], 18),
+                                           l.v[0]), l.v[1]), l.v[2]), l.v[3]);
+      }
+
+      // the last 0-31 bytes: 8 at a time, then 4, then 1 at a time
+      constexpr uint64_t tail64(uint64_t h, const char* s, size_t len)
+      {
+        return len >= 8 ?
+          tail64(rotl64(h ^ round64(0, word64le(s)), 27) * p64_1 + p64_4, s+8, len-8) :
+          len >= 4 ?
+          tail64(rotl64(h ^ (word32le(s) * p64_1), 23) * p64_2 + p64_3, s+4, len-4) :
+          len > 0 ?
+          tail64(rotl64(h ^ (byte32(*s) * p64_5), 11) * p64_1, s+1, len-1) :
+          h;
+      }
+      constexpr uint64_t avalanche64(uint64_t h)
+      {
+        return xorshift64(xorshift64(xorshift64(h, 33) * p64_2, 29) * p64_3, 32);
+      }
+
+      constexpr uint64_t xxh64_end(uint64_t h, const char* s, size_t len, size_t totallen)
+      {
+        return avalanche64(tail64(h + totallen, s, len));
+      }
+      constexpr uint64_t xxh64_long(const lanes64& l, size_t len)
+      {
+        return xxh64_end(converge64(l), l.s, l.len, len);
+      }
+      constexpr uint64_t xxh64(const char* s, size_t len, uint64_t seed)
+      {
+        return len >= 32 ?
+          xxh64_long(stripes64_bychunk(
+                         { { seed + p64_1 + p64_2, seed + p64_2, seed, seed - p64_1 },
+                           s, len }), len) :
+          xxh64_end(seed + p64_5, s, len, len);
+      }
+
+      //------------------------------------------------------------------------
+      // xxh3_64: separate short, medium and long paths, all keyed by a
+      // 192-byte secret
+      constexpr char secret[] =
+        "\xb8\xfe\x6c\x39\x23\xa4\x4b\xbe\x7c\x01\x81\x2c\xf7\x21\xad\x1c"
+        "\xde\xd4\x6d\xe9\x83\x90\x97\xdb\x72\x40\xa4\xa4\xb7\xb3\x67\x1f"
+        "\xcb\x79\xe6\x4e\xcc\xc0\xe5\x78\x82\x5a\xd0\x7d\xcc\xff\x72\x21"
+        "\xb8\x08\x46\x74\xf7\x43\x24\x8e\xe0\x35\x90\xe6\x81\x3a\x26\x4c"
+        "\x3c\x28\x52\xbb\x91\xc3\x00\xcb\x88\xd0\x65\x8b\x1b\x53\x2e\xa3"
+        "\x71\x64\x48\x97\xa2\x0d\xf9\x4e\x38\x19\xef\x46\xa9\xde\xac\xd8"
+        "\xa8\xfa\x76\x3f\xe3\x9c\x34\x3f\xf9\xdc\xbb\xc7\xc7\x0b\x4f\x1d"
+        "\x8a\x51\xe0\x4b\xcd\xb4\x59\x31\xc8\x9f\x7e\xc9\xd9\x78\x73\x64"
+        "\xea\xc5\xac\x83\x34\xd3\xeb\xc3\xc5\x81\xa0\xff\xfa\x13\x63\xeb"
+        "\x17\x0d\xdd\x51\xb7\xf0\xda\x49\xd3\x16\x55\x26\x29\xd4\x68\x9e"
+        "\x2b\x16\xbe\x58\x7d\x47\xa1\xfc\x8f\xf8\xb8\xd1\x7a\xd0\x31\xce"
+        "\x45\xcb\x3a\x8f\x95\x16\x04\x28\xaf\xd7\xfb\xca\xbb\x4b\x40\x7e";
+      constexpr size_t secret_size = 192;
+
+      constexpr uint64_t mx1 = 0x165667919e3779f9ull;
+      constexpr uint64_t mx2 = 0x9fb21c651e98df25ull;
+
+      // the 128-bit product of a and b, with its halves xored together
+      // (schoolbook multiplication on 32-bit halves)
+      constexpr uint64_t fold128(uint64_t lo_lo, uint64_t hi_hi, uint64_t hi_lo,
+                                 uint64_t cross)
+      {
+        return ((cross << 32) | (lo_lo & 0xffffffff))
+          ^ ((hi_lo >> 32) + (cross >> 32) + hi_hi);
+      }
+      constexpr uint64_t mul128_fold64(uint64_t a, uint64_t b)
+      {
+        return fold128((a & 0xffffffff) * (b & 0xffffffff), (a >> 32) * (b >> 32),
+                       (a >> 32) * (b & 0xffffffff),
+                       (((a & 0xffffffff) * (b & 0xffffffff)) >> 32)
+                       + (((a >> 32) * (b & 0xffffffff)) & 0xffffffff)
+                       + (a & 0xffffffff) * (b >> 32));
+      }
+
+      constexpr uint64_t avalanche3(uint64_t h)
+      {
+        return xorshift64(xorshift64(h, 37) * mx1, 32);
+      }
+      constexpr uint64_t rrmxmx2(uint64_t h, uint64_t len)
+      {
+        return xorshift64((h ^ ((h >> 35) + len)) * mx2, 28);
+      }
+      constexpr uint64_t rrmxmx(uint64_t h, uint64_t len)
+      {
+        return rrmxmx2((h ^ rotl64(h, 49) ^ rotl64(h, 24)) * mx2, len);
+      }
+
+      // 0-16 bytes
+      constexpr uint64_t len_0(uint64_t seed)
+      {
+        return avalanche64(seed ^ word64le(secret+56) ^ word64le(secret+64));
+      }
+      constexpr uint64_t len_1to3(const char* s, size_t len, uint64_t seed)
+      {
+        return avalanche64(
+            static_cast<uint64_t>((byte32(s[0]) << 16) | (byte32(s[len >> 1]) << 24)
+                                  | byte32(s[len - 1]) | static_cast<uint32_t>(len << 8))
+            ^ (static_cast<uint64_t>(word32le(secret) ^ word32le(secret+4)) + seed));
+      }
+      constexpr uint64_t len_4to8(const char* s, size_t len, uint64_t seed)
+      {
+        return rrmxmx(
+            (word32le(s + len - 4) + (static_cast<uint64_t>(word32le(s)) << 32))
+            ^ ((word64le(secret+8) ^ word64le(secret+16))
+               - (seed ^ (static_cast<uint64_t>(
+                              endianswap(static_cast<uint32_t>(seed))) << 32))),
+            len);
+      }
+      constexpr uint64_t len_9to16_mix(uint64_t lo, uint64_t hi, size_t len)
+      {
+        return avalanche3(len + endianswap(lo) + hi + mul128_fold64(lo, hi));
+      }
+      constexpr uint64_t len_9to16(const char* s, size_t len, uint64_t seed)
+      {
+        return len_9to16_mix(
+            word64le(s) ^ ((word64le(secret+24) ^ word64le(secret+32)) + seed),
+            word64le(s + len - 8) ^ ((word64le(secret+40) ^ word64le(secret+48)) - seed),
+            len);
+      }
+      constexpr uint64_t len_0to16(const char* s, size_t len, uint64_t seed)
+      {
+        return len > 8 ? len_9to16(s, len, seed) :
+          len >= 4 ? len_4to8(s, len, seed) :
+          len > 0 ? len_1to3(s, len, seed) :
+          len_0(seed);
+      }
+
+      // 17-240 bytes: 16-byte pieces, each multiplied with the secret
+      constexpr uint64_t mix16(const char* s, const char* k, uint64_t seed)
+      {
+        return mul128_fold64(word64le(s) ^ (word64le(k) + seed),
+                             word64le(s+8) ^ (word64le(k+8) - seed));
+      }
+      constexpr uint64_t len_17to128(const char* s, size_t len, uint64_t seed)
+      {
+        return avalanche3(
+            len * p64_1
+            + mix16(s, secret, seed) + mix16(s + len - 16, secret + 16, seed)
+            + (len > 32 ?
+               mix16(s + 16, secret + 32, seed) + mix16(s + len - 32, secret + 48, seed) : 0)
+            + (len > 64 ?
+               mix16(s + 32, secret + 64, seed) + mix16(s + len - 48, secret + 80, seed) : 0)
+            + (len > 96 ?
+               mix16(s + 48, secret + 96, seed) + mix16(s + len - 64, secret + 112, seed) : 0));
+      }
+      constexpr uint64_t mid_first8(const char* s, uint64_t seed, size_t i)
+      {
+        return i == 8 ? 0 :
+          mix16(s + 16*i, secret + 16*i, seed) + mid_first8(s, seed, i + 1);
+      }
+      constexpr uint64_t mid_rest(const char* s, uint64_t seed, size_t i, size_t n)
+      {
+        return i >= n ? 0 :
+          mix16(s + 16*i, secret + 16*(i-8) + 3, seed) + mid_rest(s, seed, i + 1, n);
+      }
+      constexpr uint64_t len_129to240(const char* s, size_t len, uint64_t seed)
+      {
+        return avalanche3(avalanche3(len * p64_1 + mid_first8(s, seed, 0))
+                          + mid_rest(s, seed, 8, len / 16)
+                          + mix16(s + len - 16, secret + 119, seed));
+      }
+
+      // More than 240 bytes: eight 64-bit accumulators over 64-byte stripes,
+      // with the secret offset by 8 bytes for each stripe of a 1024-byte
+      // block, and the accumulators scrambled after each block. A seed
+      // changes the secret, adding to the first and subtracting from the
+      // second word of each 16 bytes.
+      constexpr uint64_t secret_word(uint64_t seed, size_t w)
+      {
+        return (w & 1) == 0 ? word64le(secret + 8*w) + seed : word64le(secret + 8*w) - seed;
+      }
+      constexpr uint64_t secret_byte(uint64_t seed, size_t i)
+      {
+        return (secret_word(seed, i / 8) >> (8 * (i % 8))) & 0xff;
+      }
+      constexpr uint64_t secret64(uint64_t seed, size_t off)
+      {
+        return off % 8 == 0 ? secret_word(seed, off / 8) :
+          secret_byte(seed, off) | (secret_byte(seed, off+1) << 8)
+          | (secret_byte(seed, off+2) << 16) | (secret_byte(seed, off+3) << 24)
+          | (secret_byte(seed, off+4) << 32) | (secret_byte(seed, off+5) << 40)
+          | (secret_byte(seed, off+6) << 48) | (secret_byte(seed, off+7) << 56);
+      }
+
+      struct acc8
+      {
+        uint64_t a[8];
+      };
+      constexpr acc8 init_acc()
+      {
+        return { { p32_3, p64_1, p64_2, p64_3, p64_4, p32_2, p64_5, p32_1 } };
+      }
+
+      // each lane adds its 32x32-bit product of data^secret, and the data of
+      // its neighbour
+      constexpr uint64_t accmul(uint64_t dk)
+      {
+        return (dk & 0xffffffff) * (dk >> 32);
+      }
+      constexpr uint64_t acclane(uint64_t acc, const char* in, uint64_t seed,
+                                 size_t off, int i)
+      {
+        return acc + word64le(in + 8*(i^1))
+          + accmul(word64le(in + 8*i) ^ secret64(seed, off + 8*static_cast<size_t>(i)));
+      }
+      constexpr acc8 accumulate(const acc8& acc, const char* in, uint64_t seed, size_t off)
+      {
+        return { { acclane(acc.a[0], in, seed, off, 0), acclane(acc.a[1], in, seed, off, 1),
+              acclane(acc.a[2], in, seed, off, 2), acclane(acc.a[3], in, seed, off, 3),
+              acclane(acc.a[4], in, seed, off, 4), acclane(acc.a[5], in, seed, off, 5),
+              acclane(acc.a[6], in, seed, off, 6), acclane(acc.a[7], in, seed, off, 7) } };
+      }
+      // stripes i..n-1 of a block
+      constexpr acc8 stripes(const acc8& acc, const char* in, uint64_t seed,
+                             size_t i, size_t n)
+      {
+        return i == n ? acc :
+          stripes(accumulate(acc, in + 64*i, seed, 8*i), in, seed, i + 1, n);
+      }
+
+      constexpr uint64_t scramblelane(uint64_t a, uint64_t seed, size_t i)
+      {
+        return (xorshift64(a, 47) ^ secret64(seed, secret_size - 64 + 8*i)) * p32_1;
+      }
+      constexpr acc8 scramble(const acc8& acc, uint64_t seed)
+      {
+        return { { scramblelane(acc.a[0], seed, 0), scramblelane(acc.a[1], seed, 1),
+              scramblelane(acc.a[2], seed, 2), scramblelane(acc.a[3], seed, 3),
+              scramblelane(acc.a[4], seed, 4), scramblelane(acc.a[5], seed, 5),
+              scramblelane(acc.a[6], seed, 6), scramblelane(acc.a[7], seed, 7) } };
+      }
+
+      constexpr size_t stripes_per_block = (secret_size - 64) / 8;
+      constexpr size_t block_len = 64 * stripes_per_block;
+
+      constexpr acc8 blocks(const acc8& acc, const char* in, uint64_t seed, size_t nblocks)
+      {
+        return nblocks == 0 ? acc :
+          blocks(scramble(stripes(acc, in, seed, 0, stripes_per_block), seed),
+                 in + block_len, seed, nblocks - 1);
+      }
+
+      // the whole blocks, then the whole stripes of the last block, then the
+      // last 64 bytes (which may overlap them) with the secret offset by 121
+      constexpr acc8 accumulate_long(const acc8& acc, const char* in, size_t len,
+                                     uint64_t seed, size_t nblocks)
+      {
+        return accumulate(
+            stripes(blocks(acc, in, seed, nblocks), in + nblocks * block_len, seed,
+                    0, (len - 1 - nblocks * block_len) / 64),
+            in + len - 64, seed, secret_size - 64 - 7);
+      }
+
+      constexpr uint64_t mix2accs(uint64_t a0, uint64_t a1, uint64_t seed, size_t off)
+      {
+        return mul128_fold64(a0 ^ secret64(seed, off), a1 ^ secret64(seed, off + 8));
+      }
+      constexpr uint64_t merge_accs(const acc8& acc, uint64_t seed, size_t len)
+      {
+        return avalanche3(len * p64_1
+                          + mix2accs(acc.a[0], acc.a[1], seed, 11)
+                          + mix2accs(acc.a[2], acc.a[3], seed, 27)
+                          + mix2accs(acc.a[4], acc.a[5], seed, 43)
+                          + mix2accs(acc.a[6], acc.a[7], seed, 59));
+      }
+
+      constexpr uint64_t xxh3_64(const char* s, size_t len, uint64_t seed)
+      {
+        return len <= 16 ? len_0to16(s, len, seed) :
+          len <= 128 ? len_17to128(s, len, seed) :
+          len <= 240 ? len_129to240(s, len, seed) :
+          merge_accs(accumulate_long(init_acc(), s, len, seed, (len - 1) / block_len),
+                     seed, len);
+      }
+    }
+  }
+
+  // runtime versions (see cx_runtime.h)
+  namespace runtime
+  {
+    inline uint32_t xxh32(const char* s, size_t len, uint32_t seed)
+    {
+      using namespace detail::xxh;
+      uint32_t h = seed + p32_5;
+      const char* const end = s + len;
+      if (len >= 16)
+      {
+        uint32_t v0 = seed + p32_1 + p32_2;
+        uint32_t v1 = seed + p32_2;
+        uint32_t v2 = seed;
+        uint32_t v3 = seed - p32_1;
+        for (; end - s >= 16; s += 16)
+        {
+          v0 = round32(v0, load32le(s));
+          v1 = round32(v1, load32le(s+4));
+          v2 = round32(v2, load32le(s+8));
+          v3 = round32(v3, load32le(s+12));
+        }
+        h = rotl32(v0, 1) + rotl32(v1, 7) + rotl32(v2, 12) + rotl32(v3, 18);
+      }
+      h += static_cast<uint32_t>(len);
+      for (; end - s >= 4; s += 4)
+      {
+        h = rotl32(h + load32le(s) * p32_3, 17) * p32_4;
+      }
+      for (; s != end; ++s)
+      {
+        h = rotl32(h + byte32(*s) * p32_5, 11) * p32_1;
+      }
+      return avalanche32(h);
+    }
+
+    inline uint64_t xxh64(const char* s, size_t len, uint64_t seed)
+    {
+      using namespace detail::xxh;
+      uint64_t h = seed + p64_5;
+      const char* const end = s + len;
+      if (len >= 32)
+      {
+        uint64_t v0 = seed + p64_1 + p64_2;
+        uint64_t v1 = seed + p64_2;
+        uint64_t v2 = seed;
+        uint64_t v3 = seed - p64_1;
+        for (; end - s >= 32; s += 32)
+        {
+          v0 = round64(v0, load64le(s));
+          v1 = round64(v1, load64le(s+8));
+          v2 = round64(v2, load64le(s+16));
+          v3 = round64(v3, load64le(s+24));
+        }
+        h = rotl64(v0, 1) + rotl64(v1, 7) + rotl64(v2, 12) + rotl64(v3, 18);
+        h = merge64(merge64(merge64(merge64(h, v0), v1), v2), v3);
+      }
+      h += len;
+      for (; end - s >= 8; s += 8)
+      {
+        h = rotl64(h ^ round64(0, load64le(s)), 27) * p64_1 + p64_4;
+      }
+      if (end - s >= 4)
+      {
+        h = rotl64(h ^ (load32le(s) * p64_1), 23) * p64_2 + p64_3;
+        s += 4;
+      }
+      for (; s != end; ++s)
+      {
+        h = rotl64(h ^ (byte32(*s) * p64_5), 11) * p64_1;
+      }
+      return avalanche64(h);
+    }
+
+    //--------------------------------------------------------------------------
+    // xxh3_64
+
+    inline uint64_t mul128_fold64(uint64_t a, uint64_t b)
+    {
+#ifdef __SIZEOF_INT128__
+      __extension__ typedef unsigned __int128 uint128;
+      const uint128 p = static_cast<uint128>(a) * b;
+      return static_cast<uint64_t>(p) ^ static_cast<uint64_t>(p >> 64);
+#else
+      return detail::xxh::mul128_fold64(a, b);
+#endif
+    }
+
+    namespace detail_xxh3
+    {
+      inline uint64_t mix16(const char* s, const char* k, uint64_t seed)
+      {
+        return mul128_fold64(load64le(s) ^ (load64le(k) + seed),
+                             load64le(s+8) ^ (load64le(k+8) - seed));
+      }
+
+      inline uint64_t len_0to16(const char* s, size_t len, uint64_t seed)
+      {
+        using namespace detail::xxh;
+        if (len > 8)
+        {
+          const uint64_t lo = load64le(s)
+            ^ ((load64le(secret+24) ^ load64le(secret+32)) + seed);
+          const uint64_t hi = load64le(s + len - 8)
+            ^ ((load64le(secret+40) ^ load64le(secret+48)) - seed);
+          return avalanche3(len + endianswap(lo) + hi + mul128_fold64(lo, hi));
+        }
+        if (len >= 4)
+        {
+          seed ^= static_cast<uint64_t>(endianswap(static_cast<uint32_t>(seed))) << 32;
+          const uint64_t in = load32le(s + len - 4)
+            + (static_cast<uint64_t>(load32le(s)) << 32);
+          return rrmxmx(in ^ ((load64le(secret+8) ^ load64le(secret+16)) - seed), len);
+        }
+        if (len > 0)
+        {
+          return len_1to3(s, len, seed);
+        }
+        return len_0(seed);
+      }
+
+      inline uint64_t len_17to240(const char* s, size_t len, uint64_t seed)
+      {
+        using namespace detail::xxh;
+        uint64_t acc = len * p64_1;
+        if (len <= 128)
+        {
+          acc += mix16(s, secret, seed) + mix16(s + len - 16, secret + 16, seed);
+          if (len > 32)
+          {
+            acc += mix16(s + 16, secret + 32, seed) + mix16(s + len - 32, secret + 48, seed);
+          }
+          if (len > 64)
+          {
+            acc += mix16(s + 32, secret + 64, seed) + mix16(s + len - 48, secret + 80, seed);
+          }
+          if (len > 96)
+          {
+            acc += mix16(s + 48, secret + 96, seed) + mix16(s + len - 64, secret + 112, seed);
+          }
+          return avalanche3(acc);
+        }
+        for (size_t i = 0; i < 8; ++i)
+        {
+          acc += mix16(s + 16*i, secret + 16*i, seed);
+        }
+        acc = avalanche3(acc);
+        for (size_t i = 8; i < len / 16; ++i)
+        {
+          acc += mix16(s + 16*i, secret + 16*(i-8) + 3, seed);
+        }
+        return avalanche3(acc + mix16(s + len - 16, secret + 119, seed));
+      }
+
+      // Stripe kernels for long inputs: accumulate n 64-byte stripes (with
+      // the secret advancing 8 bytes per stripe), and scramble the
+      // accumulators at the end of a block. The accumulators stay in memory
+      // between calls, which happen once per 1024-byte block.
+      struct scalar
+      {
+        static void accumulate(uint64_t* acc, const char* in, const char* k, size_t n)
+        {
+          for (; n > 0; --n, in += 64, k += 8)
+          {
+            for (int i = 0; i < 8; ++i)
+            {
+              const uint64_t d = load64le(in + 8*i);
+              const uint64_t dk = d ^ load64le(k + 8*i);
+              acc[i^1] += d;
+              acc[i] += (dk & 0xffffffff) * (dk >> 32);
+            }
+          }
+        }
+        static void scramble(uint64_t* acc, const char* k)
+        {
+          for (int i = 0; i < 8; ++i)
+          {
+            acc[i] = (acc[i] ^ (acc[i] >> 47) ^ load64le(k + 8*i)) * detail::xxh::p32_1;
+          }
+        }
+      };
+
+#if CX_X86_SIMD
+      __attribute__((target("sse2")))
+      inline __m128i load128(const void* p)
+      {
+        return _mm_loadu_si128(static_cast<const __m128i*>(p));
+      }
+      __attribute__((target("sse2")))
+      inline void store128(void* p, __m128i x)
+      {
+        _mm_storeu_si128(static_cast<__m128i*>(p), x);
+      }
+
+      // two lanes per vector: the high half of each data^secret word is
+      // shuffled down for the 32x32 multiply, and the data words swap places
+      __attribute__((target("sse2")))
+      inline __m128i accumulate2(__m128i acc, __m128i d, __m128i k)
+      {
+        const __m128i dk = _mm_xor_si128(d, k);
+        const __m128i product = _mm_mul_epu32(dk, _mm_shuffle_epi32(dk, 0x31));
+        return _mm_add_epi64(_mm_add_epi64(acc, _mm_shuffle_epi32(d, 0x4e)), product);
+      }
+      __attribute__((target("sse2")))
+      inline __m128i scramble2(__m128i acc, __m128i k)
+      {
+        const __m128i dk = _mm_xor_si128(_mm_xor_si128(acc, _mm_srli_epi64(acc, 47)), k);
+        const __m128i prime = _mm_set1_epi32(static_cast<int>(detail::xxh::p32_1));
+        return _mm_add_epi64(
+            _mm_mul_epu32(dk, prime),
+            _mm_slli_epi64(_mm_mul_epu32(_mm_shuffle_epi32(dk, 0x31), prime), 32));
+      }
+
+      struct sse2
+      {
+        __attribute__((target("sse2")))
+        static void accumulate(uint64_t* acc, const char* in, const char* k, size_t n)
+        {
+          __m128i a[4];
+          for (int i = 0; i < 4; ++i)
+          {
+            a[i] = load128(acc + 2*i);
+          }
+          for (; n > 0; --n, in += 64, k += 8)
+          {
+            for (int i = 0; i < 4; ++i)
+            {
+              a[i] = accumulate2(a[i], load128(in + 16*i), load128(k + 16*i));
+            }
+          }
+          for (int i = 0; i < 4; ++i)
+          {
+            store128(acc + 2*i, a[i]);
+          }
+        }
+        __attribute__((target("sse2")))
+        static void scramble(uint64_t* acc, const char* k)
+        {
+          for (int i = 0; i < 4; ++i)
+          {
+            store128(acc + 2*i, scramble2(load128(acc + 2*i), load128(k + 16*i)));
+          }
+        }
+      };
+
+      // the same four lanes per vector
+      __attribute__((target("avx2")))
+      inline __m256i load256(const void* p)
+      {
+        return _mm256_loadu_si256(static_cast<const __m256i*>(p));
+      }
+      __attribute__((target("avx2")))
+      inline void store256(void* p, __m256i x)
+      {
+        _mm256_storeu_si256(static_cast<__m256i*>(p), x);
+      }
+      __attribute__((target("avx2")))
+      inline __m256i accumulate4(__m256i acc, __m256i d, __m256i k)
+      {
+        const __m256i dk = _mm256_xor_si256(d, k);
+        const __m256i product = _mm256_mul_epu32(dk, _mm256_shuffle_epi32(dk, 0x31));
+        return _mm256_add_epi64(_mm256_add_epi64(acc, _mm256_shuffle_epi32(d, 0x4e)),
+                                product);
+      }
+      __attribute__((target("avx2")))
+      inline __m256i scramble4(__m256i acc, __m256i k)
+      {
+        const __m256i dk = _mm256_xor_si256(
+            _mm256_xor_si256(acc, _mm256_srli_epi64(acc, 47)), k);
+        const __m256i prime = _mm256_set1_epi32(static_cast<int>(detail::xxh::p32_1));
+        return _mm256_add_epi64(
+            _mm256_mul_epu32(dk, prime),
+            _mm256_slli_epi64(_mm256_mul_epu32(_mm256_shuffle_epi32(dk, 0x31), prime), 32));
+      }
+
+      struct avx2
+      {
+        __attribute__((target("avx2")))
+        static void accumulate(uint64_t* acc, const char* in, const char* k, size_t n)
+        {
+          __m256i a0 = load256(acc);
+          __m256i a1 = load256(acc + 4);
+          for (; n > 0; --n, in += 64, k += 8)
+          {
+            a0 = accumulate4(a0, load256(in), load256(k));
+            a1 = accumulate4(a1, load256(in + 32), load256(k + 32));
+          }
+          store256(acc, a0);
+          store256(acc + 4, a1);
+        }
+        __attribute__((target("avx2")))
+        static void scramble(uint64_t* acc, const char* k)
+        {
+          store256(acc, scramble4(load256(acc), load256(k)));
+          store256(acc + 4, scramble4(load256(acc + 4), load256(k + 32)));
+        }
+      };
+#endif
+    }
+
+    // the accumulation over a long (more than 240-byte) input, as
+    // detail::xxh::accumulate_long, with a given stripe kernel
+    template <typename K>
+    inline void xxh3_accumulate(uint64_t* acc, const char* in, size_t len, const char* k)
+    {
+      using namespace detail::xxh;
+      const size_t nblocks = (len - 1) / block_len;
+      for (size_t b = 0; b < nblocks; ++b, in += block_len)
+      {
+        K::accumulate(acc, in, k, stripes_per_block);
+        K::scramble(acc, k + secret_size - 64);
+      }
+      K::accumulate(acc, in, k, (len - 1 - nblocks * block_len) / 64);
+      K::accumulate(acc, in + (len - nblocks * block_len) - 64, k + secret_size - 64 - 7, 1);
+    }
+
+    using xxh3_accumulate_fn = void (*)(uint64_t*, const char*, size_t, const char*);
+
+    inline xxh3_accumulate_fn xxh3_accumulate_select()
+    {
+#if CX_X86_SIMD
+      const cpu_features& f = cpu();
+      return f.avx2 ? xxh3_accumulate<detail_xxh3::avx2> :
+        f.sse2 ? xxh3_accumulate<detail_xxh3::sse2> :
+        xxh3_accumulate<detail_xxh3::scalar>;
+#else
+      return xxh3_accumulate<detail_xxh3::scalar>;
+#endif
+    }
+
+    inline uint64_t xxh3_64(const char* s, size_t len, uint64_t seed)
+    {
+      using namespace detail::xxh;
+      if (len <= 16) return detail_xxh3::len_0to16(s, len, seed);
+      if (len <= 240) return detail_xxh3::len_17to240(s, len, seed);
+
+      // a seed changes the secret (see detail::xxh::secret_word); without
+      // one, the default secret is used as is
+      const char* k = secret;
+      char seeded[secret_size];
+      if (seed != 0)
+      {
+        for (size_t w = 0; w < secret_size / 8; ++w)
+        {
+          const uint64_t x = load64le(secret + 8*w);
+          store64le(seeded + 8*w, (w & 1) == 0 ? x + seed : x - seed);
+        }
+        k = seeded;
+      }
+      alignas(32) uint64_t acc[8];
+      const acc8 a = init_acc();
+      std::memcpy(acc, a.a, sizeof(acc));
+
+      static const xxh3_accumulate_fn f = xxh3_accumulate_select();
+      f(acc, s, len, k);
+
+      uint64_t h = len * p64_1;
+      for (size_t i = 0; i < 4; ++i)
+      {
+        h += mul128_fold64(acc[2*i] ^ load64le(k + 11 + 16*i),
+                           acc[2*i+1] ^ load64le(k + 19 + 16*i));
+      }
+      return avalanche3(h);
+    }
+
+    inline uint32_t xxh32(const char* s, uint32_t seed)
+    {
+      return xxh32(s, static_cast<size_t>(strlen(s)), seed);
+    }
+    inline uint64_t xxh64(const char* s, uint64_t seed)
+    {
+      return xxh64(s, static_cast<size_t>(strlen(s)), seed);
+    }
+    inline uint64_t xxh3_64(const char* s, uint64_t seed)
+    {
+      return xxh3_64(s, static_cast<size_t>(strlen(s)), seed);
+    }
+  }
+
+  // (the overloads with a length take buffers that may contain NUL bytes)
+  constexpr uint32_t xxh32(const char* s, uint32_t seed)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::xxh::xxh32(s, static_cast<size_t>(strlen(s)), seed) :
+      CX_RUNTIME_DISPATCH(runtime::xxh32(s, seed), err::xxh32_runtime_error);
+  }
+  constexpr uint32_t xxh32(const char* s, size_t len, uint32_t seed)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::xxh::xxh32(s, len, seed) :
+      CX_RUNTIME_DISPATCH(runtime::xxh32(s, len, seed), err::xxh32_runtime_error);
+  }
+
+  constexpr uint64_t xxh64(const char* s, uint64_t seed)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::xxh::xxh64(s, static_cast<size_t>(strlen(s)), seed) :
+      CX_RUNTIME_DISPATCH(runtime::xxh64(s, seed), err::xxh64_runtime_error);
+  }
+  constexpr uint64_t xxh64(const char* s, size_t len, uint64_t seed)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::xxh::xxh64(s, len, seed) :
+      CX_RUNTIME_DISPATCH(runtime::xxh64(s, len, seed), err::xxh64_runtime_error);
+  }
+
+  constexpr uint64_t xxh3_64(const char* s, uint64_t seed)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::xxh::xxh3_64(s, static_cast<size_t>(strlen(s)), seed) :
+      CX_RUNTIME_DISPATCH(runtime::xxh3_64(s, seed), err::xxh3_64_runtime_error);
+  }
+  constexpr uint64_t xxh3_64(const char* s, size_t len, uint64_t seed)
+  {
+    return CX_CONSTANT_EVALUATED() ?
+      detail::xxh::xxh3_64(s, len, seed) :
+      CX_RUNTIME_DISPATCH(runtime::xxh3_64(s, len, seed), err::xxh3_64_runtime_error);
+  }
+}
@@ -0,0 +1,101 @@
+#include <cx_asset.h>
+
+#include <cassert>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  constexpr char hello[] = "hello, world";
+  constexpr auto hello_asset = cx::make_asset("hello", hello, sizeof(hello) - 1);
+  constexpr auto hello_md5 = cx::make_asset<cx::asset_md5>("hello", hello, sizeof(hello) - 1);
+
+  // the right digest stored with the wrong bytes, as if they were corrupted
+  constexpr char corrupt[] = "hello, wor1d";
+  constexpr cx::embedded_asset<> corrupt_asset(
+      "corrupt", corrupt, sizeof(corrupt) - 1, hello_asset.digest());
+
+  constexpr bool same_sha256(const cx::sha256sum& a, const cx::sha256sum& b, int i = 0)
+  {
+    return i == 8 || (a.h[i] == b.h[i] && same_sha256(a, b, i + 1));
+  }
+  constexpr bool same_md5(const cx::md5sum& a, const cx::md5sum& b, int i = 0)
+  {
+    return i == 4 || (a.h[i] == b.h[i] && same_md5(a, b, i + 1));
+  }
+}
+
+void test_cx_asset()
+{
+  // the digest is computed at compile time
+  {
+    static_assert(same_sha256(hello_asset.digest(), cx::sha256("hello, world")),
+                  "embedded_asset sha256 digest");
+    static_assert(same_md5(hello_md5.digest(), cx::md5("hello, world")),
+                  "embedded_asset md5 digest");
+    static_assert(hello_asset.size() == 12 && hello_asset.data() == hello,
+                  "embedded_asset bytes");
+
+    // a char array includes its terminating NUL
+    constexpr auto with_nul = cx::make_asset("hello", hello);
+    static_assert(with_nul.size() == 13, "make_asset from an array");
+    static_assert(!same_sha256(with_nul.digest(), hello_asset.digest()),
+                  "make_asset from an array");
+  }
+
+  // verification hashes the bytes at runtime
+  {
+    assert(hello_asset.verify());
+    assert(hello_md5.verify());
+    assert(!corrupt_asset.verify());
+  }
+
+  // lazy verification on first access
+  {
+    cx::lazy_asset<> a(hello_asset);
+    assert(a.size() == 12);
+    assert(a.data() == hello);
+    assert(a.data() == hello);
+
+    cx::lazy_asset<cx::asset_md5> m(hello_md5);
+    assert(m.data() == hello);
+
+    cx::lazy_asset<> c(corrupt_asset);
+    bool thrown = false;
+    try { c.data(); } catch (const cx::asset_error&) { thrown = true; }
+    assert(thrown);
+    // and every time after
+    thrown = false;
+    try { c.data(); } catch (const cx::asset_error&) { thrown = true; }
+    assert(thrown);
+  }
+
+  // background verification
+  {
+    cx::lazy_asset<> a(hello_asset);
+    a.verify_in_background();
+    a.verify_in_background();
+    assert(a.data() == hello);
+
+    cx::lazy_asset<> c(corrupt_asset);
+    c.verify_in_background();
+    bool thrown = false;
+    try { c.data(); } catch (const cx::asset_error&) { thrown = true; }
+    assert(thrown);
+
+    // started but never accessed: the destructor waits for it
+    cx::lazy_asset<> unused(hello_asset);
+    unused.verify_in_background();
+  }
+
+  // concurrent first accesses verify once and all see the bytes
+  {
+    cx::lazy_asset<> a(hello_asset);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+      threads.emplace_back([&a] { assert(a.data() == hello); });
+    }
+    for (auto& t : threads) t.join();
+  }
+}
@@ -1,7 +1,68 @@
+#include <cx_blake2s.h>
+#include <cx_crc32.h>
 #include <cx_fnv1.h>
+#include <cx_hash_value.h>
+#include <cx_hmac.h>
 #include <cx_md5.h>
+#include <cx_md5_file.h>
 #include <cx_murmur3.h>
+#include <cx_rolling_hash.h>
 #include <cx_sha256.h>
+#include <cx_sha256_tree.h>
+#include <cx_sha512.h>
+#include <cx_siphash.h>
+#include <cx_xxhash.h>
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+  // compare a digest with its conventional (big-endian) words
+  template <typename T, typename W, size_t N>
+  constexpr bool digest_is(const T& sum, const W (&words)[N], size_t i = 0)
+  {
+    return i == N ||
+      (cx::endianswap(sum.h[i]) == words[i] && digest_is(sum, words, i + 1));
+  }
+
+  // a patterned buffer, long enough for the xxh3 block loop
+  struct pattern
+  {
+    char s[3000];
+  };
+  constexpr pattern make_pattern()
+  {
+    pattern p{};
+    for (size_t i = 0; i < sizeof(p.s); ++i)
+    {
+      p.s[i] = static_cast<char>(i * 7 + 0x80);
+    }
+    return p;
+  }
+  constexpr pattern xxh_pattern = make_pattern();
+
+  // integer arrays for hash_value, long enough for the block loop
+  template <typename T, size_t ...Is>
+  constexpr cx::array<T, sizeof...(Is)> spread(std::index_sequence<Is...>)
+  {
+    return { static_cast<T>(Is * 0x9e3779b97f4a7c15ull)... };
+  }
+
+  // a struct hashed through hash_combine (and found by ADL)
+  struct point
+  {
+    int x;
+    int y;
+  };
+  constexpr uint32_t hash_value(const point& p)
+  {
+    return cx::hash_combine(p.x, p.y);
+  }
+}
 
 void test_cx_hash()
 {
@@ -11,6 +72,44 @@ void test_cx_hash()
                 "fnv1(\"hello, world\")");
   static_assert(cx::fnv1a("hello, world") == 1702823495152329533ull,
                 "fnv1a(\"hello, world\")");
+  static_assert(cx::fnv1a_32("hello, world") == 0x4d0ea41d,
+                "fnv1a_32(\"hello, world\")");
+  static_assert(cx::fnv1a_128("hello, world").h[0] == 0x4f2ea20cf73dcc0full &&
+                cx::fnv1a_128("hello, world").h[1] == 0xf0d6a3624cd26605ull,
+                "fnv1a_128(\"hello, world\")");
+
+  // binary data (embedded NUL, bytes >= 0x80)
+  static_assert(cx::fnv1("\x00\xff\x80" "abc\x00", 7) == 7710594183047493766ull,
+                "fnv1(binary)");
+  static_assert(cx::fnv1a("\x00\xff\x80" "abc\x00", 7) == 9792675402552553472ull,
+                "fnv1a(binary)");
+  static_assert(cx::fnv1a_32("\x00\xff\x80" "abc\x00", 7) == 0xd4aba500,
+                "fnv1a_32(binary)");
+  static_assert(cx::fnv1a_128("\x00\xff\x80" "abc\x00", 7).h[0] == 0x30c1c563874ff78cull &&
+                cx::fnv1a_128("\x00\xff\x80" "abc\x00", 7).h[1] == 0x136ced44aa3c5440ull,
+                "fnv1a_128(binary)");
+
+  // strings much longer than the max recursion depth
+#define CX_FNV_TEST_2(s) s s
+#define CX_FNV_TEST_8(s) CX_FNV_TEST_2(CX_FNV_TEST_2(CX_FNV_TEST_2(s)))
+#define CX_FNV_TEST_128(s) CX_FNV_TEST_2(CX_FNV_TEST_8(CX_FNV_TEST_8(s)))
+#define CX_FNV_TEST_LONG CX_FNV_TEST_128("the quick brown fox jumps over the lazy dog\n")
+  static_assert(cx::strlen(CX_FNV_TEST_LONG) == 5632, "fnv long string");
+  static_assert(cx::fnv1(CX_FNV_TEST_LONG) == 17257184670118778917ull,
+                "fnv1(long string)");
+  static_assert(cx::fnv1a(CX_FNV_TEST_LONG) == 10781541692361731109ull,
+                "fnv1a(long string)");
+  static_assert(cx::fnv1a(CX_FNV_TEST_LONG, 5632) == 10781541692361731109ull,
+                "fnv1a(long string)");
+  static_assert(cx::fnv1a_32(CX_FNV_TEST_LONG) == 0xc6ad66c5,
+                "fnv1a_32(long string)");
+  static_assert(cx::fnv1a_128(CX_FNV_TEST_LONG).h[0] == 0x72c0bd952f3a9b9cull &&
+                cx::fnv1a_128(CX_FNV_TEST_LONG).h[1] == 0x770fb6e2ef9aee8dull,
+                "fnv1a_128(long string)");
+#undef CX_FNV_TEST_LONG
+#undef CX_FNV_TEST_128
+#undef CX_FNV_TEST_8
+#undef CX_FNV_TEST_2
 
   //----------------------------------------------------------------------------
   // Murmur3
@@ -26,6 +125,299 @@ void test_cx_hash()
                 "murmur3(\"hello, world\")");
   static_assert(cx::murmur3_32("hello, world", 1) == 1868346089,
                 "murmur3(\"hello, world\")");
+  static_assert(cx::murmur3_32("\x00\xff\x80" "abc\x00", 7, 0) == 2103387819,
+                "murmur3(binary)");
+  static_assert(cx::murmur3_32("hello, world", 12, 0) == 345750399,
+                "murmur3(\"hello, world\")");
+
+  // Murmur3 (runtime): binary keys of every length, singly and in bulk
+  {
+    uint32_t words[16];
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+      words[i] = i * 0x9e3779b9u;
+    }
+    cx::byte_view keys[61];
+    uint32_t hashes[61];
+    for (size_t i = 0; i < 61; ++i)
+    {
+      keys[i] = { reinterpret_cast<const char*>(words) + i % 3, i };
+    }
+    cx::murmur3_32_many(keys, 61, 42, hashes);
+    for (size_t i = 0; i < 61; ++i)
+    {
+      const uint32_t h = cx::murmur3_32(static_cast<const void*>(keys[i].data), i, 42);
+      assert(hashes[i] == h);
+      assert(h == cx::runtime::murmur3_32(keys[i].data, i, 42));
+    }
+  }
+
+  static_assert(cx::murmur3_x64_128("hello, world", 0).h[0] == 0x342fac623a5ebc8eull &&
+                cx::murmur3_x64_128("hello, world", 0).h[1] == 0x4cdcbc079642414dull,
+                "murmur3_x64_128(\"hello, world\")");
+  static_assert(cx::murmur3_x64_128("hello, world", 1).h[0] == 0x8b95f808840725c6ull &&
+                cx::murmur3_x64_128("hello, world", 1).h[1] == 0x1597ed5422bd493bull,
+                "murmur3_x64_128(\"hello, world\")");
+  static_assert(cx::murmur3_x64_128("The quick brown fox jumps over the lazy dog", 0).h[0]
+                == 0xe34bbc7bbc071b6cull &&
+                cx::murmur3_x64_128("The quick brown fox jumps over the lazy dog", 0).h[1]
+                == 0x7a433ca9c49a9347ull,
+                "murmur3_x64_128(\"The quick brown fox jumps over the lazy dog\")");
+  static_assert(cx::murmur3_x64_128("\x00\xff\x80" "abc\x00", 7, 0).h[0] == 0xcc6746d22ef4c7b8ull &&
+                cx::murmur3_x64_128("\x00\xff\x80" "abc\x00", 7, 0).h[1] == 0x5eec3e6e49f13da0ull,
+                "murmur3_x64_128(binary)");
+
+  static_assert(cx::murmur3_x86_128("hello, world", 0).h[0] == 0x8b21605c &&
+                cx::murmur3_x86_128("hello, world", 0).h[1] == 0xb9b98a1e &&
+                cx::murmur3_x86_128("hello, world", 0).h[2] == 0x93273a83 &&
+                cx::murmur3_x86_128("hello, world", 0).h[3] == 0xeb5957c7,
+                "murmur3_x86_128(\"hello, world\")");
+  static_assert(cx::murmur3_x86_128("hello, world", 1).h[0] == 0xa9de3b94 &&
+                cx::murmur3_x86_128("hello, world", 1).h[1] == 0xdfefa397 &&
+                cx::murmur3_x86_128("hello, world", 1).h[2] == 0x535dd6d6 &&
+                cx::murmur3_x86_128("hello, world", 1).h[3] == 0x32f08bd1,
+                "murmur3_x86_128(\"hello, world\")");
+  static_assert(cx::murmur3_x86_128("The quick brown fox jumps over the lazy dog", 0).h[0]
+                == 0x2f1583c3 &&
+                cx::murmur3_x86_128("The quick brown fox jumps over the lazy dog", 0).h[3]
+                == 0xe5e91d2c,
+                "murmur3_x86_128(\"The quick brown fox jumps over the lazy dog\")");
+  static_assert(cx::murmur3_x86_128("\x00\xff\x80" "abc\x00", 7, 0).h[0] == 0xc5fe7ce8 &&
+                cx::murmur3_x86_128("\x00\xff\x80" "abc\x00", 7, 0).h[1] == 0x3a2a2aaa &&
+                cx::murmur3_x86_128("\x00\xff\x80" "abc\x00", 7, 0).h[2] == 0xaec72f0e &&
+                cx::murmur3_x86_128("\x00\xff\x80" "abc\x00", 7, 0).h[3] == 0xaec72f0e,
+                "murmur3_x86_128(binary)");
+
+  //----------------------------------------------------------------------------
+  // hash_value, hash_combine: integers hash as murmur3_32 of their bytes, and
+  // combining is murmur3_32 of the values' hashes, so combining two values is
+  // hashing a 64-bit integer made of their hashes
+  static_assert(cx::hash_value(0x64636261u) == cx::murmur3_32("abcd", 0), "hash_value(uint32_t)");
+  static_assert(cx::hash_value(char{'a'}) == cx::hash_value(0x61), "hash_value(char)");
+  static_assert(cx::hash_value(0x6867666564636261ll) == cx::murmur3_32("abcdefgh", 0),
+                "hash_value(int64_t)");
+  static_assert(cx::hash_value("hello, world") == cx::murmur3_32("hello, world", 0),
+                "hash_value(string)");
+  static_assert(cx::hash_combine(1u, 2u)
+                == cx::hash_value(uint64_t{cx::hash_value(2u)} << 32 | cx::hash_value(1u)),
+                "hash_combine");
+  static_assert(cx::hash_combine() == cx::murmur3_32("", 0), "hash_combine()");
+  static_assert(cx::hash_combine(1, 2) != cx::hash_combine(2, 1)
+                && cx::hash_combine(1, 1) != cx::hash_combine(2, 2)
+                && cx::hash_combine(1, 2) != cx::hash_combine(1, 2, 0),
+                "hash_combine order and length");
+  static_assert(cx::hash_value(cx::pair<int, const char*>{ 1, "a" })
+                == cx::hash_combine(1, "a"), "hash_value(pair)");
+  static_assert(cx::hash_value(cx::array<int, 3>{ 1, 2, 3 }) == cx::hash_combine(1, 2, 3),
+                "hash_value(array)");
+  static_assert(cx::hash_combine(point{ 1, 2 }, 3) != cx::hash_combine(point{ 2, 1 }, 3)
+                && cx::hash_value(cx::array<point, 2>{ point{ 1, 2 }, point{ 3, 4 } })
+                == cx::hash_combine(point{ 1, 2 }, point{ 3, 4 }),
+                "hash_value(struct)");
+
+  // hash_value (runtime): integer arrays (through each kernel that this cpu
+  // supports) and other arrays agree with the constexpr version
+  {
+    constexpr auto a32 = spread<int32_t>(std::make_index_sequence<300>());
+    constexpr auto a64 = spread<uint64_t>(std::make_index_sequence<300>());
+    constexpr auto a16 = spread<int16_t>(std::make_index_sequence<300>());
+    constexpr auto ap = cx::array<cx::pair<long long, int>, 2>{
+      cx::pair<long long, int>{ -1, 1 }, cx::pair<long long, int>{ 2, -2 } };
+    constexpr uint32_t h32 = cx::hash_value(a32);
+    constexpr uint32_t h64 = cx::hash_value(a64);
+    constexpr uint32_t h16 = cx::hash_value(a16);
+    constexpr uint32_t hp = cx::hash_value(ap);
+    assert(cx::runtime::array_hash(a32) == h32);
+    assert(cx::runtime::array_hash(a64) == h64);
+    assert(cx::runtime::array_hash(a16) == h16);
+    assert(cx::runtime::array_hash(ap) == hp);
+
+    namespace hv = cx::runtime::detail_hash_value;
+    struct impl { bool supported; hv::mix_fn mix32; hv::mix_fn mix64; };
+    const impl impls[] = {
+      { true, hv::scalar::mix32, hv::scalar::mix64 },
+#if CX_X86_SIMD
+      { cx::runtime::cpu().avx2, hv::avx2::mix32, hv::avx2::mix64 },
+#endif
+    };
+    const char* p32 = reinterpret_cast<const char*>(a32.begin());
+    const char* p64 = reinterpret_cast<const char*>(a64.begin());
+    for (const impl& m : impls)
+    {
+      if (!m.supported) continue;
+      assert(cx::detail::hashv::finish(m.mix32(0, p32, 300), 300) == h32);
+      assert(cx::detail::hashv::finish(m.mix64(0, p64, 300), 300) == h64);
+      for (size_t n = 0; n <= 300; n += 13)
+      {
+        assert(m.mix32(7, p32, n) == hv::scalar::mix32(7, p32, n));
+        assert(m.mix64(7, p64, n) == hv::scalar::mix64(7, p64, n));
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // xxHash
+  static_assert(cx::xxh32("", 0) == 0x02cc5d05, "xxh32(\"\")");
+  static_assert(cx::xxh32("abc", 0) == 0x32d153ff, "xxh32(\"abc\")");
+  static_assert(cx::xxh32("hello, world1234", 0) == 0x00c1b534,
+                "xxh32(\"hello, world1234\")");
+  static_assert(cx::xxh32("The quick brown fox jumps over the lazy dog", 1) == 0x234f8471,
+                "xxh32(\"The quick brown fox jumps over the lazy dog\")");
+  static_assert(cx::xxh32("\x00\xff\x80" "abc\x00", 7, 0) == 0x2c3e777e,
+                "xxh32(binary)");
+
+  static_assert(cx::xxh64("", 0) == 0xef46db3751d8e999ull, "xxh64(\"\")");
+  static_assert(cx::xxh64("abc", 0) == 0x44bc2cf5ad770999ull, "xxh64(\"abc\")");
+  static_assert(cx::xxh64("hello, world", 1) == 0x8c84c1733f502e85ull,
+                "xxh64(\"hello, world\")");
+  static_assert(cx::xxh64("The quick brown fox jumps over the lazy dog", 0)
+                == 0x0b242d361fda71bcull,
+                "xxh64(\"The quick brown fox jumps over the lazy dog\")");
+  static_assert(cx::xxh64("\x00\xff\x80" "abc\x00", 7, 0) == 0xa550a43a42b75c82ull,
+                "xxh64(binary)");
+
+  // xxh3_64 has a separate path for each range of lengths
+  static_assert(cx::xxh3_64("", 0) == 0x2d06800538d394c2ull, "xxh3_64(\"\")");
+  static_assert(cx::xxh3_64("abc", 0) == 0x78af5f94892f3950ull, "xxh3_64(\"abc\")");
+  static_assert(cx::xxh3_64("abc", 1) == 0x6b4467b443c76228ull, "xxh3_64(\"abc\")");
+  static_assert(cx::xxh3_64("\x00\xff\x80" "abc\x00", 7, 1) == 0x187b834b4082462full,
+                "xxh3_64(binary)");
+  static_assert(cx::xxh3_64("hello, world", 1) == 0x12009fe09bc44ae6ull,
+                "xxh3_64(\"hello, world\")");
+  static_assert(cx::xxh3_64("hello, world1234", 0) == 0xf375d74d84bd303aull,
+                "xxh3_64(\"hello, world1234\")");
+  static_assert(cx::xxh3_64("The quick brown fox jumps over the lazy dog", 1)
+                == 0x1e098210b55fad4aull,
+                "xxh3_64(\"The quick brown fox jumps over the lazy dog\")");
+  static_assert(cx::xxh3_64(xxh_pattern.s, 160, 0) == 0xb84455538084a857ull,
+                "xxh3_64(160 bytes)");
+  static_assert(cx::xxh3_64(xxh_pattern.s, 241, 42) == 0x3362038a7a721f5eull,
+                "xxh3_64(241 bytes)");
+  static_assert(cx::xxh3_64(xxh_pattern.s, 1025, 42) == 0x110b700d648aeac7ull,
+                "xxh3_64(1025 bytes)");
+  static_assert(cx::xxh3_64(xxh_pattern.s, 3000, 42) == 0x78a803db81246d68ull,
+                "xxh3_64(3000 bytes)");
+
+  // each xxh3 stripe kernel must agree with the constexpr version on long
+  // inputs, seeded and unseeded
+  struct impl_xxh3 { bool supported; cx::runtime::xxh3_accumulate_fn f; };
+  const impl_xxh3 impls_xxh3[] = {
+    { true, cx::runtime::xxh3_accumulate<cx::runtime::detail_xxh3::scalar> },
+#if CX_X86_SIMD
+    { cx::runtime::cpu().sse2, cx::runtime::xxh3_accumulate<cx::runtime::detail_xxh3::sse2> },
+    { cx::runtime::cpu().avx2, cx::runtime::xxh3_accumulate<cx::runtime::detail_xxh3::avx2> },
+#endif
+  };
+  for (const impl_xxh3& m : impls_xxh3)
+  {
+    if (!m.supported) continue;
+    for (size_t len = 241; len <= sizeof(xxh_pattern.s); len += 61)
+    {
+      uint64_t acc[8];
+      const cx::detail::xxh::acc8 a = cx::detail::xxh::init_acc();
+      std::memcpy(acc, a.a, sizeof(acc));
+      m.f(acc, xxh_pattern.s, len, cx::detail::xxh::secret);
+      const cx::detail::xxh::acc8 r = cx::detail::xxh::accumulate_long(
+          a, xxh_pattern.s, len, 0, (len - 1) / cx::detail::xxh::block_len);
+      assert(std::memcmp(acc, r.a, sizeof(acc)) == 0);
+    }
+  }
+  for (size_t len = 0; len <= sizeof(xxh_pattern.s); len += 13)
+  {
+    const char* s = xxh_pattern.s;
+    assert(cx::runtime::xxh3_64(s, len, 42) == cx::detail::xxh::xxh3_64(s, len, 42));
+    assert(cx::runtime::xxh3_64(s, len, 0) == cx::detail::xxh::xxh3_64(s, len, 0));
+    assert(cx::runtime::xxh64(s, len, 42) == cx::detail::xxh::xxh64(s, len, 42));
+    assert(cx::runtime::xxh32(s, len, 42) == cx::detail::xxh::xxh32(s, len, 42));
+  }
+
+  //----------------------------------------------------------------------------
+  // CRC32 / CRC32C
+  static_assert(cx::crc32_tables<cx::crc32_poly>::slices[1] == 0x77073096 &&
+                cx::crc32_tables<cx::crc32c_poly>::slices[1] == 0xf26b8303,
+                "crc32 tables");
+  static_assert(cx::crc32("") == 0 && cx::crc32c("") == 0, "crc32(\"\")");
+  static_assert(cx::crc32("a") == 0xe8b7be43, "crc32(\"a\")");
+  static_assert(cx::crc32("123456789") == 0xcbf43926, "crc32(\"123456789\")");
+  static_assert(cx::crc32("The quick brown fox jumps over the lazy dog") == 0x414fa339,
+                "crc32(\"The quick brown fox jumps over the lazy dog\")");
+  static_assert(cx::crc32("\x00\xff\x80" "abc\x00", 7) == 0x4e57736c, "crc32(binary)");
+  static_assert(cx::crc32c("a") == 0xc1d04330, "crc32c(\"a\")");
+  static_assert(cx::crc32c("123456789") == 0xe3069283, "crc32c(\"123456789\")");
+  static_assert(cx::crc32c("The quick brown fox jumps over the lazy dog") == 0x22620404,
+                "crc32c(\"The quick brown fox jumps over the lazy dog\")");
+  static_assert(cx::crc32c("\x00\xff\x80" "abc\x00", 7) == 0x18d4d486, "crc32c(binary)");
+  static_assert(cx::crc32(xxh_pattern.s, 3000) == 0x3152af46 &&
+                cx::crc32c(xxh_pattern.s, 3000) == 0xf92310b1,
+                "crc32(3000 bytes)");
+
+  // the crc32 instruction version must agree with slicing-by-8, including
+  // across the lengths where it interleaves three streams
+  {
+    std::vector<char> buf(3 * 8192 * 2 + 3 * 256 + 100);
+    for (size_t i = 0; i < buf.size(); ++i)
+    {
+      buf[i] = static_cast<char>(i * 7 + 0x80);
+    }
+    assert(cx::runtime::crc32c(buf.data(), 3000) == 0xf92310b1);
+#if CX_X86_SIMD
+    if (cx::runtime::cpu().sse42)
+    {
+      for (size_t len = 0; len <= buf.size(); len += (len < 1000 ? 1 : 757))
+      {
+        assert(cx::runtime::crc32c_sse42(~0u, buf.data(), len)
+               == cx::runtime::crc32_slice8<cx::crc32c_poly>(~0u, buf.data(), len));
+      }
+      assert(cx::runtime::crc32c_sse42(~0u, buf.data(), buf.size())
+             == cx::runtime::crc32_slice8<cx::crc32c_poly>(~0u, buf.data(), buf.size()));
+    }
+#endif
+  }
+
+  //----------------------------------------------------------------------------
+  // SipHash (the reference test vectors use the key and messages 00 01 02 ...)
+  {
+    constexpr const char* bytes =
+      "\x00\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f"
+      "\x10\x11\x12\x13\x14\x15\x16\x17\x18\x19\x1a\x1b\x1c\x1d\x1e\x1f"
+      "\x20\x21\x22\x23\x24\x25\x26\x27\x28\x29\x2a\x2b\x2c\x2d\x2e\x2f"
+      "\x30\x31\x32\x33\x34\x35\x36\x37\x38\x39\x3a\x3b\x3c\x3d\x3e\x3f";
+    constexpr cx::siphash_key key = cx::make_siphash_key(bytes);
+    static_assert(key.k0 == 0x0706050403020100ull && key.k1 == 0x0f0e0d0c0b0a0908ull,
+                  "make_siphash_key");
+    static_assert(cx::siphash24(key, "") == 0x726fdb47dd0e0e31ull, "siphash24(\"\")");
+    static_assert(cx::siphash24(key, bytes, 15) == 0xa129ca6149be45e5ull,
+                  "siphash24(15 bytes)");
+    static_assert(cx::siphash24(key, bytes, 63) == 0x958a324ceb064572ull,
+                  "siphash24(63 bytes)");
+    static_assert(cx::siphash24(key, "hello, world") == 0x5222c673f3faebb2ull,
+                  "siphash24(\"hello, world\")");
+    static_assert(cx::siphash24(key, xxh_pattern.s, 3000) == 0x07f78742715c73ddull,
+                  "siphash24(3000 bytes)");
+    static_assert(cx::siphash13(key, "") == 0xabac0158050fc4dcull, "siphash13(\"\")");
+    static_assert(cx::siphash13(key, bytes, 63) == 0x9d199062b7bbb3a8ull,
+                  "siphash13(63 bytes)");
+    static_assert(cx::siphash13(key, "hello, world") == 0xc657a05e198bb2b6ull,
+                  "siphash13(\"hello, world\")");
+    static_assert(cx::siphash13(key, xxh_pattern.s, 3000) == 0xed9b158b9b162c8aull,
+                  "siphash13(3000 bytes)");
+
+    // keys drawn at compile time differ by seed (and so by build and line)
+    constexpr cx::siphash_key k1 = cx::siphash_keygen<1>();
+    constexpr cx::siphash_key k2 = cx::siphash_keygen<2>();
+    static_assert(k1.k0 != k2.k0 && k1.k1 != k2.k1 && k1.k0 != k1.k1, "siphash_keygen");
+    constexpr cx::siphash_key k3 = cx_siphash_key;
+    static_assert(cx::siphash13(k3, "a") != cx::siphash13(key, "a"), "cx_siphash_key");
+
+    for (size_t len = 0; len <= sizeof(xxh_pattern.s); len += 13)
+    {
+      const char* s = xxh_pattern.s;
+      assert(cx::runtime::siphash24(k3, s, len)
+             == (cx::detail::siphash::siphash<2, 4>(k3, s, len)));
+      assert(cx::runtime::siphash13(k3, s, len)
+             == (cx::detail::siphash::siphash<1, 3>(k3, s, len)));
+    }
+  }
 
   //----------------------------------------------------------------------------
   constexpr const char* const testinputs[8] = {
@@ -93,6 +485,78 @@ void test_cx_hash()
                 cx::endianswap(cx::md5(testinputs[7]).h[3]) == md5sums[7].h[3],
                 "md5(\"hello, world\")");
 
+  // MD5 of binary data (embedded NUL, bytes >= 0x80)
+  constexpr cx::md5sum md5binsum = { { 0xf3d2f8e5, 0x51b63408, 0xcda9c34d, 0x5c4aa88e } };
+  static_assert(cx::endianswap(cx::md5("\x00\xff\x80" "abc\x00", 7).h[0]) == md5binsum.h[0] &&
+                cx::endianswap(cx::md5("\x00\xff\x80" "abc\x00", 7).h[1]) == md5binsum.h[1] &&
+                cx::endianswap(cx::md5("\x00\xff\x80" "abc\x00", 7).h[2]) == md5binsum.h[2] &&
+                cx::endianswap(cx::md5("\x00\xff\x80" "abc\x00", 7).h[3]) == md5binsum.h[3],
+                "md5(binary)");
+
+  // MD5 (streaming): feeding the input in uneven chunks gives the same digest
+  // as the constexpr version
+  for (int i = 0; i < 8; ++i)
+  {
+    const char* s = testinputs[i];
+    const size_t len = std::strlen(s);
+    cx::md5_ctx ctx;
+    for (size_t pos = 0, chunk = 1; pos < len; pos += chunk, chunk = chunk * 2 + 1)
+    {
+      ctx.update(s + pos, len - pos < chunk ? len - pos : chunk);
+    }
+    const cx::md5sum sum = ctx.final();
+    for (int j = 0; j < 4; ++j)
+    {
+      assert(cx::endianswap(sum.h[j]) == md5sums[i].h[j]);
+    }
+  }
+
+  // MD5 (files): whole-file digests, singly and concurrently, match the
+  // digests of the same bytes in memory
+  {
+    const char* const paths[4] = {
+      "cx_hash_test0.tmp", "cx_hash_test1.tmp", "cx_hash_test2.tmp", "cx_hash_test3.tmp"
+    };
+    const size_t sizes[4] = { 0, 3, 64, 100003 };
+    std::vector<char> data(sizes[3]);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+      data[i] = static_cast<char>(i * 31 + (i >> 8));
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+      std::FILE* f = std::fopen(paths[i], "wb");
+      assert(f);
+      std::fwrite(data.data(), 1, sizes[i], f);
+      std::fclose(f);
+    }
+
+    cx::md5sum sums[4];
+    cx::md5_files(paths, 4, sums);
+    for (int i = 0; i < 4; ++i)
+    {
+      const cx::md5sum expected = cx::runtime::md5(data.data(), sizes[i]);
+      const cx::md5sum single = cx::md5_file(paths[i]);
+      for (int j = 0; j < 4; ++j)
+      {
+        assert(sums[i].h[j] == expected.h[j]);
+        assert(single.h[j] == expected.h[j]);
+      }
+      std::remove(paths[i]);
+    }
+
+    bool threw = false;
+    try
+    {
+      cx::md5_file("cx_hash_test_missing.tmp");
+    }
+    catch (const std::system_error&)
+    {
+      threw = true;
+    }
+    assert(threw);
+  }
+
   //----------------------------------------------------------------------------
   // SHA256
   constexpr cx::sha256sum sha256sums[8] =  {
@@ -186,4 +650,522 @@ void test_cx_hash()
                 cx::endianswap(cx::sha256(testinputs[7]).h[6]) == sha256sums[7].h[6] &&
                 cx::endianswap(cx::sha256(testinputs[7]).h[7]) == sha256sums[7].h[7],
                 "sha256(\"hello, world\")");
+
+  //----------------------------------------------------------------------------
+  // SHA256 of binary data (embedded NUL, bytes >= 0x80)
+  constexpr cx::sha256sum binsum = { { 0x873e9096, 0x6c0cfb42, 0x1e368efb, 0x3f6fe2ac,
+                                       0xd63e4370, 0x8b3c32ae, 0x72446a95, 0xe174e01d } };
+  static_assert(cx::endianswap(cx::sha256("\x00\xff\x80" "abc\x00", 7).h[0]) == binsum.h[0] &&
+                cx::endianswap(cx::sha256("\x00\xff\x80" "abc\x00", 7).h[3]) == binsum.h[3] &&
+                cx::endianswap(cx::sha256("\x00\xff\x80" "abc\x00", 7).h[7]) == binsum.h[7],
+                "sha256(binary)");
+
+  //----------------------------------------------------------------------------
+  // SHA256 (streaming): feeding the input in uneven chunks gives the same
+  // digest as the constexpr version
+  for (int i = 0; i < 8; ++i)
+  {
+    const char* s = testinputs[i];
+    const size_t len = std::strlen(s);
+    cx::sha256_ctx ctx;
+    ctx.update(nullptr, 0);
+    for (size_t pos = 0, chunk = 1; pos < len; pos += chunk, chunk = chunk * 2 + 1)
+    {
+      ctx.update(s + pos, len - pos < chunk ? len - pos : chunk);
+    }
+    const cx::sha256sum sum = ctx.final();
+    for (int j = 0; j < 8; ++j)
+    {
+      assert(cx::endianswap(sum.h[j]) == sha256sums[i].h[j]);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // SHA256 (runtime): every padding case (one final block or two) agrees with
+  // the constexpr functions, evaluated here at runtime
+  {
+    char buf[130];
+    for (size_t i = 0; i < sizeof(buf); ++i)
+    {
+      buf[i] = static_cast<char>(i * 11 + 0x80);
+    }
+    for (size_t len = 0; len <= sizeof(buf); ++len)
+    {
+      const cx::sha256sum sum = cx::runtime::sha256(buf, len);
+      const cx::sha256sum expected = cx::detail::sha256::sha256tole(
+          cx::detail::sha256::sha256withlen(buf, static_cast<int>(len)));
+      for (int j = 0; j < 8; ++j)
+      {
+        assert(sum.h[j] == expected.h[j]);
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // SHA256 block functions: each one that this cpu supports must produce the
+  // test vectors from a (manually) padded message
+  struct impl { bool supported; cx::runtime::sha256blocks_fn f; };
+  const impl impls[] = {
+    { true, cx::runtime::sha256blocks_scalar },
+#if CX_X86_SIMD
+    { cx::runtime::cpu().ssse3, cx::runtime::sha256blocks_ssse3 },
+    { cx::runtime::cpu().avx2, cx::runtime::sha256blocks_avx2 },
+    { cx::runtime::cpu().sha && cx::runtime::cpu().sse41,
+      cx::runtime::sha256blocks_shani },
+#endif
+  };
+  for (const impl& m : impls)
+  {
+    if (!m.supported) continue;
+    for (int i = 0; i < 8; ++i)
+    {
+      const size_t len = std::strlen(testinputs[i]);
+      const size_t nblocks = (len + 8) / 64 + 1;
+      char buf[3 * 64] = {};
+      std::memcpy(buf, testinputs[i], len);
+      buf[len] = static_cast<char>(0x80);
+      for (size_t j = 0; j < 8; ++j)
+      {
+        buf[nblocks * 64 - 1 - j] = static_cast<char>((len * 8) >> (8 * j));
+      }
+      cx::sha256sum sum = cx::detail::sha256::init();
+      m.f(sum, buf, nblocks);
+      for (int j = 0; j < 8; ++j)
+      {
+        assert(sum.h[j] == sha256sums[i].h[j]);
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // SHA256 (multi-buffer): a batch gives the same digests as one at a time;
+  // lengths 0..199 cover every padding case and lane refill
+  {
+    cx::byte_view views[8];
+    cx::sha256sum sums[8];
+    for (int i = 0; i < 8; ++i)
+    {
+      views[i] = { testinputs[i], std::strlen(testinputs[i]) };
+    }
+    cx::sha256_many(views, 8, sums);
+    for (int i = 0; i < 8; ++i)
+    {
+      for (int j = 0; j < 8; ++j)
+      {
+        assert(cx::endianswap(sums[i].h[j]) == sha256sums[i].h[j]);
+      }
+    }
+
+    char buf[200];
+    cx::byte_view batch[200];
+    cx::sha256sum batchsums[200];
+    for (int i = 0; i < 200; ++i)
+    {
+      buf[i] = static_cast<char>(i * 7 + 0x80);
+      batch[i] = { buf + (i * 13) % (200 - i), static_cast<size_t>(i) };
+    }
+    cx::sha256sum sums1[200];
+    for (int i = 0; i < 200; ++i)
+    {
+      sums1[i] = cx::runtime::sha256(batch[i].data, batch[i].size);
+    }
+    const auto check = [&] {
+      for (int i = 0; i < 200; ++i)
+      {
+        for (int j = 0; j < 8; ++j)
+        {
+          assert(batchsums[i].h[j] == sums1[i].h[j]);
+        }
+      }
+    };
+    cx::sha256_many(batch, 200, batchsums);
+    check();
+
+    // (sha256_many doesn't use lanes on a cpu with the SHA extensions, so
+    // test each lane width this cpu supports directly)
+#if CX_X86_SIMD
+    if (cx::runtime::cpu().sse2)
+    {
+      cx::runtime::sha256_many_lanes<4>(batch, 200, batchsums, cx::runtime::sha256lanes4);
+      check();
+    }
+    if (cx::runtime::cpu().avx2)
+    {
+      cx::runtime::sha256_many_lanes<8>(batch, 200, batchsums, cx::runtime::sha256lanes8);
+      check();
+    }
+    if (cx::runtime::cpu().avx512f)
+    {
+      cx::runtime::sha256_many_lanes<16>(batch, 200, batchsums, cx::runtime::sha256lanes16);
+      check();
+    }
+#endif
+  }
+
+  //----------------------------------------------------------------------------
+  // SHA256 tree hash: a known root, then incremental updates (in place and
+  // resizing) must give the same root as hashing from scratch, as must the
+  // file version
+  {
+    constexpr uint32_t root1000[8] = {
+      0x74bfc23b, 0x47f896b8, 0x6336e5e6, 0x412d6ea7,
+      0x0201f858, 0xcf2e1bb6, 0xb5d9b2ca, 0x471b24e2 };
+    const cx::sha256sum r = cx::sha256_tree_hash(xxh_pattern.s, 1000, 100, 3);
+    assert(digest_is(r, root1000));
+
+    std::vector<char> data(xxh_pattern.s, xxh_pattern.s + 2000);
+    cx::sha256_tree tree(64);
+    tree.build(data.data(), data.size(), 3);
+    assert(tree.leaf_count() == 32);
+    const size_t edits[][2] = { { 0, 1 }, { 63, 2 }, { 500, 300 }, { 1999, 1 }, { 640, 0 } };
+    for (const auto& e : edits)
+    {
+      for (size_t i = e[0]; i < e[0] + e[1]; ++i)
+      {
+        data[i] = static_cast<char>(data[i] + 1);
+      }
+      tree.update(data.data(), data.size(), e[0], e[1], 3);
+      const cx::sha256sum root = tree.root();
+      const cx::sha256sum expected = cx::sha256_tree_hash(data.data(), data.size(), 64, 1);
+      assert(std::memcmp(&root, &expected, sizeof(root)) == 0);
+    }
+    const size_t sizes[] = { 2500, 2500, 130, 0, 64, 65, 1000 };
+    for (size_t size : sizes)
+    {
+      const size_t old = data.size();
+      data.resize(size, 'x');
+      tree.update(data.data(), data.size(), old < size ? old : size, 0, 3);
+      const cx::sha256sum root = tree.root();
+      const cx::sha256sum expected = cx::sha256_tree_hash(data.data(), data.size(), 64, 1);
+      assert(std::memcmp(&root, &expected, sizeof(root)) == 0);
+    }
+
+    const char* path = "cx_hash_tree_test.tmp";
+    std::FILE* f = std::fopen(path, "wb");
+    assert(f);
+    std::fwrite(data.data(), 1, data.size(), f);
+    std::fclose(f);
+    const cx::sha256sum root = tree.root();
+    const cx::sha256sum file = cx::sha256_tree_file(path, 64);
+    assert(std::memcmp(&root, &file, sizeof(root)) == 0);
+    std::remove(path);
+  }
+
+  //----------------------------------------------------------------------------
+  // Buzhash: rolling the window forward gives the hash of the new window
+  static_assert(cx::buzhash_table<>::values[0]
+                == cx::pcg::pcg32_output(cx::pcg::pcg32_advance(cx::buzhash_seed, 1)),
+                "buzhash_table");
+  static_assert(cx::buzhash("") == 0, "buzhash(\"\")");
+  static_assert(cx::buzhash_roll(cx::buzhash("abcd"), 4, 'a', 'e') == cx::buzhash("bcde"),
+                "buzhash_roll");
+  static_assert(cx::buzhash_roll(cx::buzhash(xxh_pattern.s, 48), 48, xxh_pattern.s[0],
+                                 xxh_pattern.s[48]) == cx::buzhash(xxh_pattern.s + 1, 48),
+                "buzhash_roll(48 bytes)");
+  for (size_t len = 0; len <= sizeof(xxh_pattern.s); len += 13)
+  {
+    assert(cx::runtime::buzhash(xxh_pattern.s, len)
+           == cx::detail::buzhash::buzhash(xxh_pattern.s, len));
+  }
+
+  // content-defined chunking: chunks tile the data within the size limits,
+  // and after an insertion near the start, the later chunks are unchanged
+  {
+    std::vector<char> data(64 * 1024);
+    uint64_t state = 1;
+    for (char& c : data)
+    {
+      state = cx::pcg::pcg32_advance(state);
+      c = static_cast<char>(cx::pcg::pcg32_output(state));
+    }
+    const cx::chunker chunker(256, 1024, 4096);
+    const std::vector<cx::chunk> chunks = chunker.split(data.data(), data.size(), 3);
+    size_t offset = 0;
+    for (const cx::chunk& c : chunks)
+    {
+      assert(c.offset == offset);
+      assert(c.size <= 4096 && (c.size >= 256 || offset + c.size == data.size()));
+      const cx::sha256sum digest = cx::runtime::sha256(data.data() + c.offset, c.size);
+      assert(std::memcmp(&digest, &c.digest, sizeof(digest)) == 0);
+      offset += c.size;
+    }
+    assert(offset == data.size() && chunks.size() > 16);
+
+    data.insert(data.begin() + 100, 'x');
+    const std::vector<cx::chunk> edited = chunker.split(data.data(), data.size(), 3);
+    size_t same = 0;
+    for (size_t i = 0; i < edited.size(); ++i)
+    {
+      const cx::chunk& e = edited[edited.size() - 1 - i];
+      const cx::chunk& c = chunks[chunks.size() - 1 - i];
+      if (std::memcmp(&e.digest, &c.digest, sizeof(e.digest)) != 0) break;
+      ++same;
+    }
+    assert(same + 2 >= chunks.size());
+  }
+
+  //----------------------------------------------------------------------------
+  // SHA224
+  constexpr uint32_t sha224_empty[7] = { 0xd14a028c, 0x2a3a2bc9, 0x476102bb,
+                                         0x288234c4, 0x15a2b01f, 0x828ea62a,
+                                         0xc5b3e42f };
+  constexpr uint32_t sha224_abc[7] = { 0x23097d22, 0x3405d822, 0x8642a477,
+                                       0xbda255b3, 0x2aadbce4, 0xbda0b3f7,
+                                       0xe36c9da7 };
+  static_assert(digest_is(cx::sha224(""), sha224_empty), "sha224(\"\")");
+  static_assert(digest_is(cx::sha224("abc"), sha224_abc), "sha224(\"abc\")");
+  static_assert(digest_is(cx::sha224("abcd", 3), sha224_abc), "sha224(\"abc\", 3)");
+
+  //----------------------------------------------------------------------------
+  // BLAKE2s (RFC 7693, and the reference implementation's keyed test vectors,
+  // whose key and messages are 00 01 02 ...)
+  constexpr uint32_t blake2s_empty[8] = {
+    0x69217a30, 0x79908094, 0xe11121d0, 0x42354a7c,
+    0x1f55b648, 0x2ca1a51e, 0x1b250dfd, 0x1ed0eef9 };
+  constexpr uint32_t blake2s_abc[8] = {
+    0x508c5e8c, 0x327c14e2, 0xe1a72ba3, 0x4eeb452f,
+    0x37458b20, 0x9ed63a29, 0x4d999b4c, 0x86675982 };
+  constexpr uint32_t blake2s_64[8] = {
+    0x4a5247bb, 0xd80f7c89, 0x6a377585, 0x83962deb,
+    0xbb5be5ce, 0x059ecd36, 0x134d219a, 0x9f32f3b3 };
+  constexpr uint32_t blake2s_65[8] = {
+    0xffe91e9d, 0x1b270438, 0x39b6347a, 0xe6c079e3,
+    0x2ce88ce3, 0x413cfd16, 0x295ee072, 0x25170514 };
+  constexpr uint32_t blake2s_3000[8] = {
+    0x59c88052, 0x831c9579, 0xfb597112, 0x60ecc2fb,
+    0xdcdbd03e, 0x07504a84, 0xeb92a31f, 0x05998c20 };
+  constexpr uint32_t blake2s_keyed_0[8] = {
+    0x48a8997d, 0xa407876b, 0x3d79c0d9, 0x2325ad3b,
+    0x89cbb754, 0xd86ab71a, 0xee047ad3, 0x45fd2c49 };
+  constexpr uint32_t blake2s_keyed_64[8] = {
+    0x8975b057, 0x7fd35566, 0xd750b362, 0xb0897a26,
+    0xc399136d, 0xf07babab, 0xbde6203f, 0xf2954ed4 };
+  constexpr uint32_t blake2s_keyed_65[8] = {
+    0x21fe0ceb, 0x0052be7f, 0xb0f00418, 0x7cacd7de,
+    0x67fa6eb0, 0x938d9276, 0x77f2398c, 0x132317a8 };
+  static_assert(digest_is(cx::blake2s(""), blake2s_empty), "blake2s(\"\")");
+  static_assert(digest_is(cx::blake2s("abc"), blake2s_abc), "blake2s(\"abc\")");
+  static_assert(digest_is(cx::blake2s("abcd", 3), blake2s_abc), "blake2s(\"abc\", 3)");
+  static_assert(digest_is(cx::blake2s(xxh_pattern.s, 64), blake2s_64), "blake2s(64 bytes)");
+  static_assert(digest_is(cx::blake2s(xxh_pattern.s, 65), blake2s_65), "blake2s(65 bytes)");
+  static_assert(digest_is(cx::blake2s(xxh_pattern.s, 3000), blake2s_3000),
+                "blake2s(3000 bytes)");
+  {
+    constexpr const char* bytes =
+      "\x00\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f"
+      "\x10\x11\x12\x13\x14\x15\x16\x17\x18\x19\x1a\x1b\x1c\x1d\x1e\x1f"
+      "\x20\x21\x22\x23\x24\x25\x26\x27\x28\x29\x2a\x2b\x2c\x2d\x2e\x2f"
+      "\x30\x31\x32\x33\x34\x35\x36\x37\x38\x39\x3a\x3b\x3c\x3d\x3e\x3f"
+      "\x40\x41\x42\x43\x44\x45\x46\x47\x48\x49\x4a\x4b\x4c\x4d\x4e\x4f";
+    static_assert(digest_is(cx::blake2s_keyed(bytes, 32, "", 0), blake2s_keyed_0),
+                  "blake2s_keyed(\"\")");
+    static_assert(digest_is(cx::blake2s_keyed(bytes, 32, bytes, 64), blake2s_keyed_64),
+                  "blake2s_keyed(64 bytes)");
+    static_assert(digest_is(cx::blake2s_keyed(bytes, 32, bytes, 65), blake2s_keyed_65),
+                  "blake2s_keyed(65 bytes)");
+    static_assert(digest_is(cx::blake2s_keyed("", 0, "abc", 3), blake2s_abc),
+                  "blake2s_keyed (empty key)");
+  }
+
+  // each compression function that this cpu supports must agree with the
+  // constexpr version
+  struct impl_blake2s { bool supported; cx::runtime::blake2s_compress_fn f; };
+  const impl_blake2s impls_blake2s[] = {
+    { true, cx::runtime::blake2s_compress },
+#if CX_X86_SIMD
+    { cx::runtime::cpu().sse41, cx::runtime::blake2s_compress_sse41 },
+#endif
+  };
+  for (const impl_blake2s& m : impls_blake2s)
+  {
+    if (!m.supported) continue;
+    for (size_t i = 0; i + 64 <= sizeof(xxh_pattern.s); i += 331)
+    {
+      const uint64_t t = i * 0x100000001ull;
+      const uint32_t f = i % 2 == 0 ? 0 : ~0u;
+      cx::blake2ssum sum = cx::detail::blake2s::init(i % 33);
+      const cx::blake2ssum expected = cx::detail::blake2s::compress(
+          sum, cx::detail::blake2s::load(xxh_pattern.s + i, 64), t, f);
+      m.f(sum, xxh_pattern.s + i, t, f);
+      for (int j = 0; j < 8; ++j)
+      {
+        assert(sum.h[j] == expected.h[j]);
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // HMAC-SHA256 (RFC 4231 test cases 1, 2 and 6)
+  constexpr uint32_t hmac_1[8] = {
+    0xb0344c61, 0xd8db3853, 0x5ca8afce, 0xaf0bf12b,
+    0x881dc200, 0xc9833da7, 0x26e9376c, 0x2e32cff7 };
+  static_assert(digest_is(cx::hmac_sha256("\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b"
+                                          "\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b",
+                                          "Hi There"), hmac_1),
+                "hmac_sha256(test case 1)");
+  constexpr uint32_t hmac_2[8] = {
+    0x5bdcc146, 0xbf60754e, 0x6a042426, 0x089575c7,
+    0x5a003f08, 0x9d273983, 0x9dec58b9, 0x64ec3843 };
+  constexpr cx::hmac_sha256_key jefe = cx::make_hmac_sha256_key("Jefe");
+  static_assert(digest_is(cx::hmac_sha256(jefe, "what do ya want for nothing?"), hmac_2),
+                "hmac_sha256(test case 2)");
+  constexpr uint32_t hmac_6[8] = {
+    0x60e43159, 0x1ee0b67f, 0x0d8a26aa, 0xcbf5b77f,
+    0x8e0bc621, 0x3728c514, 0x0546040f, 0x0ee37f54 };
+  static_assert(digest_is(cx::hmac_sha256(
+                              "\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa"
+                              "\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa"
+                              "\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa"
+                              "\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa"
+                              "\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa"
+                              "\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa"
+                              "\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa"
+                              "\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa\xaa"
+                              "\xaa\xaa\xaa",
+                              "Test Using Larger Than Block-Size Key - Hash Key First"), hmac_6),
+                "hmac_sha256(test case 6)");
+
+  // the runtime version must agree with the definition, hashing the padded
+  // keys and messages directly, for keys and messages of every padding case
+  for (size_t keylen = 0; keylen <= 130; keylen += 13)
+  {
+    const char* key = xxh_pattern.s;
+    const cx::hmac_sha256_key k = cx::runtime::make_hmac_sha256_key(key, keylen);
+    char k0[64] = {};
+    if (keylen > 64)
+    {
+      const cx::sha256sum d = cx::runtime::sha256(key, keylen);
+      std::memcpy(k0, d.h, sizeof(d.h));
+    }
+    else
+    {
+      std::memcpy(k0, key, keylen);
+    }
+    for (size_t len = 0; len <= 200; len += 7)
+    {
+      const char* msg = xxh_pattern.s + 500;
+      char inner[64 + 200];
+      char outer[64 + 32];
+      for (size_t i = 0; i < 64; ++i)
+      {
+        inner[i] = static_cast<char>(k0[i] ^ 0x36);
+        outer[i] = static_cast<char>(k0[i] ^ 0x5c);
+      }
+      std::memcpy(inner + 64, msg, len);
+      const cx::sha256sum d = cx::runtime::sha256(inner, 64 + len);
+      std::memcpy(outer + 64, d.h, sizeof(d.h));
+      const cx::sha256sum expected = cx::runtime::sha256(outer, sizeof(outer));
+      const cx::sha256sum m = cx::runtime::hmac_sha256(k, msg, len);
+      assert(std::memcmp(&m, &expected, sizeof(m)) == 0);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // SHA512, SHA384, SHA512/256
+  constexpr cx::sha512sum sha512sums[8] = {
+    { { 0xcf83e1357eefb8bdull, 0xf1542850d66d8007ull, 0xd620e4050b5715dcull,
+        0x83f4a921d36ce9ceull, 0x47d0d13c5d85f2b0ull, 0xff8318d2877eec2full,
+        0x63b931bd47417a81ull, 0xa538327af927da3eull } },
+    { { 0x1f40fc92da241694ull, 0x750979ee6cf582f2ull, 0xd5d7d28e18335de0ull,
+        0x5abc54d0560e0f53ull, 0x02860c652bf08d56ull, 0x0252aa5e74210546ull,
+        0xf369fbbbce8c12cfull, 0xc7957b2652fe9a75ull } },
+    { { 0xddaf35a193617abaull, 0xcc417349ae204131ull, 0x12e6fa4e89a97ea2ull,
+        0x0a9eeee64b55d39aull, 0x2192992a274fc1a8ull, 0x36ba3c23a3feebbdull,
+        0x454d4423643ce80eull, 0x2a9ac94fa54ca49full } },
+    { { 0x107dbf389d9e9f71ull, 0xa3a95f6c055b9251ull, 0xbc5268c2be16d6c1ull,
+        0x3492ea45b0199f33ull, 0x09e16455ab1e9611ull, 0x8e8a905d5597b720ull,
+        0x38ddb372a8982604ull, 0x6de66687bb420e7cull } },
+    { { 0x4dbff86cc2ca1baeull, 0x1e16468a05cb9881ull, 0xc97f1753bce36190ull,
+        0x34898faa1aabe429ull, 0x955a1bf8ec483d74ull, 0x21fe3c1646613a59ull,
+        0xed5441fb0f321389ull, 0xf77f48a879c7b1f1ull } },
+    { { 0x1e07be23c26a86eaull, 0x37ea810c8ec78093ull, 0x52515a970e9253c2ull,
+        0x6f536cfc7a9996c4ull, 0x5c8370583e0a78faull, 0x4a90041d71a4ceabull,
+        0x7423f19c71b9d5a3ull, 0xe01249f0bebd5894ull } },
+    { { 0x72ec1ef1124a45b0ull, 0x47e8b7c75a932195ull, 0x135bb61de24ec0d1ull,
+        0x914042246e0aec3aull, 0x2354e093d76f3048ull, 0xb456764346900cb1ull,
+        0x30d2a4fd5dd16abbull, 0x5e30bcb850dee843ull } },
+    { { 0x8710339dcb6814d0ull, 0xd9d2290ef422285cull, 0x9322b7163951f9a0ull,
+        0xca8f883d3305286full, 0x44139aa374848e41ull, 0x74f5aada663027e4ull,
+        0x548637b6d19894aeull, 0xc4fb6c46a139fbf9ull } }
+  };
+  static_assert(digest_is(cx::sha512(testinputs[0]), sha512sums[0].h), "sha512(\"\")");
+  static_assert(digest_is(cx::sha512(testinputs[1]), sha512sums[1].h), "sha512(\"a\")");
+  static_assert(digest_is(cx::sha512(testinputs[2]), sha512sums[2].h), "sha512(\"abc\")");
+  static_assert(digest_is(cx::sha512(testinputs[3]), sha512sums[3].h),
+                "sha512(\"message digest\")");
+  static_assert(digest_is(cx::sha512(testinputs[4]), sha512sums[4].h),
+                "sha512(\"abcdefghijklmnopqrstuvwxyz\")");
+  static_assert(digest_is(cx::sha512(testinputs[5]), sha512sums[5].h),
+                "sha512(\"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789\")");
+  static_assert(digest_is(cx::sha512(testinputs[6]), sha512sums[6].h),
+                "sha512(\"12345678901234567890123456789012345678901234567890123456789012345678901234567890\")");
+  static_assert(digest_is(cx::sha512(testinputs[7]), sha512sums[7].h),
+                "sha512(\"hello, world\")");
+
+  constexpr uint64_t sha512_bin[8] = {
+    0xa3c0e3fab0798a27ull, 0xf043e169cd176267ull, 0xc4877fa60d8c0be9ull,
+    0x061442d1493bc011ull, 0xc264351784402c8full, 0x4789cf50274a0674ull,
+    0xe1d30dae032d0abdull, 0x8adbfdcbfae4ec33ull };
+  static_assert(digest_is(cx::sha512("\x00\xff\x80" "abc\x00", 7), sha512_bin),
+                "sha512(binary)");
+
+  constexpr uint64_t sha384_abc[6] = {
+    0xcb00753f45a35e8bull, 0xb5a03d699ac65007ull, 0x272c32ab0eded163ull,
+    0x1a8b605a43ff5bedull, 0x8086072ba1e7cc23ull, 0x58baeca134c825a7ull };
+  static_assert(digest_is(cx::sha384("abc"), sha384_abc), "sha384(\"abc\")");
+  constexpr uint64_t sha512_256_abc[4] = {
+    0x53048e2681941ef9ull, 0x9b2e29b76b4c7dabull,
+    0xe4c2d0c634fc6d46ull, 0xe0e2f13107e7af23ull };
+  static_assert(digest_is(cx::sha512_256("abc"), sha512_256_abc),
+                "sha512_256(\"abc\")");
+
+  //----------------------------------------------------------------------------
+  // SHA512 block functions: as for SHA256, and each must agree with the
+  // scalar version over lengths that cover every padding case
+  struct impl512 { bool supported; cx::runtime::sha512blocks_fn f; };
+  const impl512 impls512[] = {
+    { true, cx::runtime::sha512blocks_scalar },
+#if CX_X86_SIMD
+    { cx::runtime::cpu().ssse3, cx::runtime::sha512blocks_ssse3 },
+    { cx::runtime::cpu().avx2, cx::runtime::sha512blocks_avx2 },
+#endif
+  };
+  char msg512[600];
+  for (size_t i = 0; i < sizeof(msg512); ++i)
+  {
+    msg512[i] = static_cast<char>(i * 7 + 0x80);
+  }
+  for (const impl512& m : impls512)
+  {
+    if (!m.supported) continue;
+    for (int i = 0; i < 8; ++i)
+    {
+      const size_t len = std::strlen(testinputs[i]);
+      const size_t nblocks = (len + 16) / 128 + 1;
+      char buf[2 * 128] = {};
+      std::memcpy(buf, testinputs[i], len);
+      buf[len] = static_cast<char>(0x80);
+      for (size_t j = 0; j < 8; ++j)
+      {
+        buf[nblocks * 128 - 1 - j] = static_cast<char>((len * 8) >> (8 * j));
+      }
+      cx::sha512sum sum = cx::detail::sha512::init();
+      m.f(sum, buf, nblocks);
+      for (int j = 0; j < 8; ++j)
+      {
+        assert(sum.h[j] == sha512sums[i].h[j]);
+      }
+    }
+    for (size_t len = 0; len <= sizeof(msg512); len += 7)
+    {
+      cx::sha512sum s1 = cx::detail::sha512::init();
+      cx::sha512sum s2 = cx::detail::sha512::init();
+      m.f(s1, msg512, len / 128);
+      cx::runtime::sha512blocks_scalar(s2, msg512, len / 128);
+      for (int j = 0; j < 8; ++j)
+      {
+        assert(s1.h[j] == s2.h[j]);
+      }
+    }
+  }
 }
@@ -0,0 +1,62 @@
+#include <cx_hashed_string.h>
+
+#include <cassert>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+void test_cx_hashed_string()
+{
+  {
+    constexpr cx::hashed_string get("GET");
+    static_assert(get.size() == 3 && get.hash() == cx::fnv1a("GET"), "hashed_string hash");
+    static_assert(get == cx::hashed_string("GET"), "hashed_string ==");
+    static_assert(get != cx::hashed_string("PUT"), "hashed_string !=");
+    static_assert(get != cx::hashed_string("GET", 2), "hashed_string != prefix");
+    static_assert(cx_hashed_string("GET") == get, "cx_hashed_string");
+    static_assert(cx::hashed_string("a\0b", 3) != cx::hashed_string("a\0c", 3),
+                  "hashed_string binary");
+  }
+
+  {
+    // runtime strings hash the same as literals
+    const std::string s = "POST";
+    const cx::hashed_string h(s);
+    assert(h == cx_hashed_string("POST"));
+    assert(h != cx_hashed_string("PUT"));
+    assert(h.str() == s);
+
+    // it only points at the string, so it can't be made from a temporary,
+    // or implicitly (e.g. by a map's operator[])
+    static_assert(!std::is_constructible<cx::hashed_string, std::string>::value,
+                  "hashed_string from a temporary");
+    static_assert(!std::is_convertible<const std::string&, cx::hashed_string>::value,
+                  "hashed_string is explicit");
+
+    // equal hashes with different bytes (forged here) still compare unequal
+    const cx::hashed_string forged("PUSH", 4, h.hash());
+    assert(forged != h);
+  }
+
+  {
+    std::unordered_map<cx::hashed_string, int,
+                       cx::hashed_string_hash, cx::hashed_string_equal> m;
+    m[cx_hashed_string("GET")] = 1;
+    m[cx_hashed_string("PUT")] = 2;
+    m[cx_hashed_string("POST")] = 3;
+    assert(m.size() == 3);
+    assert(m.at(cx_hashed_string("PUT")) == 2);
+    assert(m.find(cx_hashed_string("DELETE")) == m.end());
+    const std::string post = "POST";
+    assert(m.at(cx::hashed_string(post)) == 3);
+
+    // with the default hasher and equality
+    std::unordered_map<cx::hashed_string, int> d(m.begin(), m.end());
+    assert(d.at(cx_hashed_string("GET")) == 1);
+
+    const cx::hashed_string_hash hash;
+    const cx::hashed_string_equal eq;
+    assert(hash(post) == hash(cx_hashed_string("POST")));
+    assert(eq(post, cx_hashed_string("POST")) && !eq(cx_hashed_string("PUT"), post));
+  }
+}
@@ -0,0 +1,299 @@
+#include <cx_algorithm.h>
+#include <cx_blake2s.h>
+#include <cx_crc32.h>
+#include <cx_fnv1.h>
+#include <cx_hash_value.h>
+#include <cx_hmac.h>
+#include <cx_math.h>
+#include <cx_md5.h>
+#include <cx_murmur3.h>
+#include <cx_numeric.h>
+#include <cx_rolling_hash.h>
+#include <cx_sha256.h>
+#include <cx_sha512.h>
+#include <cx_shard.h>
+#include <cx_siphash.h>
+#include <cx_static_bloom.h>
+#include <cx_static_map.h>
+#include <cx_string_switch.h>
+#include <cx_utils.h>
+#include <cx_xxhash.h>
+
+#include <cassert>
+#include <limits>
+
+#ifndef CX_RUNTIME
+#error "the runtime tests are built with CX_RUNTIME defined for every translation unit"
+#endif
+
+namespace
+{
+  constexpr const char* const testinputs[8] = {
+    "",
+    "a",
+    "abc",
+    "message digest",
+    "abcdefghijklmnopqrstuvwxyz",
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+    "12345678901234567890123456789012345678901234567890123456789012345678901234567890",
+    "hello, world",
+  };
+
+  constexpr cx::md5sum md5sums[8] = {
+    cx::md5(testinputs[0]), cx::md5(testinputs[1]),
+    cx::md5(testinputs[2]), cx::md5(testinputs[3]),
+    cx::md5(testinputs[4]), cx::md5(testinputs[5]),
+    cx::md5(testinputs[6]), cx::md5(testinputs[7])
+  };
+
+  constexpr cx::sha256sum sha256sums[8] = {
+    cx::sha256(testinputs[0]), cx::sha256(testinputs[1]),
+    cx::sha256(testinputs[2]), cx::sha256(testinputs[3]),
+    cx::sha256(testinputs[4]), cx::sha256(testinputs[5]),
+    cx::sha256(testinputs[6]), cx::sha256(testinputs[7])
+  };
+
+  constexpr cx::sha512sum sha512sums[8] = {
+    cx::sha512(testinputs[0]), cx::sha512(testinputs[1]),
+    cx::sha512(testinputs[2]), cx::sha512(testinputs[3]),
+    cx::sha512(testinputs[4]), cx::sha512(testinputs[5]),
+    cx::sha512(testinputs[6]), cx::sha512(testinputs[7])
+  };
+
+  template <typename F>
+  bool throws(F f)
+  {
+    try { f(); } catch (const char*) { return true; }
+    return false;
+  }
+
+  template <typename T, typename U>
+  bool same(const T& a, const U& b)
+  {
+    static_assert(sizeof(a.h) == sizeof(b.h), "same sum type");
+    for (size_t i = 0; i < sizeof(a.h)/sizeof(a.h[0]); ++i)
+    {
+      if (a.h[i] != b.h[i]) return false;
+    }
+    return true;
+  }
+}
+
+void test_cx_runtime()
+{
+  // every call below has non-constant arguments, so it dispatches to the
+  // runtime implementation, which must agree exactly with the constexpr result
+
+  //----------------------------------------------------------------------------
+  // utils
+  const char* hello = "hello, world";
+  assert(cx::strlen(hello) == 12);
+  assert(cx::strcmp(hello, "hello, world") == 0);
+  assert(cx::strcmp(hello, "hello, worle") == -1);
+  assert(cx::strcmp(hello, "hello") == 1);
+
+  //----------------------------------------------------------------------------
+  // hashes
+  assert(cx::fnv1(hello) == 733686394982303293ull);
+  assert(cx::fnv1a(hello) == 1702823495152329533ull);
+  assert(cx::fnv1a(hello, 12) == 1702823495152329533ull);
+  assert(cx::fnv1a_32(hello) == 0x4d0ea41d);
+  assert(cx::fnv1a_128(hello).h[0] == 0x4f2ea20cf73dcc0full);
+  assert(cx::fnv1a_128(hello).h[1] == 0xf0d6a3624cd26605ull);
+  assert(cx::murmur3_32(hello, 0) == 345750399);
+  const char* hello1234 = "hello, world1234";
+  assert(cx::murmur3_32(hello1234, 0) == 4241062699);
+  assert(cx::murmur3_32(hello, 1) == 1868346089);
+  constexpr cx::murmur3_128sum m64 = cx::murmur3_x64_128("hello, world", 1);
+  assert(cx::murmur3_x64_128(hello, 1).h[0] == m64.h[0]);
+  assert(cx::murmur3_x64_128(hello, 1).h[1] == m64.h[1]);
+  constexpr cx::murmur3_x86_128sum m86 = cx::murmur3_x86_128("hello, world", 1);
+  for (int i = 0; i < 4; ++i)
+  {
+    assert(cx::murmur3_x86_128(hello, 1).h[i] == m86.h[i]);
+  }
+  constexpr uint32_t hv_key = cx::hash_combine(42, "hello, world", cx::pair<int, long>{ 1, 2 });
+  assert(cx::hash_combine(42, hello, cx::pair<int, long>{ 1, 2 }) == hv_key);
+  constexpr cx::array<long, 20> hv_longs = { 1l, 2l, 3l, -4l, 5l, 6l, 7l, 8l, 9l, 10l,
+                                             11l, 12l, 13l, 14l, 15l, 16l, 17l, 18l, 19l, 20l };
+  constexpr uint32_t hv_array = cx::hash_value(hv_longs);
+  assert(cx::hash_value(hv_longs) == hv_array);
+  assert(cx::xxh32(hello, 0) == 0x4fa5ffd7);
+  assert(cx::xxh32(hello1234, 12, 1) == 0x3c1082c7);
+  assert(cx::xxh64(hello, 1) == 0x8c84c1733f502e85ull);
+  assert(cx::xxh64(hello1234, 0) == 0xfe3dce4a03f1d287ull);
+  assert(cx::xxh3_64(hello, 0) == 0x302cd5fba73d006cull);
+  assert(cx::xxh3_64(hello1234, 16, 1) == 0xccda1b2fc1eb2556ull);
+  assert(cx::crc32(hello) == 0xffab723a);
+  assert(cx::crc32c(hello) == 0x6999a41f);
+  assert(cx::crc32c(hello, 12) == 0x6999a41f);
+  static constexpr cx::siphash_key sipkey = cx::make_siphash_key(
+      "\x00\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f");
+  assert(cx::siphash24(sipkey, hello) == 0x5222c673f3faebb2ull);
+  assert(cx::siphash13(sipkey, hello, 12) == 0xc657a05e198bb2b6ull);
+  constexpr uint32_t buz = cx::buzhash("hello, world");
+  assert(cx::buzhash(hello) == buz);
+  assert(cx::buzhash(hello, 12) == buz);
+
+  for (int i = 0; i < 8; ++i)
+  {
+    const char* s = testinputs[i];
+    assert(same(cx::md5(s), md5sums[i]));
+    assert(same(cx::sha256(s), sha256sums[i]));
+    assert(same(cx::sha512(s), sha512sums[i]));
+  }
+  constexpr cx::sha224sum s224 = cx::sha224("hello, world");
+  assert(same(cx::sha224(hello), s224));
+  constexpr cx::sha384sum s384 = cx::sha384("hello, world");
+  assert(same(cx::sha384(hello, 12), s384));
+  constexpr cx::sha512_256sum s512_256 = cx::sha512_256("hello, world");
+  assert(same(cx::sha512_256(hello), s512_256));
+  static constexpr cx::hmac_sha256_key secret = cx::make_hmac_sha256_key("secret");
+  constexpr cx::sha256sum mac = cx::hmac_sha256(secret, "hello, world");
+  assert(same(cx::hmac_sha256(secret, hello), mac));
+  assert(same(cx::hmac_sha256("secret", 6, hello, 12), mac));
+  constexpr cx::blake2ssum b2s = cx::blake2s("hello, world");
+  assert(same(cx::blake2s(hello), b2s));
+  constexpr cx::blake2ssum b2s_keyed = cx::blake2s_keyed("secret", "hello, world");
+  assert(same(cx::blake2s_keyed("secret", 6, hello, 12), b2s_keyed));
+  // empty input may come with no pointer at all
+  constexpr cx::blake2ssum b2s_empty = cx::blake2s("");
+  assert(same(cx::blake2s(nullptr, 0), b2s_empty));
+  assert(cx::siphash24(sipkey, nullptr, 0) == 0x726fdb47dd0e0e31ull);
+
+  //----------------------------------------------------------------------------
+  // static_map
+  static constexpr cx::pair<const char*, int> kv[] = {
+    { "get", 1 }, { "put", 2 }, { "post", 3 }, { "delete", 4 }, { "head", 5 },
+  };
+  static constexpr auto methods = cx::make_static_map(kv);
+  const char* put = "put";
+  assert(methods.at(put) == 2);
+  assert(*methods.find("head") == 5);
+  assert(methods.find(hello) == nullptr);
+  assert(!methods.contains("patch"));
+
+  static constexpr auto verbs = cx::make_string_switch({ "get", "put", "post" });
+  assert(verbs(put) == verbs["put"]);
+  assert(verbs(hello) == verbs.size());
+
+  static constexpr const char* methodnames[] = { "get", "put", "post", "delete", "head" };
+  static constexpr auto bloom = cx::make_static_bloom<512, 4>(methodnames);
+  assert(bloom.might_contain(put));
+  assert(bloom.might_contain("post"));
+  assert(!bloom.might_contain(hello));
+
+  // shard nodes named at runtime route like those named at compile time
+  static constexpr cx::shard_node shards[] = { { "a", 1.0 }, { "b", 2.0 }, { "c", 1.0 } };
+  const cx::shard_node runtime_shards[] = { { put, 1.0 }, { hello, 2.0 }, { "c", 1.0 } };
+  assert(runtime_shards[0].id == cx::fnv1a("put") && runtime_shards[1].id == cx::fnv1a(hello));
+  constexpr size_t shard = cx::rendezvous_hash(cx::fnv1a("hello, world"), shards);
+  assert(cx::rendezvous_hash(cx::fnv1a(hello), shards) == shard);
+  assert(cx::rendezvous_hash(cx::fnv1a(hello), runtime_shards)
+         < sizeof(runtime_shards) / sizeof(runtime_shards[0]));
+
+  //----------------------------------------------------------------------------
+  // algorithms
+  const int a[] = { 1, 2, 3, 3, 4, 5 };
+  const int* b = a;
+  const int* e = a + 6;
+  assert(cx::count(b, e, 3) == 2);
+  assert(cx::find(b, e, 4) == a + 4);
+  assert(cx::adjacent_find(b, e) == a + 2);
+  assert(cx::search_n(b, e, 2, 3) == a + 2);
+  assert(cx::accumulate(b, e, 0) == 18);
+  assert(cx::inner_product(b, e, b, 0) == 64);
+
+  //----------------------------------------------------------------------------
+  // math
+  constexpr double sqrt2 = cx::sqrt(2.0);
+  constexpr double cbrt_half = cx::cbrt(0.5);
+  constexpr double exp_half = cx::exp(0.5);
+  constexpr double exp_m699_5 = cx::exp(-699.5);
+  constexpr double sin_half = cx::sin(0.5);
+  constexpr double cos_half = cx::cos(0.5);
+  constexpr double sin_100 = cx::sin(100.0);
+  constexpr float cos_1e6 = cx::cos(1e6f);
+  constexpr double atan_half = cx::atan(0.5);
+  constexpr double asin_half = cx::asin(0.5);
+  constexpr double log_half = cx::log(0.5);
+  constexpr double log_2048 = cx::log(2048.0);
+  constexpr double erf_half = cx::erf(0.5);
+  constexpr double floor_2_5 = cx::floor(2.5);
+  constexpr double ceil_m2_5 = cx::ceil(-2.5);
+  constexpr double pow_half_3 = cx::pow(0.5, 3);
+
+  volatile double x = 0.5;
+  assert(cx::sqrt(x + 1.5) == sqrt2);
+  assert(cx::cbrt(x) == cbrt_half);
+  assert(cx::exp(x) == exp_half);
+  assert(cx::sin(x) == sin_half);
+  assert(cx::cos(x) == cos_half);
+  assert(cx::exp(x - 700) == exp_m699_5);
+  assert(cx::sin(x * 200) == sin_100);
+  assert(cx::cos(static_cast<float>(x) * 2e6f) == cos_1e6);
+  assert(cx::atan(x) == atan_half);
+  assert(cx::asin(x) == asin_half);
+  assert(cx::log(x) == log_half);
+  assert(cx::log(x * 4096) == log_2048);
+  assert(cx::erf(x) == erf_half);
+  assert(cx::floor(x + 2) == floor_2_5);
+  assert(cx::ceil(x - 3) == ceil_m2_5);
+  assert(cx::pow(x, 3) == pow_half_3);
+
+  // edges of the domains
+  const double inf = std::numeric_limits<double>::infinity();
+  volatile double big = 1e300;
+  volatile double zero = 0.0;
+  assert(cx::floor(big) == 1e300 && cx::ceil(-big) == -1e300);
+  assert(cx::floor(big * big) == inf && cx::ceil(big * big) == inf);
+  assert(cx::floor(-big * big) == -inf && cx::ceil(-big * big) == -inf);
+  const double two52 = 4503599627370496.0;
+  assert(cx::floor(x * two52 + 1) == two52 / 2 + 1 && cx::ceil(x * two52 + 1) == two52 / 2 + 1);
+  assert(cx::floor(-x * two52 - 1) == -two52 / 2 - 1);
+  static_assert(cx::floor(1e300) == 1e300 && cx::ceil(-1e300) == -1e300, "floor of a large value");
+  assert(cx::log(big * big) == inf);
+  assert(throws([&] { cx::log(zero); }));
+  assert(throws([&] { cx::log(-zero); }));
+  assert(throws([&] { cx::log(zero / zero); }));
+  assert(throws([&] { cx::log2(zero); }));
+  assert(throws([&] { cx::log10(-x); }));
+  assert(throws([&] { cx::floor(zero / zero); }));
+  constexpr double sqrt_1e300 = cx::sqrt(1e300);
+  constexpr double cbrt_100 = cx::cbrt(100.0);
+  constexpr double cbrt_m1e300 = cx::cbrt(-1e300);
+  constexpr double atan_12345 = cx::atan(12345.0);
+  constexpr double atan_m1e8 = cx::atan(-1e8);
+  constexpr double erf_3 = cx::erf(3.0);
+  const double half_pi = 1.5707963267948966;
+  assert(cx::sqrt(big) == sqrt_1e300);
+  assert(cx::sqrt(big * big) == inf);
+  assert(throws([&] { cx::sqrt(zero / zero); }));
+  assert(cx::cbrt(x * 200) == cbrt_100);
+  assert(cx::cbrt(-big) == cbrt_m1e300);
+  assert(cx::cbrt(big * big) == inf && cx::cbrt(-big * big) == -inf);
+  assert(cx::cbrt(zero / zero) != cx::cbrt(zero / zero));
+  assert(cx::atan(x * 24690) == atan_12345);
+  assert(cx::atan(-x * 2e8) == atan_m1e8);
+  assert(cx::atan(big * big) == half_pi && cx::atan(-big * big) == -half_pi);
+  assert(cx::atan(zero / zero) != cx::atan(zero / zero));
+  assert(cx::atan2(x * 2e-310, 1.0) == half_pi);
+  assert(cx::erf(x * 6) == erf_3);
+  assert(cx::erf(x * 60) == 1 && cx::erf(-x * 60) == -1);
+  assert(cx::erf(zero / zero) != cx::erf(zero / zero));
+  // sin and cos reduce exactly up to 2^26 pi/2 = 105414357.85...
+  constexpr double sin_below_max = cx::sin(105414357.8);
+  assert(cx::sin(x * 210828715.6) == sin_below_max);
+  assert(throws([&] { cx::sin(x * 210828715.8); }));
+  assert(throws([&] { cx::cos(-x * 210828715.8); }));
+  assert(throws([&] { cx::sin(big); }));
+  assert(throws([&] { cx::cos(big * big); }));
+  assert(throws([&] { cx::sin(zero / zero); }));
+}
+
+int main(int, char* [])
+{
+  test_cx_runtime();
+
+  return 0;
+}
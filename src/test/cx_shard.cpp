@@ -0,0 +1,89 @@
+#include <cx_shard.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace
+{
+  // well-spread test keys (the splitmix64 output function)
+  constexpr uint64_t key(uint64_t i)
+  {
+    return (i * 0x9e3779b97f4a7c15ull) ^ ((i * 0x9e3779b97f4a7c15ull) >> 31);
+  }
+
+  constexpr cx::shard_node nodes[] = {
+    { "cache-a", 1.0 }, { "cache-b", 1.0 }, { "cache-c", 2.0 } };
+  constexpr cx::shard_node nodes_without_b[] = { nodes[0], nodes[2] };
+}
+
+void test_cx_shard()
+{
+  // vectors from the reference implementation
+  {
+    static_assert(cx::jump_consistent_hash(0, 1) == 0, "jump_consistent_hash");
+    static_assert(cx::jump_consistent_hash(1, 10) == 6, "jump_consistent_hash");
+    static_assert(cx::jump_consistent_hash(0xdeadbeef, 1000) == 285, "jump_consistent_hash");
+    static_assert(cx::jump_consistent_hash(0xffffffffffffffffull, 100) == 92,
+                  "jump_consistent_hash");
+    static_assert(cx::jump_consistent_hash(12345678901234567ull, 65536) == 46958,
+                  "jump_consistent_hash");
+
+    volatile uint64_t k = 0xdeadbeef;
+    assert(cx::jump_consistent_hash(k, 1000) == 285);
+  }
+
+  // growing from n to n+1 buckets moves about 1/(n+1) of the keys, all of
+  // them to the new bucket
+  {
+    constexpr int n = 10;
+    constexpr int keys = 100000;
+    int moved = 0;
+    int counts[n] = {};
+    for (int i = 0; i < keys; ++i)
+    {
+      const int32_t b = cx::jump_consistent_hash(key(static_cast<uint64_t>(i)), n);
+      const int32_t c = cx::jump_consistent_hash(key(static_cast<uint64_t>(i)), n + 1);
+      assert(b >= 0 && b < n);
+      assert(c == b || c == n);
+      moved += c != b;
+      ++counts[b];
+    }
+    assert(moved > keys / (n + 1) * 9 / 10 && moved < keys / (n + 1) * 11 / 10);
+    for (int b = 0; b < n; ++b)
+    {
+      assert(counts[b] > keys / n * 9 / 10 && counts[b] < keys / n * 11 / 10);
+    }
+  }
+
+  // rendezvous hashing: the node ids are computed at compile time
+  {
+    static_assert(nodes[0].id == cx::fnv1a("cache-a") && nodes[2].weight == 2.0,
+                  "shard_node");
+    static_assert(cx::rendezvous_hash(key(1), nodes) < 3, "rendezvous_hash");
+    static_assert(cx::detail::rendezvous::ilog2(1) == 0
+                  && cx::detail::rendezvous::ilog2(0x1fffffffffffffull) == 52,
+                  "rendezvous ilog2");
+
+    constexpr size_t r = cx::rendezvous_hash(key(42), nodes);
+    volatile uint64_t k = key(42);
+    assert(cx::rendezvous_hash(k, nodes) == r);
+  }
+
+  // keys spread in proportion to the weights, and removing a node moves only
+  // its own keys
+  {
+    constexpr int keys = 100000;
+    int counts[3] = {};
+    for (int i = 0; i < keys; ++i)
+    {
+      const size_t n = cx::rendezvous_hash(key(static_cast<uint64_t>(i)), nodes);
+      const size_t m = cx::rendezvous_hash(key(static_cast<uint64_t>(i)), nodes_without_b);
+      ++counts[n];
+      assert(n == 1 || m == (n == 0 ? 0u : 1u));
+    }
+    assert(counts[0] > keys / 4 * 9 / 10 && counts[0] < keys / 4 * 11 / 10);
+    assert(counts[1] > keys / 4 * 9 / 10 && counts[1] < keys / 4 * 11 / 10);
+    assert(counts[2] > keys / 2 * 9 / 10 && counts[2] < keys / 2 * 11 / 10);
+  }
+}
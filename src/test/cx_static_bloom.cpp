@@ -0,0 +1,33 @@
+#include <cx_static_bloom.h>
+
+namespace
+{
+  constexpr const char* agents[] = {
+    "curl", "wget", "python-requests", "go-http-client", "libwww-perl",
+    "java", "okhttp", "scrapy", "httpclient", "node-fetch",
+    "axios", "aiohttp", "httpie", "postman", "insomnia",
+  };
+}
+
+void test_cx_static_bloom()
+{
+  {
+    constexpr auto bloom = cx::make_static_bloom<1024, 4>(agents);
+    static_assert(bloom.bits() == 1024 && bloom.hashes() == 4, "static_bloom size");
+    static_assert(bloom.might_contain("curl") && bloom.might_contain("wget")
+                  && bloom.might_contain("python-requests") && bloom.might_contain("java")
+                  && bloom.might_contain("axios") && bloom.might_contain("insomnia"),
+                  "static_bloom members");
+    static_assert(!bloom.might_contain("mozilla") && !bloom.might_contain("")
+                  && !bloom.might_contain("Curl") && !bloom.might_contain("cur"),
+                  "static_bloom non-members");
+    static_assert(bloom.might_contain("curl-7", 4), "static_bloom length");
+  }
+
+  {
+    constexpr const char* keys[] = { "" };
+    constexpr cx::static_bloom<512, 1> bloom(keys);
+    static_assert(bloom.might_contain("") && !bloom.might_contain("a"),
+                  "static_bloom one key");
+  }
+}
@@ -0,0 +1,49 @@
+#include <cx_static_map.h>
+
+namespace
+{
+  constexpr cx::pair<const char*, int> colors[] = {
+    { "red", 0xff0000 }, { "green", 0x00ff00 }, { "blue", 0x0000ff },
+    { "cyan", 0x00ffff }, { "magenta", 0xff00ff }, { "yellow", 0xffff00 },
+    { "black", 0x000000 }, { "white", 0xffffff }, { "gray", 0x808080 },
+    { "maroon", 0x800000 }, { "olive", 0x808000 }, { "navy", 0x000080 },
+    { "purple", 0x800080 }, { "teal", 0x008080 }, { "silver", 0xc0c0c0 },
+    { "lime", 0x00ff00 }, { "aqua", 0x00ffff }, { "fuchsia", 0xff00ff },
+    { "orange", 0xffa500 }, { "", -1 },
+  };
+}
+
+void test_cx_static_map()
+{
+  {
+    constexpr auto m = cx::make_static_map(colors);
+    static_assert(m.size() == 20, "static_map size");
+    static_assert(m.contains("red") && m.contains("orange"), "static_map contains");
+    static_assert(m.at("navy") == 0x000080, "static_map at");
+    static_assert(*m.find("teal") == 0x008080, "static_map find");
+    static_assert(m.at("") == -1, "static_map empty key");
+    static_assert(!m.contains("pink") && m.find("redd") == nullptr,
+                  "static_map missing key");
+    static_assert(!m.contains("re") && !m.contains("Red"), "static_map near miss");
+  }
+
+  {
+    constexpr cx::pair<const char*, bool> kv[] = { { "only", true } };
+    constexpr auto m = cx::make_static_map(kv);
+    static_assert(m.at("only") && !m.contains("other"), "static_map one key");
+  }
+
+  {
+    constexpr cx::pair<int, const char*> kv[] = {
+      { 200, "OK" }, { 201, "Created" }, { 204, "No Content" },
+      { 301, "Moved Permanently" }, { 304, "Not Modified" },
+      { 400, "Bad Request" }, { 403, "Forbidden" }, { 404, "Not Found" },
+      { 500, "Internal Server Error" }, { 503, "Service Unavailable" },
+      { 0, "" }, { -1, "invalid" },
+    };
+    constexpr auto m = cx::make_static_map(kv);
+    static_assert(cx::strcmp(m.at(404), "Not Found") == 0, "static_map int keys");
+    static_assert(m.contains(0) && m.contains(-1) && !m.contains(1),
+                  "static_map int keys");
+  }
+}
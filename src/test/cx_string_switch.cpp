@@ -0,0 +1,38 @@
+#include <cx_string_switch.h>
+
+namespace
+{
+  constexpr auto verbs = cx::make_string_switch(
+      { "GET", "HEAD", "POST", "PUT", "DELETE", "CONNECT", "OPTIONS", "TRACE" });
+
+  // a switch with compile-time labels, as it would be used on runtime strings
+  constexpr int verb_code(const char* s)
+  {
+    switch (verbs(s))
+    {
+      case verbs["GET"]: return 1;
+      case verbs["PUT"]: return 2;
+      case verbs["DELETE"]: return 3;
+      default: return 0;
+    }
+  }
+}
+
+void test_cx_string_switch()
+{
+  static_assert(verbs.size() == 8, "string_switch size");
+  static_assert(verbs("GET") == 0 && verbs("TRACE") == 7, "string_switch index");
+  static_assert(verbs["OPTIONS"] == 6, "string_switch label");
+  static_assert(verbs("PATCH") == verbs.size(), "string_switch no match");
+  static_assert(verbs("get") == verbs.size() && verbs("") == verbs.size(),
+                "string_switch exact match");
+
+  static_assert(verb_code("GET") == 1 && verb_code("PUT") == 2
+                && verb_code("DELETE") == 3 && verb_code("POST") == 0
+                && verb_code("GETS") == 0, "string_switch in switch");
+
+  constexpr const char* dups[] = { "a", "b", "c", "b" };
+  static_assert(!cx::distinct_hashes(dups), "string_switch duplicate cases");
+  constexpr const char* cases[] = { "a", "b", "c", "d" };
+  static_assert(cx::distinct_hashes(cases), "string_switch distinct cases");
+}
@@ -1,12 +1,18 @@
 extern void test_cx_algorithm();
 extern void test_cx_array();
+extern void test_cx_asset();
 extern void test_cx_counter();
 extern void test_cx_guid();
 extern void test_cx_hash();
+extern void test_cx_hashed_string();
 extern void test_cx_math();
 extern void test_cx_numeric();
 extern void test_cx_pcg32();
+extern void test_cx_shard();
+extern void test_cx_static_bloom();
+extern void test_cx_static_map();
 extern void test_cx_strenc();
+extern void test_cx_string_switch();
 extern void test_cx_typeid();
 extern void test_cx_utils();
 
@@ -14,13 +20,19 @@ int main(int, char* [])
 {
   test_cx_algorithm();
   test_cx_array();
+  test_cx_asset();
   test_cx_counter();
   test_cx_guid();
   test_cx_hash();
+  test_cx_hashed_string();
   test_cx_math();
   test_cx_numeric();
   test_cx_pcg32();
+  test_cx_shard();
+  test_cx_static_bloom();
+  test_cx_static_map();
   test_cx_strenc();
+  test_cx_string_switch();
   test_cx_typeid();
   test_cx_utils();
 